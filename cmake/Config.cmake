@@ -32,6 +32,12 @@ if(NOT BUILD_TEST_LUA)
     )
 endif()
 
+if(NOT BUILD_TEST_BENCH)
+    set(BUILD_TEST_BENCH FALSE
+        CACHE BOOL "TRUE to build the benchmarks, FALSE otherwise."
+    )
+endif()
+
 if(NOT BUILD_TEST_QT)
     set(BUILD_TEST_QT FALSE
         CACHE BOOL "TRUE to build the Qt-specific unit tests (requires Qt 4.5), FALSE otherwise."
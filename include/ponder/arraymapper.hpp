@@ -32,6 +32,7 @@
 #define PONDER_ARRAYMAPPER_HPP
 
 #include <ponder/config.hpp>
+#include <array>
 #include <list>
 #include <vector>
 
@@ -53,6 +54,13 @@ namespace ponder_ext {
  *  - `insert()`: insert a new element
  *  - `remove()`: remove an element
  *
+ * It may also define the following optional members:
+ *
+ *  - `data()`: pointer to the elements, if they are stored contiguously
+ *  - `begin()`: iterator to the first element, to walk arrays which aren't efficiently indexed
+ *  - `resize()`: resize a dynamic array in one operation
+ *  - `reserve()`: preallocate storage for the elements of a dynamic array
+ *
  * ValueMapper is specialized for every supported type, and can be specialized
  * for any of your own array types in order to extend the system.
  *
@@ -107,6 +115,11 @@ struct ArrayMapper<T[N]>
         arr[index] = value;
     }
 
+    static T* data(T (&arr)[N])
+    {
+        return arr;
+    }
+
     static void insert(T (&)[N], size_t, const T&)
     {
     }
@@ -145,6 +158,11 @@ struct ArrayMapper<std::array<T,N>>
         arr[index] = value;
     }
 
+    static T* data(std::array<T,N>& arr)
+    {
+        return arr.data();
+    }
+
     static void insert(std::array<T,N>&, size_t, const T&)
     {
     }
@@ -222,6 +240,11 @@ struct ArrayMapper<std::vector<T> >
         arr[index] = value;
     }
 
+    static T* data(std::vector<T>& arr)
+    {
+        return arr.data();
+    }
+
     static void insert(std::vector<T>& arr, size_t before, const T& value)
     {
         arr.insert(arr.begin() + before, value);
@@ -231,6 +254,16 @@ struct ArrayMapper<std::vector<T> >
     {
         arr.erase(arr.begin() + index);
     }
+
+    static void resize(std::vector<T>& arr, size_t size)
+    {
+        arr.resize(size);
+    }
+
+    static void reserve(std::vector<T>& arr, size_t capacity)
+    {
+        arr.reserve(capacity);
+    }
 };
 //! [doc_arraymapper]
 
@@ -273,6 +306,16 @@ struct ArrayMapper<std::vector<bool>>
     {
         arr.erase(arr.begin() + index);
     }
+
+    static void resize(std::vector<bool>& arr, size_t size)
+    {
+        arr.resize(size);
+    }
+
+    static void reserve(std::vector<bool>& arr, size_t capacity)
+    {
+        arr.reserve(capacity);
+    }
 };
 
 /*
@@ -308,6 +351,11 @@ struct ArrayMapper<std::list<T>>
         *it = value;
     }
 
+    static typename std::list<T>::iterator begin(std::list<T>& arr)
+    {
+        return arr.begin();
+    }
+
     static void insert(std::list<T>& arr, size_t before, const T& value)
     {
         typename std::list<T>::iterator it = arr.begin();
@@ -321,6 +369,11 @@ struct ArrayMapper<std::list<T>>
         std::advance(it, index);
         arr.erase(it);
     }
+
+    static void resize(std::list<T>& arr, size_t size)
+    {
+        arr.resize(size);
+    }
 };
 
 /** \endcond NoDocumentation */
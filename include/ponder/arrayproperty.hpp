@@ -33,10 +33,152 @@
 
 
 #include <ponder/property.hpp>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
 
 namespace ponder
 {
+
+/**
+ * \brief View of the elements of an array property stored contiguously in memory
+ *
+ * \sa ArrayProperty::span
+ */
+template <typename T>
+class ArraySpan
+{
+public:
+
+    ArraySpan(T* data, size_t size) : m_data(data), m_size(size) {}
+
+    [[nodiscard]] T* data() const {return m_data;}
+    [[nodiscard]] size_t size() const {return m_size;}
+    [[nodiscard]] bool empty() const {return m_size == 0;}
+
+    [[nodiscard]] T* begin() const {return m_data;}
+    [[nodiscard]] T* end() const {return m_data + m_size;}
+
+    T& operator [] (size_t index) const {return m_data[index];}
+
+private:
+
+    T* m_data;
+    size_t m_size;
+};
+
+class ArrayProperty;
+
+namespace detail {
+
+/*
+ * Typed position in an array, created by ArrayProperty::createCursor.
+ */
+class AbstractArrayCursor
+{
+public:
+    virtual ~AbstractArrayCursor() = default;
+    [[nodiscard]] virtual Value get() const = 0;
+    [[nodiscard]] virtual UserObject getObject() const = 0;
+    virtual void set(const Value& value) = 0;
+    virtual void next() = 0;
+};
+
+} // namespace detail
+
+/**
+ * \brief Forward cursor over the elements of an array property
+ *
+ * A cursor walks all the elements of an array in order, in linear time whatever the
+ * container, whereas accessing elements by index may not be constant time (e.g. `std::list`).
+ *
+ * \code
+ * for (ponder::ArrayCursor it = arrayProperty.cursor(object); it.valid(); it.next())
+ *     std::cout << it.get() << std::endl;
+ * \endcode
+ *
+ * \note Changing the size of the array invalidates the cursor.
+ *
+ * \sa ArrayProperty::cursor
+ */
+class PONDER_API ArrayCursor
+{
+public:
+
+    /**
+     * \brief Check if the cursor points to an element
+     *
+     * \return False when all the elements have been visited
+     */
+    [[nodiscard]] bool valid() const {return m_index < m_size;}
+
+    /**
+     * \brief Get the index of the current element
+     *
+     * \return Index of the element
+     */
+    [[nodiscard]] size_t index() const {return m_index;}
+
+    /**
+     * \brief Get the number of elements in the array
+     *
+     * \return Size of the array when the cursor was created
+     */
+    [[nodiscard]] size_t size() const {return m_size;}
+
+    /**
+     * \brief Get the value of the current element
+     *
+     * \return Value of the element
+     *
+     * \throw OutOfRange the cursor is not valid
+     */
+    [[nodiscard]] Value get() const;
+
+    /**
+     * \brief Get the current element of an array of user objects, without copying it
+     *
+     * Unlike get(), which returns a copy of the element, the user object returned refers
+     * to the element in the array. It is only valid as long as the array is not resized.
+     *
+     * \return User object referring to the element
+     *
+     * \throw OutOfRange the cursor is not valid
+     * \throw BadType the elements are not user objects
+     */
+    [[nodiscard]] UserObject getObject() const;
+
+    /**
+     * \brief Set the value of the current element
+     *
+     * \param value New value to assign to the element
+     *
+     * \throw ForbiddenWrite property is not writable
+     * \throw OutOfRange the cursor is not valid
+     * \throw BadType \a value can't be converted to the property's type
+     */
+    void set(const Value& value) const;
+
+    /**
+     * \brief Move to the next element
+     */
+    void next();
+
+private:
+
+    friend class ArrayProperty;
+
+    ArrayCursor(const ArrayProperty& property, const UserObject& object, size_t size,
+                std::unique_ptr<detail::AbstractArrayCursor> cursor);
+
+    const ArrayProperty* m_property; // Array being walked
+    UserObject m_object; // Owner of the array, kept alive while walking it
+    std::unique_ptr<detail::AbstractArrayCursor> m_cursor; // Typed position in the array
+    size_t m_index; // Index of the current element
+    size_t m_size; // Size of the array
+};
+
 /**
  * \brief Specialized type of property for arrays
  */
@@ -50,8 +192,12 @@ public:
      * \param name Name of the property
      * \param elementType Type of the property
      * \param dynamic Tells if the array is dynamic or not
+     * \param dataType C++ type of the elements if they are stored contiguously, null otherwise
+     * \param bitwiseSize Size of the contiguous elements if they can be compared bytewise,
+     *        0 otherwise
      */
-    ArrayProperty(IdRef name, ValueKind elementType, bool dynamic);
+    ArrayProperty(IdRef name, ValueKind elementType, bool dynamic,
+                  const std::type_info* dataType = nullptr, size_t bitwiseSize = 0);
 
     /**
      * \brief Get the type of the array elements
@@ -60,6 +206,23 @@ public:
      */
     [[nodiscard]] ValueKind elementType() const;
 
+    /**
+     * \brief Get the metaclass of the array elements
+     *
+     * The metaclass is looked up when asked for, which registers it if it was declared
+     * with PONDER_AUTO_TYPE().
+     *
+     * \return Metaclass of the elements if they are user objects, null otherwise
+     */
+    [[nodiscard]] const Class* elementClass() const;
+
+    /**
+     * \brief Get the metaenum of the array elements
+     *
+     * \return Metaenum of the elements if they are enums, null otherwise
+     */
+    [[nodiscard]] const Enum* elementEnum() const;
+
     /**
      * \brief Check if the array is dynamic
      *
@@ -70,6 +233,99 @@ public:
      */
     [[nodiscard]] bool dynamic() const;
 
+    /**
+     * \brief Check if the elements of the array are stored contiguously
+     *
+     * This is the case for `T[N]`, `std::array` and `std::vector` (except `std::vector<bool>`).
+     * Contiguous arrays can be accessed directly with span().
+     *
+     * \return True if the array is contiguous, false otherwise
+     */
+    [[nodiscard]] bool contiguous() const;
+
+    /**
+     * \brief Check if the elements of the array are stored contiguously as T
+     *
+     * \return True if span<T>() can be used, false otherwise
+     */
+    template <typename T>
+    [[nodiscard]] bool isContiguousOf() const;
+
+    /**
+     * \brief Check if the elements of the array can be compared as raw memory
+     *
+     * This is the case for contiguous arrays of scalars which have a unique object
+     * representation (integers and enums, but not pointers): two such arrays are equal
+     * exactly when their bytes are.
+     *
+     * \return True if the array is bitwise comparable, false otherwise
+     */
+    [[nodiscard]] bool bitwise() const;
+
+    /**
+     * \brief Get the raw memory of a bitwise comparable array
+     *
+     * \param object Object
+     * \param size Receives the size of the elements, in bytes
+     * \return Pointer to the first element
+     *
+     * \throw ForbiddenRead property is not readable
+     * \throw BadType the array is not bitwise comparable
+     *
+     * \sa bitwise
+     */
+    [[nodiscard]] const void* bytes(const UserObject& object, size_t& size) const;
+
+    /**
+     * \brief Get a view of the elements of a contiguous array
+     *
+     * The view is invalidated by any operation which changes the size of the array.
+     *
+     * \param object Object
+     * \return View of the elements of the array
+     *
+     * A writable view (T not const) marks the property as changed for tracked objects.
+     *
+     * \throw NullObject object is invalid
+     * \throw BadType the array is not contiguous or its elements are not of type T
+     * \throw ForbiddenWrite T is not const and the property is not writable
+     */
+    template <typename T>
+    [[nodiscard]] ArraySpan<T> span(const UserObject& object) const;
+
+    /**
+     * \brief Copy all the elements of the array
+     *
+     * Contiguous arrays of T are copied in bulk, other arrays element by element.
+     *
+     * \param object Object
+     * \param values Vector receiving the elements, resized to the size of the array
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenRead property is not readable
+     * \throw BadType an element can't be converted to T
+     */
+    template <typename T>
+    void getElements(const UserObject& object, std::vector<T>& values) const;
+
+    /**
+     * \brief Assign all the elements of the array
+     *
+     * Dynamic arrays are resized to \a count elements. Contiguous arrays of T are copied
+     * in bulk, other arrays element by element.
+     *
+     * \param object Object
+     * \param values Pointer to the new elements
+     * \param count Number of elements
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenWrite property is not writable
+     * \throw OutOfRange the array is not dynamic and \a count is greater than its size
+     * \throw BadType an element can't be converted to the array's element type
+     */
+    template <typename T>
+    void setElements(const UserObject& object, const T* values, size_t count) const;
+
     /**
      * \brief Get the current size of the array
      *
@@ -100,6 +356,21 @@ public:
      */
     void resize(const UserObject& object, size_t newSize) const;
 
+    /**
+     * \brief Preallocate storage for the elements of the array
+     *
+     * This is only a hint, it has no effect if the array doesn't support it.
+     *
+     * This function will throw an error if the array is not dynamic
+     *
+     * \param object Object
+     * \param capacity Number of elements to preallocate
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenWrite array is not writable or not dynamic
+     */
+    void reserve(const UserObject& object, size_t capacity) const;
+
     /**
      * \brief Get an element of the array for a given object
      *
@@ -113,6 +384,17 @@ public:
      */
     [[nodiscard]] Value get(const UserObject& object, size_t index) const;
 
+    /**
+     * \brief Get a cursor to walk the elements of the array for a given object
+     *
+     * \param object Object
+     * \return Cursor pointing to the first element
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenRead property is not readable
+     */
+    [[nodiscard]] ArrayCursor cursor(const UserObject& object) const;
+
     /**
      * \brief Set an element of the array for a given object
      *
@@ -192,6 +474,34 @@ protected:
      */
     virtual void setSize(const UserObject& object, size_t size) const = 0;
 
+    /**
+     * \brief Do the actual preallocation of the array
+     *
+     * The default implementation does nothing.
+     *
+     * \param object Object
+     * \param capacity Number of elements to preallocate
+     */
+    virtual void setCapacity(const UserObject& object, size_t capacity) const;
+
+    /**
+     * \brief Do the actual lookup of the metaclass of the elements
+     *
+     * The default implementation returns null.
+     *
+     * \return Metaclass of the elements, or null
+     */
+    [[nodiscard]] virtual const Class* getElementClass() const;
+
+    /**
+     * \brief Do the actual lookup of the metaenum of the elements
+     *
+     * The default implementation returns null.
+     *
+     * \return Metaenum of the elements, or null
+     */
+    [[nodiscard]] virtual const Enum* getElementEnum() const;
+
     /**
      * \brief Do the actual reading of an element
      *
@@ -239,12 +549,104 @@ protected:
      */
     virtual void removeElement(const UserObject& object, size_t index) const = 0;
 
+    /**
+     * \brief Do the actual retrieval of the contiguous elements
+     *
+     * The default implementation returns null, for arrays which are not contiguous.
+     *
+     * \param object Object
+     * \param size Receives the size of the array
+     * \return Pointer to the first element
+     */
+    [[nodiscard]] virtual void* getData(const UserObject& object, size_t& size) const;
+
+    /**
+     * \brief Do the actual creation of a cursor
+     *
+     * The default implementation accesses the elements by index.
+     *
+     * \param object Object
+     * \return Cursor pointing to the first element
+     */
+    [[nodiscard]] virtual std::unique_ptr<detail::AbstractArrayCursor>
+        createCursor(const UserObject& object) const;
+
 private:
 
     ValueKind m_elementType; // Type of the individual elements of the array
     bool m_dynamic; // Is the array dynamic?
+    const std::type_info* m_dataType; // Type of the contiguous elements, if any
+    size_t m_bitwiseSize; // Size of the contiguous elements, if they compare bytewise
 };
 
+template <typename T>
+bool ArrayProperty::isContiguousOf() const
+{
+    return m_dataType != nullptr && *m_dataType == typeid(std::remove_const_t<T>);
+}
+
+template <typename T>
+ArraySpan<T> ArrayProperty::span(const UserObject& object) const
+{
+    if (!isContiguousOf<T>())
+        PONDER_ERROR(BadType(mapType<std::remove_const_t<T>>(), m_elementType));
+
+    if constexpr (!std::is_const_v<T>)
+    {
+        if (!isWritable())
+            PONDER_ERROR(ForbiddenWrite(name()));
+
+        // Writes through the span can't be seen, assume they happen
+        object.notifyChanged(*this);
+    }
+
+    size_t size = 0;
+    T* data = static_cast<T*>(getData(object, size));
+    return ArraySpan<T>(data, size);
+}
+
+template <typename T>
+void ArrayProperty::getElements(const UserObject& object, std::vector<T>& values) const
+{
+    if (!isReadable())
+        PONDER_ERROR(ForbiddenRead(name()));
+
+    if (isContiguousOf<T>())
+    {
+        const ArraySpan<const T> elements = span<const T>(object);
+        values.assign(elements.begin(), elements.end());
+        return;
+    }
+
+    const size_t count = getSize(object);
+    values.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        values[i] = getElement(object, i).to<T>();
+}
+
+template <typename T>
+void ArrayProperty::setElements(const UserObject& object, const T* values, size_t count) const
+{
+    if (!isWritable())
+        PONDER_ERROR(ForbiddenWrite(name()));
+
+    if (m_dynamic)
+        setSize(object, count);
+    else if (const size_t range = getSize(object); count > range)
+        PONDER_ERROR(OutOfRange(count, range));
+
+    if (isContiguousOf<T>())
+    {
+        const ArraySpan<T> elements = span<T>(object);
+        std::copy(values, values + count, elements.begin());
+        return;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        setElement(object, i, Value(values[i]));
+    object.notifyChanged(*this);
+}
+
 } // namespace ponder
 
 
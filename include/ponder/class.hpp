@@ -100,6 +100,9 @@ class PONDER_API Class : public Type
     using FunctionTable = detail::Dictionary<Id, IdRef, FunctionPtr>;
     using Destructor = void(*)(const UserObject&, bool);
     using UserObjectCreator = UserObject(*)(void*);
+    using UserObjectCopier = UserObject(*)(const void*);
+    using UserObjectDefaulter = UserObject(*)();
+    using UserObjectResetter = void(*)(void*);
 
     size_t m_sizeof;                // Size of the class in bytes.
     TypeId m_id;                    // Unique type id of the metaclass.
@@ -110,6 +113,10 @@ class PONDER_API Class : public Type
     ConstructorList m_constructors; // List of metaconstructors
     Destructor m_destructor;        // Destructor (function able to delete an abstract object)
     UserObjectCreator m_userObjectCreator; // Convert pointer of class instance to UserObject
+    UserObjectCopier m_userObjectCopier; // Copy construct an owned instance (null if not copyable)
+    UserObjectDefaulter m_userObjectDefaulter; // Default construct an owned instance (or null)
+    UserObjectResetter m_userObjectResetter; // Assign a default constructed value (or null)
+    bool m_triviallyCopyable;       // Instances can be copied bytewise
 
 public: // declaration
 
@@ -300,6 +307,24 @@ public: // reflection
      */
     [[nodiscard]] const Property& property(IdRef name) const;
 
+    /**
+     * \brief Get the index of a property in this metaclass from its name
+     *
+     * \param name Name of the property (case sensitive)
+     * \return Index of the property, as used by property(size_t)
+     *
+     * \throw PropertyNotFound \a name is not a property of the metaclass
+     */
+    [[nodiscard]] size_t propertyIndex(IdRef name) const;
+
+    /**
+     * \brief Get the index of a property in this metaclass
+     *
+     * \param property Property to look for
+     * \return Index of the property, or propertyCount() if it is not a property of the metaclass
+     */
+    [[nodiscard]] size_t propertyIndex(const Property& property) const noexcept;
+
     /**
      * \brief Get a property iterator
      *
@@ -334,6 +359,57 @@ public: // reflection
      */
     [[nodiscard]] size_t sizeOf() const noexcept;
 
+    /**
+     * \brief Check if instances of the class are trivially copyable
+     *
+     * Trivially copyable instances can be duplicated with a plain memory copy of
+     * sizeOf() bytes.
+     *
+     * \return True if the C++ class is trivially copyable
+     */
+    [[nodiscard]] bool isTriviallyCopyable() const noexcept;
+
+    /**
+     * \brief Check if instances of the class are copied with their copy constructor
+     *
+     * \return True if the class is trivially copyable, or declared with
+     *         ClassBuilder::copyable()
+     */
+    [[nodiscard]] bool isCopyConstructible() const noexcept;
+
+    /**
+     * \brief Create a UserObject owning a copy of an instance
+     *
+     * The copy is made with the native copy constructor of the class.
+     *
+     * \param ptr Pointer to the instance to copy, which must be of this class
+     * \return A UserObject owning the copy, or UserObject::nothing if the class
+     *         is not copy constructible
+     *
+     * \sa isCopyConstructible, runtime::clone
+     */
+    UserObject getUserObjectCopy(const void* ptr) const;
+
+    /**
+     * \brief Create a UserObject owning a default constructed instance
+     *
+     * \return A UserObject owning the new instance, or UserObject::nothing if the
+     *         class is not default and move constructible
+     */
+    UserObject getDefaultUserObject() const;
+
+    /**
+     * \brief Reset an instance to a default constructed value
+     *
+     * The instance is move assigned a default constructed one, so it can be filled again
+     * as if it was new while keeping its address.
+     *
+     * \param ptr Pointer to the instance to reset, which must be of this class
+     * \return False if the class is not default constructible and move assignable,
+     *         in which case the instance is left untouched
+     */
+    bool resetUserObject(void* ptr) const;
+
     /**
      * \brief Create a UserObject from an opaque user pointer
      *
@@ -46,6 +46,24 @@ static UserObject userObjectCreator(void* ptr)
     return UserObject::makeRef(*static_cast<T*>(ptr));
 }
 
+template <typename T>
+static UserObject userObjectCopier(const void* ptr)
+{
+    return UserObject::makeCopy(*static_cast<const T*>(ptr));
+}
+
+template <typename T>
+static UserObject userObjectDefaulter()
+{
+    return UserObject::makeOwned(T());
+}
+
+template <typename T>
+static void userObjectResetter(void* ptr)
+{
+    *static_cast<T*>(ptr) = T();
+}
+
 } // namespace detail
 
 template <typename T>
@@ -58,6 +76,15 @@ ClassBuilder<T> Class::declare(IdRef name)
     newClass.m_sizeof = sizeof(T);
     newClass.m_destructor = &detail::destroy<T>;
     newClass.m_userObjectCreator = &detail::userObjectCreator<T>;
+    newClass.m_triviallyCopyable = std::is_trivially_copyable_v<T>;
+    // Other classes may declare a copy constructor which doesn't compile (e.g. with a vector
+    // of unique_ptr), so they opt in with ClassBuilder::copyable()
+    if constexpr (std::is_trivially_copyable_v<T> && std::is_copy_constructible_v<T>)
+        newClass.m_userObjectCopier = &detail::userObjectCopier<T>;
+    if constexpr (std::is_default_constructible_v<T> && std::is_move_constructible_v<T>)
+        newClass.m_userObjectDefaulter = &detail::userObjectDefaulter<T>;
+    if constexpr (std::is_default_constructible_v<T> && std::is_move_assignable_v<T>)
+        newClass.m_userObjectResetter = &detail::userObjectResetter<T>;
     return ClassBuilder<T>(newClass);
 }
 
@@ -102,4 +129,22 @@ inline UserObject Class::getUserObjectFromPointer(void* ptr) const
     return m_userObjectCreator(ptr);
 }
 
+inline UserObject Class::getUserObjectCopy(const void* ptr) const
+{
+    return m_userObjectCopier ? m_userObjectCopier(ptr) : UserObject::nothing;
+}
+
+inline UserObject Class::getDefaultUserObject() const
+{
+    return m_userObjectDefaulter ? m_userObjectDefaulter() : UserObject::nothing;
+}
+
+inline bool Class::resetUserObject(void* ptr) const
+{
+    if (!m_userObjectResetter)
+        return false;
+    m_userObjectResetter(ptr);
+    return true;
+}
+
 } // namespace ponder
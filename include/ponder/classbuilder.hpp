@@ -180,6 +180,16 @@ public:
     template <typename... A>
     ClassBuilder<T>& constructor();
 
+    /**
+     * \brief Declare that the metaclass can copy its objects with their copy constructor
+     *
+     * Trivially copyable classes are always copied this way. Other classes are copied
+     * property by property by runtime::clone(), unless they are declared copyable.
+     *
+     * \return Reference to this, in order to chain other calls
+     */
+    ClassBuilder<T>& copyable();
+
     /**
      * \brief Add properties and/or functions from an external source
      *
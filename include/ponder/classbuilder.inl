@@ -113,6 +113,14 @@ ClassBuilder<T>& ClassBuilder<T>::constructor()
     return *this;
 }
 
+template <typename T>
+ClassBuilder<T>& ClassBuilder<T>::copyable()
+{
+    static_assert(std::is_copy_constructible_v<T>, "The class must be copy constructible");
+    m_target->m_userObjectCopier = &detail::userObjectCopier<T>;
+    return *this;
+}
+
 template <typename T>
 template <template <typename> class U>
 ClassBuilder<T>& ClassBuilder<T>::external()
@@ -142,6 +150,9 @@ ClassBuilder<T>& ClassBuilder<T>::addProperty(Class::PropertyPtr property)
     // First remove any property that already exists with the same name
     properties.erase(property->name());
 
+    // Properties are relative to the class declaring them
+    property->m_ownerClass = m_target;
+
     // Insert the new property
     properties.insert(property->name(), property);
 
@@ -38,6 +38,7 @@ namespace ponder {
 class Property;
 class SimpleProperty;
 class ArrayProperty;
+class MapProperty;
 class EnumProperty;
 class UserProperty;
 class Function;
@@ -129,6 +130,13 @@ public:
      */
     virtual void visit(const ArrayProperty& property);
 
+    /**
+     * \brief Visit a map property
+     *
+     * \param property Property which is being visited
+     */
+    virtual void visit(const MapProperty& property);
+
     /**
      * \brief Visit an enum property
      *
@@ -32,11 +32,105 @@
 #define PONDER_DETAIL_ARRAYPROPERTYIMPL_HPP
 
 #include <ponder/arrayproperty.hpp>
+#include <ponder/enumget.hpp>
 #include <ponder/detail/valueprovider.hpp>
 
 namespace ponder {
 namespace detail {
 
+/*
+ * Does the ArrayMapper M give access to the contiguous elements of an array T?
+ */
+template <typename M, typename T, typename = void>
+struct HasArrayData : std::false_type {};
+
+template <typename M, typename T>
+struct HasArrayData<M, T, std::void_t<decltype(M::data(std::declval<T&>()))>> : std::true_type {};
+
+/*
+ * Can contiguous elements E be compared as raw memory? Only scalars qualify: pointers are
+ * compared through the objects they point to, and classes may have pointers or members
+ * which are not properties.
+ */
+template <typename E>
+struct IsBitwise
+    : std::bool_constant<std::is_scalar_v<E> && std::has_unique_object_representations_v<E>
+                         && !std::is_pointer_v<E>>
+{};
+
+/*
+ * Can the ArrayMapper M resize an array T in one operation?
+ */
+template <typename M, typename T, typename = void>
+struct HasArrayResize : std::false_type {};
+
+template <typename M, typename T>
+struct HasArrayResize<M, T, std::void_t<decltype(M::resize(std::declval<T&>(), size_t()))>>
+    : std::true_type {};
+
+/*
+ * Can the ArrayMapper M preallocate an array T?
+ */
+template <typename M, typename T, typename = void>
+struct HasArrayReserve : std::false_type {};
+
+template <typename M, typename T>
+struct HasArrayReserve<M, T, std::void_t<decltype(M::reserve(std::declval<T&>(), size_t()))>>
+    : std::true_type {};
+
+/*
+ * Element of an array as a user object: a reference to the element when it is a user
+ * type, the conversion of the element otherwise (which throws BadType).
+ */
+template <typename M, typename E>
+UserObject elementObject(const E& element)
+{
+    if constexpr (ponder_ext::ValueMapper<typename M::ElementType>::kind == ValueKind::User)
+        return UserObject::makeRef(element);
+    else
+        return Value(element).to<UserObject>();
+}
+
+/*
+ * Cursor over an array using the ArrayMapper M.
+ *  - Indexed access by default.
+ *  - Iterator access when the mapper provides begin().
+ */
+template <typename M, typename T, typename = void>
+class ArrayCursorImpl final : public AbstractArrayCursor
+{
+public:
+    ArrayCursorImpl(T& array) : m_array(array), m_index(0) {}
+
+    Value get() const override {return M::get(m_array, m_index);}
+    UserObject getObject() const override {return elementObject<M>(M::get(m_array, m_index));}
+    void set(const Value& value) override {M::set(m_array, m_index, value.to<typename M::ElementType>());}
+    void next() override {++m_index;}
+
+private:
+    T& m_array;
+    size_t m_index;
+};
+
+template <typename M, typename T>
+class ArrayCursorImpl<M, T, std::void_t<decltype(M::begin(std::declval<T&>()))>> final
+    : public AbstractArrayCursor
+{
+public:
+    ArrayCursorImpl(T& array) : m_it(M::begin(array)) {}
+
+    Value get() const override {return static_cast<const typename M::ElementType&>(*m_it);}
+    UserObject getObject() const override
+    {
+        return elementObject<M>(static_cast<const typename M::ElementType&>(*m_it));
+    }
+    void set(const Value& value) override {*m_it = value.to<typename M::ElementType>();}
+    void next() override {++m_it;}
+
+private:
+    decltype(M::begin(std::declval<T&>())) m_it;
+};
+
 /**
  * \brief Typed implementation of ArrayProperty
  *
@@ -75,6 +169,21 @@ protected:
      */
     void setSize(const UserObject& object, size_t size) const override;
 
+    /**
+     * \see ArrayProperty::setCapacity
+     */
+    void setCapacity(const UserObject& object, size_t capacity) const override;
+
+    /**
+     * \see ArrayProperty::getElementClass
+     */
+    [[nodiscard]] const Class* getElementClass() const override;
+
+    /**
+     * \see ArrayProperty::getElementEnum
+     */
+    [[nodiscard]] const Enum* getElementEnum() const override;
+
     /**
      * \see ArrayProperty::getElement
      */
@@ -95,6 +204,16 @@ protected:
      */
     void removeElement(const UserObject& object, size_t index) const override;
 
+    /**
+     * \see ArrayProperty::getData
+     */
+    [[nodiscard]] void* getData(const UserObject& object, size_t& size) const override;
+
+    /**
+     * \see ArrayProperty::createCursor
+     */
+    [[nodiscard]] std::unique_ptr<AbstractArrayCursor> createCursor(const UserObject& object) const override;
+
 private:
 
     using ArrayType = typename A::ExposedType;
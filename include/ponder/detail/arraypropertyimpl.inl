@@ -33,7 +33,9 @@ namespace detail {
     
 template <typename A>
 ArrayPropertyImpl<A>::ArrayPropertyImpl(IdRef name, A&& accessor)
-    : ArrayProperty(name, mapType<ElementType>(), Mapper::dynamic())
+    : ArrayProperty(name, mapType<ElementType>(), Mapper::dynamic(),
+                    HasArrayData<Mapper, ArrayType>::value ? &typeid(ElementType) : nullptr,
+                    IsBitwise<ElementType>::value ? sizeof(ElementType) : 0)
     , m_accessor(accessor)
 {}
 
@@ -46,7 +48,12 @@ size_t ArrayPropertyImpl<A>::getSize(const UserObject& object) const
 template <typename A>
 void ArrayPropertyImpl<A>::setSize(const UserObject& object, size_t size) const
 {
-    if (size_t currentSize = getSize(object); size < currentSize)
+    // Pointers are allocated by the ValueProvider, so are inserted one by one
+    if constexpr (HasArrayResize<Mapper, ArrayType>::value && !std::is_pointer_v<ElementType>)
+    {
+        Mapper::resize(array(object), size);
+    }
+    else if (size_t currentSize = getSize(object); size < currentSize)
     {
         while (size < currentSize)
             removeElement(object, --currentSize);
@@ -59,6 +66,31 @@ void ArrayPropertyImpl<A>::setSize(const UserObject& object, size_t size) const
     }
 }
 
+template <typename A>
+void ArrayPropertyImpl<A>::setCapacity(const UserObject& object, size_t capacity) const
+{
+    if constexpr (HasArrayReserve<Mapper, ArrayType>::value)
+        Mapper::reserve(array(object), capacity);
+}
+
+template <typename A>
+const Class* ArrayPropertyImpl<A>::getElementClass() const
+{
+    if constexpr (ponder_ext::ValueMapper<ElementType>::kind == ValueKind::User)
+        return &classByType<typename DataType<ElementType>::Type>();
+    else
+        return nullptr;
+}
+
+template <typename A>
+const Enum* ArrayPropertyImpl<A>::getElementEnum() const
+{
+    if constexpr (ponder_ext::ValueMapper<ElementType>::kind == ValueKind::Enum)
+        return &enumByType<ElementType>();
+    else
+        return nullptr;
+}
+
 template <typename A>
 Value ArrayPropertyImpl<A>::getElement(const UserObject& object, size_t index) const
 {
@@ -83,6 +115,27 @@ void ArrayPropertyImpl<A>::removeElement(const UserObject& object, size_t index)
     Mapper::remove(array(object), index);
 }
 
+template <typename A>
+void* ArrayPropertyImpl<A>::getData(const UserObject& object, size_t& size) const
+{
+    if constexpr (HasArrayData<Mapper, ArrayType>::value)
+    {
+        ArrayType& arr = array(object);
+        size = Mapper::size(arr);
+        return Mapper::data(arr);
+    }
+    else
+    {
+        return ArrayProperty::getData(object, size);
+    }
+}
+
+template <typename A>
+std::unique_ptr<AbstractArrayCursor> ArrayPropertyImpl<A>::createCursor(const UserObject& object) const
+{
+    return std::make_unique<ArrayCursorImpl<Mapper, ArrayType>>(array(object));
+}
+
 template <typename A>
 typename ArrayPropertyImpl<A>::ArrayType& ArrayPropertyImpl<A>::array(const UserObject& object) const
 {
@@ -32,6 +32,7 @@
 #define PONDER_DETAIL_ENUMPROPERTYIMPL_HPP
 
 #include <ponder/enumproperty.hpp>
+#include <ponder/propertyaccessor.hpp>
 
 namespace ponder {
 namespace detail {
@@ -47,7 +48,9 @@ namespace detail {
  * \sa EnumProperty
  */
 template <typename A>
-class EnumPropertyImpl final : public EnumProperty
+class EnumPropertyImpl final
+    : public EnumProperty
+    , public TypedPropertyAccess<typename A::DataType>
 {
 public:
 
@@ -81,6 +84,16 @@ protected:
      */
     void setValue(const UserObject& object, const Value& value) const;
 
+    /**
+     * \see TypedPropertyAccess::getTyped
+     */
+    [[nodiscard]] typename A::DataType getTyped(const UserObject& object) const;
+
+    /**
+     * \see TypedPropertyAccess::setTyped
+     */
+    bool setTyped(const UserObject& object, const typename A::DataType& value) const;
+
 private:
 
     A m_accessor;
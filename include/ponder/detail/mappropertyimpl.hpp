@@ -0,0 +1,149 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_DETAIL_MAPPROPERTYIMPL_HPP
+#define PONDER_DETAIL_MAPPROPERTYIMPL_HPP
+
+#include <ponder/mapproperty.hpp>
+#include <ponder/classget.hpp>
+#include <ponder/enumget.hpp>
+
+namespace ponder {
+namespace detail {
+
+/*
+ * Cursor over a map using the MapMapper M.
+ */
+template <typename M, typename T>
+class MapCursorImpl final : public AbstractMapCursor
+{
+public:
+    MapCursorImpl(T& map) : m_it(M::begin(map)) {}
+
+    Value key() const override {return M::key(m_it);}
+    Value value() const override {return static_cast<const typename M::MappedType&>(M::value(m_it));}
+    void setValue(const Value& value) override {M::value(m_it) = value.to<typename M::MappedType>();}
+    void next() override {++m_it;}
+
+private:
+    typename M::Iterator m_it;
+};
+
+/**
+ * \brief Typed implementation of MapProperty
+ *
+ * MapPropertyImpl is a template implementation of MapProperty, which is strongly typed
+ * in order to keep track of the true underlying C++ types involved in the property.
+ *
+ * The template parameter A is an abstract helper to access the actual C++ property.
+ *
+ * This class uses the ponder_ext::MapMapper template to implement its operations according
+ * to the type of map.
+ *
+ * \sa MapProperty, ponder_ext::MapMapper
+ */
+template <typename A>
+class MapPropertyImpl final : public MapProperty
+{
+public:
+
+    /**
+     * \brief Construct the property
+     *
+     * \param name Name of the property
+     * \param accessor Object used to access the actual C++ property
+     */
+    MapPropertyImpl(IdRef name, A&& accessor);
+
+protected:
+
+    /**
+     * \see MapProperty::getSize
+     */
+    [[nodiscard]] size_t getSize(const UserObject& object) const override;
+
+    /**
+     * \see MapProperty::getMappedClass
+     */
+    [[nodiscard]] const Class* getMappedClass() const override;
+
+    /**
+     * \see MapProperty::getMappedEnum
+     */
+    [[nodiscard]] const Enum* getMappedEnum() const override;
+
+    /**
+     * \see MapProperty::findElement
+     */
+    bool findElement(const UserObject& object, const Value& key, Value* value) const override;
+
+    /**
+     * \see MapProperty::setElement
+     */
+    void setElement(const UserObject& object, const Value& key, const Value& value) const override;
+
+    /**
+     * \see MapProperty::getOrInsertElement
+     */
+    Value getOrInsertElement(const UserObject& object, const Value& key) const override;
+
+    /**
+     * \see MapProperty::eraseElement
+     */
+    bool eraseElement(const UserObject& object, const Value& key) const override;
+
+    /**
+     * \see MapProperty::createCursor
+     */
+    [[nodiscard]] std::unique_ptr<AbstractMapCursor> createCursor(const UserObject& object) const override;
+
+private:
+
+    using MapType = typename A::ExposedType;
+    using Mapper = typename A::InterfaceType;
+    using KeyType = typename Mapper::KeyType;
+    using MappedType = typename Mapper::MappedType;
+
+    /*
+     * \brief Retrieve a reference to the map
+     * \param object Owner object
+     * \return Reference to the underlying map
+     */
+    MapType& map(const UserObject& object) const;
+
+    A m_accessor; // Object used to access the actual C++ property
+};
+
+} // namespace detail
+} // namespace ponder
+
+#include <ponder/detail/mappropertyimpl.inl>
+
+#endif // PONDER_DETAIL_MAPPROPERTYIMPL_HPP
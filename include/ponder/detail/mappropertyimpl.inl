@@ -0,0 +1,111 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+
+namespace ponder {
+namespace detail {
+
+template <typename A>
+MapPropertyImpl<A>::MapPropertyImpl(IdRef name, A&& accessor)
+    : MapProperty(name, mapType<KeyType>(), mapType<MappedType>())
+    , m_accessor(accessor)
+{}
+
+template <typename A>
+size_t MapPropertyImpl<A>::getSize(const UserObject& object) const
+{
+    return Mapper::size(map(object));
+}
+
+template <typename A>
+const Class* MapPropertyImpl<A>::getMappedClass() const
+{
+    if constexpr (ponder_ext::ValueMapper<MappedType>::kind == ValueKind::User)
+        return &classByType<typename DataType<MappedType>::Type>();
+    else
+        return nullptr;
+}
+
+template <typename A>
+const Enum* MapPropertyImpl<A>::getMappedEnum() const
+{
+    if constexpr (ponder_ext::ValueMapper<MappedType>::kind == ValueKind::Enum)
+        return &enumByType<MappedType>();
+    else
+        return nullptr;
+}
+
+template <typename A>
+bool MapPropertyImpl<A>::findElement(const UserObject& object, const Value& key, Value* value) const
+{
+    const MappedType* element = Mapper::find(map(object), key.to<KeyType>());
+    if (element && value)
+        *value = *element;
+    return element != nullptr;
+}
+
+template <typename A>
+void MapPropertyImpl<A>::setElement(const UserObject& object, const Value& key, const Value& value) const
+{
+    Mapper::set(map(object), key.to<KeyType>(), value.to<MappedType>());
+}
+
+template <typename A>
+Value MapPropertyImpl<A>::getOrInsertElement(const UserObject& object, const Value& key) const
+{
+    MappedType& element = Mapper::emplace(map(object), key.to<KeyType>());
+
+    // User objects are returned by reference, so they can be modified in place
+    if constexpr (ponder_ext::ValueMapper<MappedType>::kind == ValueKind::User
+                  && !std::is_pointer_v<MappedType>)
+        return UserObject::makeRef(element);
+    else
+        return static_cast<const MappedType&>(element);
+}
+
+template <typename A>
+bool MapPropertyImpl<A>::eraseElement(const UserObject& object, const Value& key) const
+{
+    return Mapper::erase(map(object), key.to<KeyType>());
+}
+
+template <typename A>
+std::unique_ptr<AbstractMapCursor> MapPropertyImpl<A>::createCursor(const UserObject& object) const
+{
+    return std::make_unique<MapCursorImpl<Mapper, MapType>>(map(object));
+}
+
+template <typename A>
+typename MapPropertyImpl<A>::MapType& MapPropertyImpl<A>::map(const UserObject& object) const
+{
+    return m_accessor.m_interface.getter(object.get<typename A::ClassType>());
+}
+
+} // namespace detail
+} // namespace ponder
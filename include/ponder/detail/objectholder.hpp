@@ -31,9 +31,16 @@
 #ifndef PONDER_DETAIL_OBJECTHOLDER_HPP
 #define PONDER_DETAIL_OBJECTHOLDER_HPP
 
+#include <ponder/config.hpp>
+#include <ponder/dirtyset.hpp>
+
 namespace ponder {
+
+class Class;
+class UserObject;
+
 namespace detail {
-    
+
 /**
  * \brief Abstract base class for object holders
  *
@@ -69,6 +76,13 @@ public:
 protected:
 
     AbstractObjectHolder() = default;
+
+private:
+
+    friend class ponder::UserObject;
+
+    const Class* m_trackedClass = nullptr; // Metaclass of the object while its changes are tracked
+    DirtySet m_dirty; // Properties changed since tracking started (see UserObject::trackChanges)
 };
 
 /**
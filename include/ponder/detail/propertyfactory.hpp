@@ -33,6 +33,7 @@
 
 #include <ponder/detail/simplepropertyimpl.hpp>
 #include <ponder/detail/arraypropertyimpl.hpp>
+#include <ponder/detail/mappropertyimpl.hpp>
 #include <ponder/detail/enumpropertyimpl.hpp>
 #include <ponder/detail/userpropertyimpl.hpp>
 #include <ponder/detail/functiontraits.hpp>
@@ -231,6 +232,42 @@ struct AccessTraits<PT,
     using Impl = ArrayPropertyImpl<A>;
 };
 
+/*
+ * Map types.
+ */
+template <typename PT>
+struct AccessTraits<PT,
+                    std::enable_if_t<ponder_ext::MapMapper<typename PT::ExposedTraits::DereferencedType>::isMap>>
+{
+    static constexpr PropertyAccessKind kind = PropertyAccessKind::Map;
+
+    using MapTraits = ponder_ext::MapMapper<typename PT::ExposedTraits::DereferencedType>;
+
+    template <class C>
+    class ValueBinder : public MapTraits
+    {
+    public:
+        using MapType = typename PT::ExposedTraits::DereferencedType;
+        using ClassType = C;
+        using AccessType = typename PT::AccessType&;
+
+        using Binding = typename PT::template Binding<ClassType, AccessType>;
+
+        ValueBinder(const Binding& a) : m_bound(a) {}
+
+        AccessType getter(ClassType& c) const {return m_bound.access(c);}
+
+        bool setter(ClassType& c, AccessType v) const {
+            return this->m_bound.access(c) = v, true;
+        }
+    protected:
+        Binding m_bound;
+    };
+
+    template <typename A>
+    using Impl = MapPropertyImpl<A>;
+};
+
 /*
  * User objects.
  *  - I.e. Registered classes.
@@ -333,6 +370,19 @@ struct PropertyFactory1
     }
 };
 
+/*
+ * Offset of a data member within an instance of C.
+ *  - As ClassBuilder::base(), we do NOT support virtual inheritance here, and use a dummy
+ *    buffer as some platforms trap bad memory access even though not dereferencing the pointer.
+ */
+template <typename C, typename T>
+size_t memberObjectOffset(T accessor)
+{
+    alignas(C) static char dummy[sizeof(C)];
+    const C* object = reinterpret_cast<const C*>(dummy);
+    return static_cast<size_t>(reinterpret_cast<const char*>(&(object->*accessor)) - dummy);
+}
+
 template <typename C, typename T>
 struct PropertyFactory1<C, T, std::enable_if_t<std::is_member_object_pointer_v<T>>>
 {
@@ -344,7 +394,21 @@ struct PropertyFactory1<C, T, std::enable_if_t<std::is_member_object_pointer_v<T
 
         using PropertyImpl = typename Accessor::Access::template Impl<Accessor>;
 
-        return std::make_shared<PropertyImpl>(name, Accessor(accessor));
+        std::shared_ptr<Property> property = std::make_shared<PropertyImpl>(name, Accessor(accessor));
+
+        // Record the member layout so it can be accessed directly
+        property->m_propertyKind = kind;
+        property->m_memberOffset = memberObjectOffset<C>(accessor);
+        property->m_memberType = &typeid(typename MemberTraits<T>::ExposedType);
+        property->m_memberConst = std::is_const_v<typename MemberTraits<T>::ExposedType>;
+
+        // Scalars without padding bits are equal exactly when their bytes are. Classes are
+        // left out as they may have pointers or members which are not properties.
+        using MemberType = typename MemberTraits<T>::ExposedType;
+        if constexpr (IsBitwise<MemberType>::value)
+            property->m_memberBitwiseSize = sizeof(MemberType);
+
+        return property;
     }
 };
 
@@ -0,0 +1,140 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_DETAIL_PROPERTYNOTIFIER_HPP
+#define PONDER_DETAIL_PROPERTYNOTIFIER_HPP
+
+#include <ponder/value.hpp>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ponder {
+
+class PropertyObserver;
+
+namespace detail {
+
+/**
+ * \brief Dispatches property changes to the subscribed PropertyObservers
+ *
+ * Observers are stored by subject, which is either a Class or a Property. Changes can be
+ * notified from several threads, e.g. by ArchiveReader with Parallelism: the observers
+ * are then called on the thread which made the change, outside of the notifier's lock.
+ * Batches are per thread, so a batch only holds back the changes made by its own thread.
+ */
+class PONDER_API PropertyNotifier
+{
+public:
+
+    /**
+     * \brief Get the unique instance of the class
+     *
+     * \return Reference to the unique instance of PropertyNotifier
+     */
+    static PropertyNotifier& instance();
+
+    /**
+     * \brief Check if there is no observer, in which case there is nothing to notify
+     *
+     * \return True if no observer is registered
+     */
+    [[nodiscard]] bool empty() const noexcept {return m_count == 0;}
+
+    /**
+     * \brief Register an observer of a class or a property
+     *
+     * \param subject Observed Class or Property
+     * \param observer Observer to register
+     */
+    void addObserver(const void* subject, PropertyObserver* observer);
+
+    /**
+     * \brief Unregister an observer of a class or a property
+     *
+     * \param subject Observed Class or Property
+     * \param observer Observer to unregister
+     */
+    void removeObserver(const void* subject, PropertyObserver* observer);
+
+    /**
+     * \brief Notify, or queue if a batch is active, the change of a property
+     *
+     * \param object Object whose property has been changed
+     * \param property Property which has been changed
+     */
+    void notify(const UserObject& object, const Property& property);
+
+    /**
+     * \brief Start a batch on the calling thread
+     */
+    void beginBatch();
+
+    /**
+     * \brief End a batch of the calling thread, sending the queued notifications if it was
+     *        the outermost one
+     *
+     * \param notify False to drop the queued notifications instead of sending them
+     */
+    void endBatch(bool notify = true);
+
+private:
+
+    PropertyNotifier();
+
+    // Send a notification to the observers of the object's class and of the property
+    void dispatch(const UserObject& object, const Property& property);
+
+    using ObserverList = std::vector<PropertyObserver*>;
+    using Change = std::pair<const void*, const Property*>; // object address, property
+
+    // Changes held back by the batches of a thread
+    struct Batch
+    {
+        int depth = 0; // Number of nested batches
+        std::vector<std::pair<UserObject, const Property*>> pending; // Queued changes, in order
+        std::set<Change> pendingSet; // Queued changes, to coalesce them
+    };
+
+    // Get the batch of the calling thread
+    static Batch& threadBatch();
+
+    std::mutex m_mutex; // Protects m_observers
+    std::unordered_map<const void*, ObserverList> m_observers; // Observers by subject
+    std::atomic<size_t> m_count; // Total number of registered observers
+};
+
+} // namespace detail
+} // namespace ponder
+
+#endif // PONDER_DETAIL_PROPERTYNOTIFIER_HPP
@@ -32,6 +32,7 @@
 #define PONDER_DETAIL_SIMPLEPROPERTYIMPL_HPP
 
 #include <ponder/simpleproperty.hpp>
+#include <ponder/propertyaccessor.hpp>
 
 namespace ponder {
 namespace detail {
@@ -47,7 +48,9 @@ namespace detail {
  * \sa SimpleProperty
  */
 template <typename A>
-class SimplePropertyImpl final : public SimpleProperty
+class SimplePropertyImpl final
+    : public SimpleProperty
+    , public TypedPropertyAccess<typename A::DataType>
 {
 public:
 
@@ -81,6 +84,16 @@ protected:
      */
     void setValue(const UserObject& object, const Value& value) const;
 
+    /**
+     * \see TypedPropertyAccess::getTyped
+     */
+    [[nodiscard]] typename A::DataType getTyped(const UserObject& object) const;
+
+    /**
+     * \see TypedPropertyAccess::setTyped
+     */
+    bool setTyped(const UserObject& object, const typename A::DataType& value) const;
+
 private:
 
     A m_accessor; // Accessor used to access the actual C++ property
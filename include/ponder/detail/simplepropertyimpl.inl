@@ -51,6 +51,18 @@ void SimplePropertyImpl<A>::setValue(const UserObject& object, const Value& valu
         PONDER_ERROR(ForbiddenWrite(name()));
 }
 
+template <typename A>
+typename A::DataType SimplePropertyImpl<A>::getTyped(const UserObject& object) const
+{
+    return m_accessor.m_interface.getter(object.get<typename A::ClassType>());
+}
+
+template <typename A>
+bool SimplePropertyImpl<A>::setTyped(const UserObject& object, const typename A::DataType& value) const
+{
+    return m_accessor.m_interface.setter(object.get<typename A::ClassType>(), value);
+}
+
 template <typename A>
 bool SimplePropertyImpl<A>::isReadable() const
 {
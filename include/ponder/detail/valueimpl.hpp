@@ -85,7 +85,7 @@ struct CanConvertVisitor
     }
 
     // Optimization when source type is the same as requested type
-    bool operator()(const T& value) const
+    bool operator()(const T&) const
     {
         return true;
     }
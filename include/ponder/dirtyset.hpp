@@ -0,0 +1,185 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_DIRTYSET_HPP
+#define PONDER_DIRTYSET_HPP
+
+#include <ponder/config.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace ponder {
+
+/**
+ * \brief Compact set of the properties of an object which have been changed
+ *
+ * Properties are identified by their index in the object's metaclass (see
+ * Class::property(size_t)). One bit is used per property.
+ *
+ * \code
+ * for (size_t i = dirty.first(); i < dirty.size(); i = dirty.next(i))
+ *     std::cout << metaclass.property(i).name() << " changed" << std::endl;
+ * \endcode
+ *
+ * \sa UserObject::trackChanges, UserObject::dirtyProperties
+ */
+class DirtySet
+{
+public:
+
+    /**
+     * \brief Construct an empty set
+     *
+     * \param size Number of properties which can be stored in the set
+     */
+    explicit DirtySet(size_t size = 0) : m_words((size + c_wordBits - 1) / c_wordBits), m_size(size) {}
+
+    /**
+     * \brief Get the number of properties which can be stored in the set
+     *
+     * \return Number of properties of the tracked object
+     */
+    [[nodiscard]] size_t size() const {return m_size;}
+
+    /**
+     * \brief Check if a property is in the set
+     *
+     * \param index Index of the property
+     * \return True if the property has been changed
+     */
+    [[nodiscard]] bool test(size_t index) const
+    {
+        return index < m_size && (m_words[index / c_wordBits] & bit(index)) != 0;
+    }
+
+    /**
+     * \brief Check if any property is in the set
+     *
+     * \return True if at least one property has been changed
+     */
+    [[nodiscard]] bool any() const
+    {
+        for (const Word word : m_words)
+            if (word)
+                return true;
+        return false;
+    }
+
+    /**
+     * \brief Get the number of properties in the set
+     *
+     * \return Number of changed properties
+     */
+    [[nodiscard]] size_t count() const
+    {
+        size_t total = 0;
+        for (Word word : m_words)
+            for (; word; word &= word - 1)
+                ++total;
+        return total;
+    }
+
+    /**
+     * \brief Get the first property in the set
+     *
+     * \return Index of the first changed property, or size() if there is none
+     */
+    [[nodiscard]] size_t first() const {return find(0);}
+
+    /**
+     * \brief Get the next property in the set
+     *
+     * \param index Index of the current property
+     * \return Index of the next changed property, or size() if there is none
+     */
+    [[nodiscard]] size_t next(size_t index) const {return find(index + 1);}
+
+    /**
+     * \brief Add a property to the set
+     *
+     * \param index Index of the property
+     */
+    void set(size_t index)
+    {
+        if (index < m_size)
+            m_words[index / c_wordBits] |= bit(index);
+    }
+
+    /**
+     * \brief Remove a property from the set
+     *
+     * \param index Index of the property
+     */
+    void reset(size_t index)
+    {
+        if (index < m_size)
+            m_words[index / c_wordBits] &= ~bit(index);
+    }
+
+    /**
+     * \brief Remove all the properties from the set
+     */
+    void clear()
+    {
+        for (Word& word : m_words)
+            word = 0;
+    }
+
+private:
+
+    using Word = std::uint64_t;
+    static constexpr size_t c_wordBits = 64;
+
+    static Word bit(size_t index) {return Word(1) << (index % c_wordBits);}
+
+    size_t find(size_t index) const
+    {
+        while (index < m_size)
+        {
+            Word word = m_words[index / c_wordBits] >> (index % c_wordBits);
+            if (word != 0)
+            {
+                // Bits past the last property are never set
+                for (; (word & 1) == 0; word >>= 1)
+                    ++index;
+                return index;
+            }
+            index = (index / c_wordBits + 1) * c_wordBits; // skip the rest of the word
+        }
+        return m_size;
+    }
+
+    std::vector<Word> m_words; // One bit per property
+    size_t m_size; // Number of properties
+};
+
+} // namespace ponder
+
+#endif // PONDER_DIRTYSET_HPP
@@ -216,6 +216,21 @@ public:
     ForbiddenCall(IdRef functionName);
 };
 
+/**
+ * \brief Error thrown when trying to copy an object whose class cannot be copied
+ */
+class PONDER_API ForbiddenCopy final : public Error
+{
+public:
+
+    /**
+     * \brief Constructor
+     *
+     * \param className Name of the metaclass
+     */
+    ForbiddenCopy(IdRef className);
+};
+
 /**
  * \brief Error thrown when trying to read a property that is not readable
  */
@@ -262,6 +277,22 @@ public:
     FunctionNotFound(IdRef name, IdRef className);
 };
 
+/**
+ * \brief Error thrown when a key can't be found in a map property
+ */
+class PONDER_API KeyNotFound final : public Error
+{
+public:
+
+    /**
+     * \brief Constructor
+     *
+     * \param key Requested key, as text
+     * \param propertyName Name of the map property
+     */
+    KeyNotFound(const String& key, IdRef propertyName);
+};
+
 /**
  * \brief Error thrown when a declaring a metaclass that already exists
  */
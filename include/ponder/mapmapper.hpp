@@ -0,0 +1,210 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_MAPMAPPER_HPP
+#define PONDER_MAPMAPPER_HPP
+
+#include <ponder/config.hpp>
+#include <map>
+#include <unordered_map>
+
+namespace ponder_ext {
+
+/**
+ * \class MapMapper
+ *
+ * \brief Template providing a mapping between C++ associative containers and Ponder MapProperty
+ *
+ * MapMapper<T> must define the following members in order to make T fully compliant
+ * with the system:
+ *
+ *  - `KeyType`: type of the keys
+ *  - `MappedType`: type of the values stored in the map
+ *  - `Iterator`: type used to walk the entries of the map
+ *  - `size()`: retrieve the number of entries in the map
+ *  - `find()`: pointer to the value associated to a key, or null
+ *  - `set()`: insert a new entry, or assign the value of an existing one
+ *  - `emplace()`: reference to the value associated to a key, inserted if needed
+ *  - `erase()`: remove an entry
+ *  - `begin()`, `end()`: iterators to the entries of the map
+ *  - `key()`, `value()`: access the entry pointed to by an iterator
+ *
+ * Lookups should use the native search of the container, they are not expected to be
+ * linear.
+ *
+ * MapMapper is specialized for every supported type, and can be specialized
+ * for any of your own map types in order to extend the system.
+ *
+ * By default, MapMapper supports the following types of map:
+ *
+ *  - `std::map`
+ *  - `std::unordered_map`
+ *
+ * Here is an example of mapping for the `std::map` class:
+ *
+ * \snippet this doc_mapmapper
+ */
+
+/** \cond NoDocumentation */
+
+/*
+ * Default. Not a map type.
+ */
+template <typename T>
+struct MapMapper
+{
+    static constexpr bool isMap = false;
+};
+
+/*
+ * Specialization of MapMapper for std::map
+ */
+//! [doc_mapmapper]
+template <typename K, typename V, typename C, typename A>
+struct MapMapper<std::map<K, V, C, A>>
+{
+    static constexpr bool isMap = true;
+    using MapType = std::map<K, V, C, A>;
+    using KeyType = K;
+    using MappedType = V;
+    using Iterator = typename MapType::iterator;
+
+    static size_t size(const MapType& map)
+    {
+        return map.size();
+    }
+
+    static const V* find(const MapType& map, const K& key)
+    {
+        const auto it = map.find(key);
+        return it != map.end() ? &it->second : nullptr;
+    }
+
+    static void set(MapType& map, const K& key, const V& value)
+    {
+        map.insert_or_assign(key, value);
+    }
+
+    static V& emplace(MapType& map, const K& key)
+    {
+        return map[key];
+    }
+
+    static bool erase(MapType& map, const K& key)
+    {
+        return map.erase(key) != 0;
+    }
+
+    static Iterator begin(MapType& map)
+    {
+        return map.begin();
+    }
+
+    static Iterator end(MapType& map)
+    {
+        return map.end();
+    }
+
+    static const K& key(const Iterator& it)
+    {
+        return it->first;
+    }
+
+    static V& value(const Iterator& it)
+    {
+        return it->second;
+    }
+};
+//! [doc_mapmapper]
+
+/*
+ * Specialization of MapMapper for std::unordered_map
+ */
+template <typename K, typename V, typename H, typename E, typename A>
+struct MapMapper<std::unordered_map<K, V, H, E, A>>
+{
+    static constexpr bool isMap = true;
+    using MapType = std::unordered_map<K, V, H, E, A>;
+    using KeyType = K;
+    using MappedType = V;
+    using Iterator = typename MapType::iterator;
+
+    static size_t size(const MapType& map)
+    {
+        return map.size();
+    }
+
+    static const V* find(const MapType& map, const K& key)
+    {
+        const auto it = map.find(key);
+        return it != map.end() ? &it->second : nullptr;
+    }
+
+    static void set(MapType& map, const K& key, const V& value)
+    {
+        map.insert_or_assign(key, value);
+    }
+
+    static V& emplace(MapType& map, const K& key)
+    {
+        return map[key];
+    }
+
+    static bool erase(MapType& map, const K& key)
+    {
+        return map.erase(key) != 0;
+    }
+
+    static Iterator begin(MapType& map)
+    {
+        return map.begin();
+    }
+
+    static Iterator end(MapType& map)
+    {
+        return map.end();
+    }
+
+    static const K& key(const Iterator& it)
+    {
+        return it->first;
+    }
+
+    static V& value(const Iterator& it)
+    {
+        return it->second;
+    }
+};
+
+/** \endcond NoDocumentation */
+
+} // namespace ponder_ext
+
+#endif // PONDER_MAPMAPPER_HPP
@@ -0,0 +1,395 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_MAPPROPERTY_HPP
+#define PONDER_MAPPROPERTY_HPP
+
+
+#include <ponder/property.hpp>
+#include <memory>
+
+
+namespace ponder
+{
+
+class MapProperty;
+
+namespace detail {
+
+/*
+ * Typed position in a map, created by MapProperty::createCursor.
+ */
+class AbstractMapCursor
+{
+public:
+    virtual ~AbstractMapCursor() = default;
+    [[nodiscard]] virtual Value key() const = 0;
+    [[nodiscard]] virtual Value value() const = 0;
+    virtual void setValue(const Value& value) = 0;
+    virtual void next() = 0;
+};
+
+} // namespace detail
+
+/**
+ * \brief Forward cursor over the entries of a map property
+ *
+ * A cursor walks all the entries of a map in the order of the underlying container,
+ * without any lookup.
+ *
+ * \code
+ * for (ponder::MapCursor it = mapProperty.cursor(object); it.valid(); it.next())
+ *     std::cout << it.key() << " = " << it.value() << std::endl;
+ * \endcode
+ *
+ * \note Inserting or removing entries invalidates the cursor.
+ *
+ * \sa MapProperty::cursor
+ */
+class PONDER_API MapCursor
+{
+public:
+
+    /**
+     * \brief Check if the cursor points to an entry
+     *
+     * \return False when all the entries have been visited
+     */
+    [[nodiscard]] bool valid() const {return m_index < m_size;}
+
+    /**
+     * \brief Get the number of entries in the map
+     *
+     * \return Size of the map when the cursor was created
+     */
+    [[nodiscard]] size_t size() const {return m_size;}
+
+    /**
+     * \brief Get the key of the current entry
+     *
+     * \return Key of the entry
+     *
+     * \throw OutOfRange the cursor is not valid
+     */
+    [[nodiscard]] Value key() const;
+
+    /**
+     * \brief Get the value of the current entry
+     *
+     * \return Value of the entry
+     *
+     * \throw OutOfRange the cursor is not valid
+     */
+    [[nodiscard]] Value value() const;
+
+    /**
+     * \brief Set the value of the current entry
+     *
+     * \param value New value to assign to the entry
+     *
+     * \throw ForbiddenWrite property is not writable
+     * \throw OutOfRange the cursor is not valid
+     * \throw BadType \a value can't be converted to the property's mapped type
+     */
+    void setValue(const Value& value) const;
+
+    /**
+     * \brief Move to the next entry
+     */
+    void next();
+
+private:
+
+    friend class MapProperty;
+
+    MapCursor(const MapProperty& property, const UserObject& object, size_t size,
+              std::unique_ptr<detail::AbstractMapCursor> cursor);
+
+    const MapProperty* m_property; // Map being walked
+    UserObject m_object; // Owner of the map, kept alive while walking it
+    std::unique_ptr<detail::AbstractMapCursor> m_cursor; // Typed position in the map
+    size_t m_index; // Index of the current entry
+    size_t m_size; // Size of the map
+};
+
+/**
+ * \brief Specialized type of property for associative containers
+ *
+ * Lookups use the native search of the container (e.g. logarithmic for `std::map`,
+ * constant on average for `std::unordered_map`).
+ */
+class PONDER_API MapProperty : public Property
+{
+public:
+
+    /**
+     * \brief Construct the property from its description
+     *
+     * \param name Name of the property
+     * \param keyType Type of the keys
+     * \param mappedType Type of the values
+     */
+    MapProperty(IdRef name, ValueKind keyType, ValueKind mappedType);
+
+    /**
+     * \brief Get the type of the map keys
+     *
+     * \return Type of keys
+     */
+    [[nodiscard]] ValueKind keyType() const;
+
+    /**
+     * \brief Get the type of the map values
+     *
+     * \return Type of values
+     */
+    [[nodiscard]] ValueKind mappedType() const;
+
+    /**
+     * \brief Get the metaclass of the map values
+     *
+     * The metaclass is looked up when asked for, which registers it if it was declared
+     * with PONDER_AUTO_TYPE().
+     *
+     * \return Metaclass of the values if they are user objects, null otherwise
+     */
+    [[nodiscard]] const Class* mappedClass() const;
+
+    /**
+     * \brief Get the metaenum of the map values
+     *
+     * \return Metaenum of the values if they are enums, null otherwise
+     */
+    [[nodiscard]] const Enum* mappedEnum() const;
+
+    /**
+     * \brief Get the current number of entries in the map
+     *
+     * \param object Object
+     * \return Number of entries in the map
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenRead property is not readable
+     */
+    [[nodiscard]] size_t size(const UserObject& object) const;
+
+    /**
+     * \brief Check if the map contains a key
+     *
+     * \param object Object
+     * \param key Key to look for
+     * \return True if the key is in the map
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenRead property is not readable
+     * \throw BadType \a key can't be converted to the property's key type
+     */
+    [[nodiscard]] bool contains(const UserObject& object, const Value& key) const;
+
+    /**
+     * \brief Get the value associated to a key
+     *
+     * \param object Object
+     * \param key Key of the entry
+     * \return Value of the entry
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenRead property is not readable
+     * \throw BadType \a key can't be converted to the property's key type
+     * \throw KeyNotFound \a key is not in the map
+     */
+    [[nodiscard]] Value get(const UserObject& object, const Value& key) const;
+
+    /**
+     * \brief Set the value associated to a key
+     *
+     * The entry is inserted if the key is not in the map yet.
+     *
+     * \param object Object
+     * \param key Key of the entry
+     * \param value New value to assign to the entry
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenWrite property is not writable
+     * \throw BadType \a key or \a value can't be converted to the property's types
+     */
+    void set(const UserObject& object, const Value& key, const Value& value) const;
+
+    /**
+     * \brief Get the value associated to a key, inserting a default one if needed
+     *
+     * User objects are returned by reference to the entry, so they can be modified in
+     * place. Other values are copies.
+     *
+     * \param object Object
+     * \param key Key of the entry
+     * \return Value of the entry
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenWrite property is not writable
+     * \throw BadType \a key can't be converted to the property's key type
+     */
+    Value getOrInsert(const UserObject& object, const Value& key) const;
+
+    /**
+     * \brief Remove an entry from the map
+     *
+     * \param object Object
+     * \param key Key of the entry to remove
+     * \return True if an entry was removed
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenWrite property is not writable
+     * \throw BadType \a key can't be converted to the property's key type
+     */
+    bool erase(const UserObject& object, const Value& key) const;
+
+    /**
+     * \brief Get a cursor to walk the entries of the map for a given object
+     *
+     * \param object Object
+     * \return Cursor pointing to the first entry
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenRead property is not readable
+     */
+    [[nodiscard]] MapCursor cursor(const UserObject& object) const;
+
+    /**
+     * \brief Accept the visitation of a ClassVisitor
+     *
+     * \param visitor Visitor to accept
+     */
+    void accept(ClassVisitor& visitor) const override;
+
+protected:
+
+    /**
+     * \see Property::getValue
+     */
+    [[nodiscard]] Value getValue(const UserObject& object) const override;
+
+    /**
+     * \see Property::setValue
+     */
+    void setValue(const UserObject& object, const Value& value) const override;
+
+    /**
+     * \brief Do the actual retrieval of the size
+     *
+     * \param object Object
+     * \return Number of entries in the map
+     */
+    [[nodiscard]] virtual size_t getSize(const UserObject& object) const = 0;
+
+    /**
+     * \brief Do the actual lookup of the metaclass of the values
+     *
+     * This function is a pure virtual which has to be implemented in derived classes
+     *
+     * \return Metaclass of the values, or null
+     */
+    [[nodiscard]] virtual const Class* getMappedClass() const = 0;
+
+    /**
+     * \brief Do the actual lookup of the metaenum of the values
+     *
+     * This function is a pure virtual which has to be implemented in derived classes
+     *
+     * \return Metaenum of the values, or null
+     */
+    [[nodiscard]] virtual const Enum* getMappedEnum() const = 0;
+
+    /**
+     * \brief Do the actual lookup of an entry
+     *
+     * This function is a pure virtual which has to be implemented in derived classes
+     *
+     * \param object Object
+     * \param key Key of the entry
+     * \param value Receives the value of the entry, if found
+     * \return True if the key was found
+     */
+    virtual bool findElement(const UserObject& object, const Value& key, Value* value) const = 0;
+
+    /**
+     * \brief Do the actual insertion or assignment of an entry
+     *
+     * This function is a pure virtual which has to be implemented in derived classes
+     *
+     * \param object Object
+     * \param key Key of the entry
+     * \param value New value to assign to the entry
+     */
+    virtual void setElement(const UserObject& object, const Value& key, const Value& value) const = 0;
+
+    /**
+     * \brief Do the actual retrieval of an entry, inserted if needed
+     *
+     * This function is a pure virtual which has to be implemented in derived classes
+     *
+     * \param object Object
+     * \param key Key of the entry
+     * \return Value of the entry
+     */
+    virtual Value getOrInsertElement(const UserObject& object, const Value& key) const = 0;
+
+    /**
+     * \brief Do the actual removal of an entry
+     *
+     * This function is a pure virtual which has to be implemented in derived classes
+     *
+     * \param object Object
+     * \param key Key of the entry to remove
+     * \return True if an entry was removed
+     */
+    virtual bool eraseElement(const UserObject& object, const Value& key) const = 0;
+
+    /**
+     * \brief Do the actual creation of a cursor
+     *
+     * This function is a pure virtual which has to be implemented in derived classes
+     *
+     * \param object Object
+     * \return Cursor pointing to the first entry
+     */
+    [[nodiscard]] virtual std::unique_ptr<detail::AbstractMapCursor>
+        createCursor(const UserObject& object) const = 0;
+
+private:
+
+    ValueKind m_keyType; // Type of the keys of the map
+    ValueKind m_mappedType; // Type of the values of the map
+};
+
+} // namespace ponder
+
+
+#endif // PONDER_MAPPROPERTY_HPP
@@ -37,6 +37,8 @@ namespace ponder {
 
 class Class;
 class Enum;
+class Property;
+class UserObject;
 
 /**
  * \brief Receives notification about creation / destruction of metaclasses and metaenums
@@ -101,6 +103,136 @@ PONDER_API void addObserver(Observer* observer);
  */
 PONDER_API void removeObserver(Observer* observer);
 
+/**
+ * \brief Receives notification about changes of properties made through Ponder
+ *
+ * Observers are subscribed to a metaclass, to be notified of the changes of all the
+ * properties of its instances, or to a single property. Notifications are sent for
+ * writes made through Ponder only (Property::set, UserObject::set, array and map
+ * element writes), direct C++ writes can't be seen.
+ *
+ * \code
+ * class Binding : public ponder::PropertyObserver
+ * {
+ *     void propertyChanged(const ponder::UserObject& object, const ponder::Property& property) override
+ *     {
+ *         refresh(object, property.name());
+ *     }
+ * };
+ *
+ * ponder::addPropertyObserver(ponder::classByType<MyClass>(), &binding);
+ * \endcode
+ *
+ * \sa PropertyChangeBatch
+ */
+class PONDER_API PropertyObserver
+{
+public:
+    virtual ~PropertyObserver() = default;
+
+    /**
+     * \brief Function called when a property of an object has been changed
+     *
+     * \param object Object whose property has been changed
+     * \param property Property which has been changed
+     */
+    virtual void propertyChanged(const UserObject& object, const Property& property) = 0;
+
+protected:
+
+    /**
+     * \brief Default constructor
+     */
+    PropertyObserver();
+};
+
+/**
+ * \brief Register an observer of the changes of the properties of a metaclass instances
+ *
+ * The observer is only notified for objects whose metaclass is \a metaclass, not for
+ * objects of derived classes.
+ *
+ * \param metaclass Metaclass to observe
+ * \param observer Pointer to the observer instance to register
+ */
+PONDER_API void addPropertyObserver(const Class& metaclass, PropertyObserver* observer);
+
+/**
+ * \brief Register an observer of the changes of a property
+ *
+ * \param property Property to observe
+ * \param observer Pointer to the observer instance to register
+ */
+PONDER_API void addPropertyObserver(const Property& property, PropertyObserver* observer);
+
+/**
+ * \brief Unregister an observer of the changes of the properties of a metaclass instances
+ *
+ * \param metaclass Observed metaclass
+ * \param observer Pointer to the observer instance to unregister
+ */
+PONDER_API void removePropertyObserver(const Class& metaclass, PropertyObserver* observer);
+
+/**
+ * \brief Unregister an observer of the changes of a property
+ *
+ * \param property Observed property
+ * \param observer Pointer to the observer instance to unregister
+ */
+PONDER_API void removePropertyObserver(const Property& property, PropertyObserver* observer);
+
+/**
+ * \brief Scope coalescing property change notifications
+ *
+ * While a batch is alive, property changes are not notified immediately. When the
+ * outermost batch is committed, each changed property of each object is notified once,
+ * in the order of the first change. A batch only holds back the changes made by the
+ * thread which opened it.
+ *
+ * A batch which is not committed explicitly is committed by its destructor, which ignores
+ * the exceptions thrown by the observers. If the batch is destroyed by an exception,
+ * its changes are not notified at all.
+ *
+ * \code
+ * {
+ *     ponder::PropertyChangeBatch batch;
+ *     for (auto& item : items)
+ *         property.set(item, 0); // no notification
+ *     batch.commit(); // one notification per item
+ * }
+ * \endcode
+ */
+class PONDER_API PropertyChangeBatch
+{
+public:
+
+    /**
+     * \brief Start coalescing notifications
+     */
+    PropertyChangeBatch();
+
+    /**
+     * \brief Commit the batch if it is still open, or drop it during stack unwinding
+     */
+    ~PropertyChangeBatch();
+
+    PropertyChangeBatch(const PropertyChangeBatch&) = delete;
+    PropertyChangeBatch& operator = (const PropertyChangeBatch&) = delete;
+
+    /**
+     * \brief End the batch, sending the coalesced notifications if this is the outermost batch
+     *
+     * Further calls do nothing. The exceptions thrown by the observers are propagated, and
+     * the notifications which were not sent yet are dropped.
+     */
+    void commit();
+
+private:
+
+    bool m_open; // Is the batch still open?
+    int m_exceptions; // Number of uncaught exceptions when the batch started
+};
+
 } // namespace ponder
 
 #endif // PONDER_OBSERVER_HPP
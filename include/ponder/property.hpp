@@ -33,12 +33,22 @@
 
 
 #include <ponder/value.hpp>
+#include <type_traits>
+#include <typeinfo>
 
 namespace ponder
 {
 
 class ClassVisitor;
 
+namespace detail {
+template <typename C, typename T, typename E> struct PropertyFactory1;
+}
+namespace runtime {
+class PropertyPlan;
+class ObjectComparator;
+}
+
 /**
  * \brief Abstract representation of a property
  *
@@ -117,6 +127,55 @@ public:
      */
     void set(const UserObject& object, const Value& value) const;
 
+    /**
+     * \brief Get the kind of C++ entity the property is bound to
+     *
+     * \return PropertyKind::MemberObject if bound to a pointer to data member,
+     *         PropertyKind::Function otherwise
+     */
+    [[nodiscard]] PropertyKind propertyKind() const;
+
+    /**
+     * \brief Get the offset of the bound data member within its owner class
+     *
+     * This is only meaningful if propertyKind() is PropertyKind::MemberObject, otherwise
+     * zero is returned.
+     *
+     * \return Offset of the data member, in bytes
+     */
+    [[nodiscard]] size_t memberOffset() const;
+
+    /**
+     * \brief Get the native C++ type of the bound data member
+     *
+     * \return Type of the data member, or `void` if the property is not bound to one
+     */
+    [[nodiscard]] TypeId memberType() const;
+
+    /**
+     * \brief Get direct access to the bound data member of a given object
+     *
+     * This reads the member straight from memory, using memberOffset(), without boxing it
+     * into a Value. It is intended for serialisers and bulk extraction where get() is too
+     * costly. The read/write flags of the property are not checked.
+     *
+     * \code
+     * const ponder::Property& x = ponder::classByType<Point>().property("x");
+     * float* px = x.memberPointer<float>(ponder::UserObject::makeRef(point));
+     * \endcode
+     *
+     * A const data member must be accessed with a const \a T.
+     *
+     * \param object Object
+     * \return Pointer to the data member of \a object
+     *
+     * \throw BadType property is not bound to a data member, T is not the type of the data
+     *        member, or T is not const while the data member is
+     * \throw NullObject object is invalid
+     */
+    template <typename T>
+    [[nodiscard]] T* memberPointer(const UserObject& object) const;
+
     /**
      * \brief Accept the visitation of a ClassVisitor
      *
@@ -127,7 +186,10 @@ public:
 protected:
 
     template <typename T> friend class ClassBuilder;
+    template <typename C, typename T, typename E> friend struct detail::PropertyFactory1;
     friend class UserObject;
+    friend class runtime::PropertyPlan;
+    friend class runtime::ObjectComparator;
 
     /**
      * \brief Construct the property from its description
@@ -176,10 +238,29 @@ protected:
 
 private:
 
+    // Address of the bound data member within object
+    [[nodiscard]] void* memberAddress(const UserObject& object) const;
+
     Id m_name; // Name of the property
     ValueKind m_type; // Type of the property
+    PropertyKind m_propertyKind; // Kind of C++ entity the property is bound to
+    size_t m_memberOffset; // Offset of the bound data member within the owner class
+    const std::type_info* m_memberType; // Type of the bound data member, if any
+    bool m_memberConst; // Is the bound data member const?
+    size_t m_memberBitwiseSize; // Size of the bound data member, if it compares bytewise
+    const Class* m_ownerClass; // Metaclass which declared the property
 };
 
+template <typename T>
+T* Property::memberPointer(const UserObject& object) const
+{
+    if (m_memberType == nullptr || *m_memberType != typeid(T)
+        || (m_memberConst && !std::is_const_v<T>))
+        PONDER_ERROR(BadType(mapType<T>(), kind()));
+
+    return static_cast<T*>(memberAddress(object));
+}
+
 } // namespace ponder
 
 
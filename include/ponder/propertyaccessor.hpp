@@ -0,0 +1,298 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_PROPERTYACCESSOR_HPP
+#define PONDER_PROPERTYACCESSOR_HPP
+
+#include <ponder/property.hpp>
+#include <ponder/userobject.hpp>
+#include <ponder/classget.hpp>
+
+namespace ponder {
+namespace detail {
+
+/**
+ * \brief Typed interface to a property, implemented by properties whose data type is T
+ *
+ * \sa PropertyAccessor
+ */
+template <typename T>
+class TypedPropertyAccess
+{
+public:
+
+    virtual ~TypedPropertyAccess() = default;
+
+    /**
+     * \brief Get the value of the property, without converting to Value
+     */
+    [[nodiscard]] virtual T getTyped(const UserObject& object) const = 0;
+
+    /**
+     * \brief Set the value of the property, without converting from Value
+     *
+     * \return False if the property is read-only
+     */
+    virtual bool setTyped(const UserObject& object, const T& value) const = 0;
+};
+
+} // namespace detail
+
+/**
+ * \brief Typed access to a property, bypassing Value
+ *
+ * Property::get() and Property::set() box and unbox the data through a Value, which is
+ * convenient but costly in inner loops. A PropertyAccessor is obtained once from a property
+ * whose type is exactly T, then reads and writes T directly through the bound accessors.
+ *
+ * \code
+ * const ponder::Property& property = metaclass.property("mass");
+ * ponder::PropertyAccessor<double> mass(property);
+ *
+ * for (auto& object : objects)
+ *     mass.set(object, mass.get(object) * 2.0);
+ * \endcode
+ *
+ * Only simple and enum properties are supported.
+ *
+ * \note Values set through the accessor don't go through UserObject::set(), so this is the
+ *       lowest level of access to the bound data.
+ *
+ * \sa Property
+ */
+template <typename T>
+class PropertyAccessor
+{
+public:
+
+    /**
+     * \brief Construct the accessor from a property
+     *
+     * \param property Property to access
+     *
+     * \throw BadType the property is not a simple or enum property of type T
+     */
+    explicit PropertyAccessor(const Property& property);
+
+    /**
+     * \brief Get the property which is accessed
+     *
+     * \return Reference to the property
+     */
+    [[nodiscard]] const Property& property() const {return *m_property;}
+
+    /**
+     * \brief Get the current value of the property for a given object
+     *
+     * \param object Object
+     *
+     * \return Value of the property
+     *
+     * \throw NullObject object is invalid
+     */
+    [[nodiscard]] T get(const UserObject& object) const;
+
+    /**
+     * \brief Set the current value of the property for a given object
+     *
+     * \param object Object
+     * \param value New value to assign to the property
+     *
+     * \throw ForbiddenWrite property is not writable
+     * \throw NullObject object is invalid
+     */
+    void set(const UserObject& object, const T& value) const;
+
+    /**
+     * \brief Read the property of a range of objects into a contiguous buffer
+     *
+     * When the property is bound to a data member of type T, the values are copied
+     * straight from memory, otherwise the bound getter is called for each object.
+     *
+     * \param first Pointer to the first object
+     * \param count Number of objects
+     * \param out Buffer receiving count values
+     * \param stride Distance in bytes between two consecutive objects
+     *
+     * \throw NullObject first is null and count is not zero
+     */
+    template <typename C>
+    void gather(const C* first, size_t count, T* out, size_t stride = sizeof(C)) const;
+
+    /**
+     * \brief Read the property of an array of user objects into a contiguous buffer
+     *
+     * \param objects Pointer to the first object
+     * \param count Number of objects
+     * \param out Buffer receiving count values
+     *
+     * \throw NullObject one of the objects is invalid
+     */
+    void gather(const UserObject* objects, size_t count, T* out) const;
+
+    /**
+     * \brief Write the property of a range of objects from a contiguous buffer
+     *
+     * This is the reverse of gather().
+     *
+     * \param first Pointer to the first object
+     * \param count Number of objects
+     * \param in Buffer holding count values
+     * \param stride Distance in bytes between two consecutive objects
+     *
+     * \throw ForbiddenWrite property is not writable, e.g. it is bound to a const data member
+     * \throw NullObject first is null and count is not zero
+     */
+    template <typename C>
+    void scatter(C* first, size_t count, const T* in, size_t stride = sizeof(C)) const;
+
+    /**
+     * \brief Write the property of an array of user objects from a contiguous buffer
+     *
+     * \param objects Pointer to the first object
+     * \param count Number of objects
+     * \param in Buffer holding count values
+     *
+     * \throw ForbiddenWrite property is not writable
+     * \throw NullObject one of the objects is invalid
+     */
+    void scatter(const UserObject* objects, size_t count, const T* in) const;
+
+private:
+
+    template <typename C>
+    static C* objectAt(C* first, size_t index, size_t stride);
+
+    const Property* m_property; // Accessed property
+    const detail::TypedPropertyAccess<T>* m_access; // Typed interface of the property
+    bool m_direct; // Is the property a data member of type T?
+};
+
+template <typename T>
+PropertyAccessor<T>::PropertyAccessor(const Property& property)
+    : m_property(&property)
+    , m_access(dynamic_cast<const detail::TypedPropertyAccess<T>*>(&property))
+    , m_direct(property.propertyKind() == PropertyKind::MemberObject
+               && property.memberType() == TypeId(typeid(T)))
+{
+    if (!m_access)
+        PONDER_ERROR(BadType(mapType<T>(), property.kind()));
+}
+
+template <typename T>
+T PropertyAccessor<T>::get(const UserObject& object) const
+{
+    return m_access->getTyped(object);
+}
+
+template <typename T>
+void PropertyAccessor<T>::set(const UserObject& object, const T& value) const
+{
+    if (!m_access->setTyped(object, value))
+        PONDER_ERROR(ForbiddenWrite(m_property->name()));
+}
+
+template <typename T>
+template <typename C>
+C* PropertyAccessor<T>::objectAt(C* first, size_t index, size_t stride)
+{
+    using Byte = std::conditional_t<std::is_const_v<C>, const char, char>;
+    return reinterpret_cast<C*>(reinterpret_cast<Byte*>(first) + index * stride);
+}
+
+template <typename T>
+template <typename C>
+void PropertyAccessor<T>::gather(const C* first, size_t count, T* out, size_t stride) const
+{
+    if (count == 0)
+        return;
+    if (!first)
+        PONDER_ERROR(NullObject(&classByType<C>()));
+
+    if (m_direct)
+    {
+        // The member is at the same offset in all objects, so find it once and walk memory
+        const T* member = m_property->memberPointer<const T>(UserObject::makeRef(first));
+        const char* data = reinterpret_cast<const char*>(member);
+        for (size_t i = 0; i < count; ++i)
+            out[i] = *reinterpret_cast<const T*>(data + i * stride);
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+            out[i] = m_access->getTyped(UserObject::makeRef(objectAt(first, i, stride)));
+    }
+}
+
+template <typename T>
+void PropertyAccessor<T>::gather(const UserObject* objects, size_t count, T* out) const
+{
+    for (size_t i = 0; i < count; ++i)
+        out[i] = m_access->getTyped(objects[i]);
+}
+
+template <typename T>
+template <typename C>
+void PropertyAccessor<T>::scatter(C* first, size_t count, const T* in, size_t stride) const
+{
+    if (!m_property->isWritable())
+        PONDER_ERROR(ForbiddenWrite(m_property->name()));
+    if (count == 0)
+        return;
+    if (!first)
+        PONDER_ERROR(NullObject(&classByType<C>()));
+
+    if (m_direct)
+    {
+        T* member = m_property->memberPointer<T>(UserObject::makeRef(first));
+        char* data = reinterpret_cast<char*>(member);
+        for (size_t i = 0; i < count; ++i)
+            *reinterpret_cast<T*>(data + i * stride) = in[i];
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+            m_access->setTyped(UserObject::makeRef(objectAt(first, i, stride)), in[i]);
+    }
+}
+
+template <typename T>
+void PropertyAccessor<T>::scatter(const UserObject* objects, size_t count, const T* in) const
+{
+    if (!m_property->isWritable())
+        PONDER_ERROR(ForbiddenWrite(m_property->name()));
+
+    for (size_t i = 0; i < count; ++i)
+        m_access->setTyped(objects[i], in[i]);
+}
+
+} // namespace ponder
+
+#endif // PONDER_PROPERTYACCESSOR_HPP
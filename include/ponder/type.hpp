@@ -78,6 +78,7 @@ enum class ValueKind
     Array,      ///< Array types (`T[]`, `std::vector`, `std::list`)
     Reference,  ///< Reference types (`T*`, `const T*`, `T&`, `const T&`)
     User,       ///< User-defined classes
+    Map,        ///< Associative types (`std::map`, `std::unordered_map`)
 };
 
 /**
@@ -131,7 +132,8 @@ enum class PropertyAccessKind
     Simple,
     Enum,
     Container,
-    User
+    User,
+    Map
 };
 
 
@@ -35,14 +35,22 @@
 #include <ponder/classcast.hpp>
 #include <ponder/detail/objecttraits.hpp>
 #include <ponder/detail/objectholder.hpp>
+#include <ponder/dirtyset.hpp>
 
 namespace ponder {
 
 class Property;
 class UserProperty;
+class ArrayProperty;
+class ArrayCursor;
+class MapProperty;
+class MapCursor;
 class Value;
 class Args;
 class ParentObject;
+namespace runtime {
+class PropertyPlan;
+}
 
 /**
  * \brief Wrapper to manipulate user objects in the Ponder system
@@ -272,6 +280,57 @@ public:
      */
     void set(size_t index, const Value& value) const;
 
+    /**
+     * \brief Enable or disable the tracking of the changes made to the object's properties
+     *
+     * While tracking is enabled, every property written through Ponder (Property::set,
+     * UserObject::set, array and map element writes) is recorded in a DirtySet, indexed
+     * by the index of the property in the object's metaclass. Tracking is disabled by
+     * default, and costs nothing for objects which are not tracked.
+     *
+     * The dirty set is stored with the UserObject and shared by its copies: only the
+     * changes made through them are recorded, not those made through another UserObject
+     * wrapping the same instance. It is released with the last copy, so a new object
+     * constructed at the same address doesn't inherit it.
+     *
+     * \note Like the object itself, a tracked UserObject must not be written from several
+     *       threads at once.
+     *
+     * \param enable True to start tracking changes (clearing the dirty set), false to stop
+     *
+     * \throw NullObject object is invalid
+     */
+    void trackChanges(bool enable = true) const;
+
+    /**
+     * \brief Check if the changes made to the object's properties are tracked
+     *
+     * \return True if trackChanges() has been enabled for this object
+     */
+    [[nodiscard]] bool isTrackingChanges() const;
+
+    /**
+     * \brief Get the set of the properties changed since tracking started or was last cleared
+     *
+     * \return Dirty set of the object, empty if the object is not tracked
+     */
+    [[nodiscard]] const DirtySet& dirtyProperties() const;
+
+    /**
+     * \brief Check if a property has been changed since tracking started or was last cleared
+     *
+     * \param property Name of the property
+     * \return True if the property has been changed
+     *
+     * \throw PropertyNotFound \a property is not a property of the object
+     */
+    [[nodiscard]] bool isDirty(IdRef property) const;
+
+    /**
+     * \brief Forget all the changes recorded for the object
+     */
+    void clearDirty() const;
+
     /**
      * \brief Operator == to compare equality between two user objects
      *
@@ -308,10 +367,18 @@ public:
 private:
 
     friend class Property;
+    friend class ArrayProperty;
+    friend class ArrayCursor;
+    friend class MapProperty;
+    friend class MapCursor;
+    friend class runtime::PropertyPlan;
 
      // Assign a new value to a property of the object
     void set(const Property& property, const Value& value) const;
 
+    // Record a change of a property of the object and notify its observers
+    void notifyChanged(const Property& property) const;
+
     UserObject(const Class* cls, std::shared_ptr<detail::AbstractObjectHolder> h) noexcept
         :   m_class(cls)
         ,   m_holder(std::move(h))
@@ -0,0 +1,311 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_ARCHIVE_ASYNCSINK_HPP
+#define PONDER_ARCHIVE_ASYNCSINK_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
+
+namespace ponder {
+namespace archive {
+
+/**
+ * \brief Output which writes to a file on a background thread
+ *
+ * The data is copied into one of a fixed number of buffers. When the buffer is full, or
+ * on flush(), it is handed to a thread which writes it to the file while the next buffer
+ * is filled. With the default two buffers, this is double buffering: writing an archive
+ * only waits for the file when both buffers are full, and the memory used is bounded by
+ * the size of the buffers, allocated once.
+ *
+ * Waiting for a free buffer is backpressure: the file can't keep up with the writer.
+ * backpressured() tells whether handing over a buffer would wait, so that a periodic
+ * snapshot can be skipped or delayed, and stats() counts the waits and their duration.
+ *
+ * RapidJsonStreamWriter writes its output to a sink as it goes. BinaryArchiveWriter
+ * writes to a string, which is handed to the sink once finished:
+ *
+ * \code
+ * ponder::archive::AsyncSink sink(std::fopen("snapshots.json", "wb"));
+ * while (running)
+ * {
+ *     update();
+ *     if (snapshotDue && !sink.backpressured())
+ *     {
+ *         ponder::archive::RapidJsonStreamWriter archive(sink);
+ *         ponder::archive::ArchiveWriter(archive).write(archive.root(), state);
+ *         archive.finish(); // hands the last buffer over, without waiting
+ *     }
+ * }
+ * sink.sync();
+ * \endcode
+ *
+ * The sink must be used by one thread at a time. The file is not closed.
+ */
+class AsyncSink
+{
+public:
+
+    //! Counters of the sink, since it was created
+    struct Stats
+    {
+        std::uint64_t bytes = 0;        //!< Bytes written to the file
+        std::uint64_t buffers = 0;      //!< Buffers handed to the writing thread
+        std::uint64_t stalls = 0;       //!< Number of waits for a free buffer
+        std::chrono::nanoseconds stallTime{0}; //!< Total time spent waiting for a free buffer
+    };
+
+    //! Write to a stdio file, which is not closed
+    AsyncSink(FILE* file, size_t bufferSize = c_defaultBufferSize, size_t bufferCount = 2)
+    :   m_file(file)
+    {
+        start(bufferSize, bufferCount);
+    }
+
+    //! Write to a file descriptor, which is not closed
+    AsyncSink(int fd, size_t bufferSize = c_defaultBufferSize, size_t bufferCount = 2)
+    :   m_fd(fd)
+    {
+        start(bufferSize, bufferCount);
+    }
+
+    //! Write what is left and stop the thread
+    ~AsyncSink()
+    {
+        sync();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_changed.notify_all();
+        m_thread.join();
+    }
+
+    AsyncSink(const AsyncSink&) = delete;
+    AsyncSink& operator=(const AsyncSink&) = delete;
+
+    /**
+     * \brief Copy data to the sink
+     *
+     * Full buffers are handed to the writing thread. This waits if there is no free buffer
+     * to copy the rest of the data into.
+     *
+     * \return False if writing to the file has failed
+     */
+    bool write(const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            if (!m_current)
+                acquire();
+
+            const size_t chunk = std::min(size, m_bufferSize - m_current->size);
+            std::memcpy(m_current->data.get() + m_current->size, data, chunk);
+            m_current->size += chunk;
+            data += chunk;
+            size -= chunk;
+
+            if (m_current->size == m_bufferSize)
+                flush();
+        }
+        return !failed();
+    }
+
+    bool write(const std::string& data) { return write(data.data(), data.size()); }
+
+    //! Hand the buffer being filled to the writing thread, without waiting
+    void flush()
+    {
+        if (!m_current || m_current->size == 0)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_submitted;
+            ++m_stats.buffers;
+        }
+        m_current = nullptr;
+        m_changed.notify_all();
+    }
+
+    /**
+     * \brief Flush and wait until all the data has been written to the file
+     *
+     * \return False if writing to the file has failed
+     */
+    bool sync()
+    {
+        flush();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this] { return m_written == m_submitted; });
+        return !m_failed;
+    }
+
+    //! Check if handing over the buffer being filled would wait for the file
+    [[nodiscard]] bool backpressured() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_submitted - m_written + 1 >= m_buffers.size();
+    }
+
+    //! Check if writing to the file has failed. The data written after is dropped.
+    [[nodiscard]] bool failed() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_failed;
+    }
+
+    [[nodiscard]] Stats stats() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    //! Size of each buffer; the sink uses the size times the number of buffers
+    [[nodiscard]] size_t bufferSize() const { return m_bufferSize; }
+
+private:
+
+    static constexpr size_t c_defaultBufferSize = 1024 * 1024;
+
+    struct Buffer
+    {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    void start(size_t bufferSize, size_t bufferCount)
+    {
+        m_bufferSize = std::max<size_t>(bufferSize, 1);
+        m_buffers.resize(std::max<size_t>(bufferCount, 2));
+        for (auto&& buffer : m_buffers)
+            buffer.data = std::make_unique<char[]>(m_bufferSize);
+        m_thread = std::thread([this] { run(); });
+    }
+
+    // Take the next buffer in turn, waiting for the thread to have written it
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const auto isFree = [this] { return m_submitted - m_written < m_buffers.size(); };
+        if (!isFree())
+        {
+            const auto start = std::chrono::steady_clock::now();
+            m_changed.wait(lock, isFree);
+            ++m_stats.stalls;
+            m_stats.stallTime += std::chrono::steady_clock::now() - start;
+        }
+        m_current = &m_buffers[m_submitted % m_buffers.size()];
+        m_current->size = 0;
+    }
+
+    // Write the buffers handed over, in order
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;)
+        {
+            m_changed.wait(lock, [this] { return m_stop || m_written < m_submitted; });
+            if (m_written == m_submitted)
+                return;
+
+            const Buffer& buffer = m_buffers[m_written % m_buffers.size()];
+            const bool failed = m_failed;
+            const bool last = m_written + 1 == m_submitted;
+            lock.unlock();
+            const bool ok = failed || output(buffer.data.get(), buffer.size, last);
+            lock.lock();
+
+            if (!ok)
+                m_failed = true;
+            else if (!failed)
+                m_stats.bytes += buffer.size;
+            ++m_written;
+            m_changed.notify_all();
+        }
+    }
+
+    bool output(const char* data, size_t size, bool last)
+    {
+        if (m_file)
+        {
+            // Flush the stdio buffer once idle, so that the data reaches the file
+            return std::fwrite(data, 1, size, m_file) == size && (!last || std::fflush(m_file) == 0);
+        }
+        for (size_t written = 0; written < size;)
+        {
+#ifdef _WIN32
+            const auto n = ::_write(m_fd, data + written, static_cast<unsigned>(size - written));
+#else
+            const auto n = ::write(m_fd, data + written, size - written);
+#endif
+            if (n <= 0)
+                return false;
+            written += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    FILE* m_file = nullptr;
+    int m_fd = -1;
+    size_t m_bufferSize = 0;
+    std::vector<Buffer> m_buffers;
+    Buffer* m_current = nullptr;    // Buffer being filled, owned by the user thread
+
+    mutable std::mutex m_mutex;     // Guards the members below
+    std::condition_variable m_changed;
+    size_t m_submitted = 0;         // Buffers handed over, the next one being m_submitted % count
+    size_t m_written = 0;           // Buffers written by the thread, in the same order
+    bool m_failed = false;
+    bool m_stop = false;
+    Stats m_stats;
+
+    std::thread m_thread;
+};
+
+} // namespace archive
+} // namespace ponder
+
+#endif // PONDER_ARCHIVE_ASYNCSINK_HPP
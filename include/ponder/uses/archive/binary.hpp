@@ -0,0 +1,769 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_ARCHIVE_BINARY_HPP
+#define PONDER_ARCHIVE_BINARY_HPP
+
+#include <ponder/class.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ponder {
+namespace archive {
+
+/**
+ * \brief Layout of the compact binary archive format
+ *
+ * An archive starts with a header: the magic "PNDB", a version byte and the offset of
+ * the name table as a 32 bit integer. It is followed by the root object and the name
+ * table. Values start with a tag byte:
+ * - Null, False and True have no payload,
+ * - Int is followed by a zigzag encoded varint,
+ * - Double by the 8 bytes of the IEEE 754 value,
+ * - String by the varint byte length and the bytes of the string,
+ * - Object by its 32 bit byte length and its members: the varint id of a name followed
+ *   by a value,
+ * - Array by its 32 bit byte length, its 32 bit item count and the items,
+ * - Numbers, an array of numbers of the same type, by its 32 bit byte length, the
+ *   NumberType byte, the 32 bit count of numbers and the numbers.
+ *
+ * The name table lists the names used as member ids, in order: a varint count, then
+ * each name as a varint length and its bytes. All integers are little endian.
+ *
+ * Version 2 added Numbers, archives of version 1 can still be read.
+ */
+namespace binary {
+
+enum class Tag : std::uint8_t
+{
+    Null,
+    False,
+    True,
+    Int,
+    Double,
+    String,
+    Object,
+    Array,
+    Numbers,
+};
+
+//! Type of the elements of Numbers
+enum class NumberType : std::uint8_t
+{
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Float,
+    Double,
+};
+
+template <typename T>
+constexpr NumberType numberType()
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+                  && sizeof(T) <= 8, "not a number type");
+
+    if constexpr (std::is_floating_point_v<T>)
+        return sizeof(T) == 4 ? NumberType::Float : NumberType::Double;
+    else
+    {
+        const int type = sizeof(T) == 1 ? 0 : sizeof(T) == 2 ? 2 : sizeof(T) == 4 ? 4 : 6;
+        return static_cast<NumberType>(std::is_signed_v<T> ? type : type + 1);
+    }
+}
+
+// Size of the numbers of a type, 0 if the type is unknown
+constexpr size_t numberSize(NumberType type)
+{
+    constexpr size_t c_sizes[] = {1, 1, 2, 2, 4, 4, 8, 8, 4, 8};
+    const auto index = static_cast<size_t>(type);
+    return index < std::size(c_sizes) ? c_sizes[index] : 0;
+}
+
+// Can numbers be copied as they are to and from the archive?
+inline bool isLittleEndian()
+{
+    const std::uint16_t one = 1;
+    char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+// Unsigned integer with the bits of T
+template <typename T>
+using NumberBits = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                   std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                   std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+
+constexpr char c_magic[4] = {'P', 'N', 'D', 'B'};
+constexpr std::uint8_t c_version = 2;
+constexpr size_t c_headerSize = sizeof(c_magic) + 1 + 4;
+
+} // namespace binary
+
+/**
+ * \brief Write to an archive that uses a compact binary format as storage.
+ *
+ * Numbers are written as tagged varints and raw doubles, and property names are
+ * written once in a name table and referred to by id. The archive is written into a
+ * string buffer, which is complete once finish() has been called. To write it to a file
+ * without waiting, hand the buffer to an AsyncSink.
+ *
+ * \code
+ * std::string buffer;
+ * ponder::archive::BinaryArchiveWriter archive(buffer);
+ * ponder::archive::ArchiveWriter writer(archive);
+ * writer.write(archive.root(), object);
+ * archive.finish();
+ * sink.write(buffer);
+ * sink.flush();
+ * \endcode
+ *
+ * \sa binary, BinaryArchiveReader
+ */
+class BinaryArchiveWriter
+{
+public:
+
+    //! An open object or array of the archive.
+    struct Node
+    {
+        size_t m_offset = 0;    // Offset of the length of the container
+        bool m_array = false;   // Items of arrays have no name
+    };
+
+    /**
+     * \brief Items of an array written apart from the archive
+     *
+     * A fragment is written by another thread while the archive waits, then its items are
+     * appended to an array of the archive with appendFragment(). It uses the name table
+     * of the archive, which is shared between the fragments.
+     */
+    class Fragment;
+
+    BinaryArchiveWriter(std::string& buffer) : m_buffer(buffer)
+    {
+        m_buffer.append(binary::c_magic, sizeof(binary::c_magic));
+        m_buffer.push_back(static_cast<char>(binary::c_version));
+        writeFixed(0); // name table offset, patched by finish()
+        m_root = beginContainer(binary::Tag::Object, false);
+    }
+
+    //! Node of the root object, to pass to ArchiveWriter::write().
+    [[nodiscard]] Node root() const { return m_root; }
+
+    //! Append the items of a fragment to the array being written
+    void appendFragment(Node arrayNode, const Fragment& fragment);
+
+    Node beginChild(Node parent, const std::string& name)
+    {
+        writeKey(parent, name);
+        return beginContainer(binary::Tag::Object, false);
+    }
+
+    void endChild(Node, Node child)
+    {
+        endContainer(child);
+    }
+
+    Node beginArray(Node parent, const std::string& name)
+    {
+        writeKey(parent, name);
+        Node node = beginContainer(binary::Tag::Array, true);
+        writeFixed(0); // item count, patched by endArray()
+        return node;
+    }
+
+    void endArray(Node, Node arrayNode)
+    {
+        patchFixed(arrayNode.m_offset + 4, m_counts.back());
+        endContainer(arrayNode);
+    }
+
+    void setProperty(Node node, const std::string& name, const Value& value)
+    {
+        writeKey(node, name);
+        switch (value.kind())
+        {
+            case ValueKind::Boolean:
+                writeTag(value.to<bool>() ? binary::Tag::True : binary::Tag::False);
+                break;
+            case ValueKind::Integer:
+            case ValueKind::LongInteger:
+            {
+                const auto i = value.to<long long>();
+                writeTag(binary::Tag::Int);
+                writeVarint((static_cast<std::uint64_t>(i) << 1) ^ static_cast<std::uint64_t>(i >> 63));
+                break;
+            }
+            case ValueKind::Real:
+            {
+                const double d = value.to<double>();
+                std::uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                writeTag(binary::Tag::Double);
+                for (int i = 0; i < 8; ++i)
+                    m_buffer.push_back(static_cast<char>(bits >> (i * 8)));
+                break;
+            }
+            case ValueKind::String:
+            case ValueKind::Enum:
+            case ValueKind::Reference:
+            {
+                const std::string str = value.to<std::string>();
+                writeTag(binary::Tag::String);
+                writeVarint(str.size());
+                m_buffer.append(str);
+                break;
+            }
+            default:
+                writeTag(binary::Tag::Null);
+                break;
+        }
+    }
+
+    template <typename T>
+    void writeArray(Node parent, const std::string& name, const T* values, size_t count)
+    {
+        writeKey(parent, name);
+        writeTag(binary::Tag::Numbers);
+        writeFixed(static_cast<std::uint32_t>(5 + count * sizeof(T))); // byte length
+        m_buffer.push_back(static_cast<char>(binary::numberType<T>()));
+        writeFixed(static_cast<std::uint32_t>(count));
+
+        const size_t offset = m_buffer.size();
+        m_buffer.resize(offset + count * sizeof(T));
+        char* out = &m_buffer[offset];
+        if (binary::isLittleEndian())
+        {
+            std::memcpy(out, values, count * sizeof(T));
+            return;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            binary::NumberBits<T> bits;
+            std::memcpy(&bits, &values[i], sizeof(T));
+            for (size_t b = 0; b < sizeof(T); ++b)
+                *out++ = static_cast<char>(bits >> (b * 8));
+        }
+    }
+
+    /**
+     * \brief Complete the archive
+     *
+     * Closes the root object and appends the name table. Nothing can be written after.
+     */
+    void finish()
+    {
+        endContainer(m_root);
+        patchFixed(sizeof(binary::c_magic) + 1, static_cast<std::uint32_t>(m_buffer.size()));
+        writeVarint(m_nameList.size());
+        for (auto&& name : m_nameList)
+        {
+            writeVarint(name->size());
+            m_buffer.append(*name);
+        }
+    }
+
+private:
+
+    // Fragment writing array items into buffer: there is no header, and the root is an array
+    BinaryArchiveWriter(std::string& buffer, BinaryArchiveWriter& parent)
+        : m_buffer(buffer)
+        , m_root{0, true}
+        , m_parent(&parent)
+    {
+        m_counts.push_back(0);
+    }
+
+    void writeTag(binary::Tag tag)
+    {
+        m_buffer.push_back(static_cast<char>(tag));
+    }
+
+    void writeVarint(std::uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            m_buffer.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        m_buffer.push_back(static_cast<char>(value));
+    }
+
+    void writeFixed(std::uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_buffer.push_back(static_cast<char>(value >> (i * 8)));
+    }
+
+    void patchFixed(size_t offset, std::uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_buffer[offset + i] = static_cast<char>(value >> (i * 8));
+    }
+
+    // Write the name id of a member, or count the item of an array
+    void writeKey(Node parent, const std::string& name)
+    {
+        if (parent.m_array)
+        {
+            ++m_counts.back();
+            return;
+        }
+
+        auto it = m_names.find(name);
+        if (it == m_names.end())
+        {
+            // Fragments keep the ids of the archive they are appended to
+            const std::uint32_t id = m_parent ? m_parent->sharedId(name)
+                                              : static_cast<std::uint32_t>(m_nameList.size());
+            it = m_names.emplace(name, id).first;
+            if (!m_parent)
+                m_nameList.push_back(&it->first);
+        }
+        writeVarint(it->second);
+    }
+
+    // Id of a name used by a fragment, which may be written by another thread
+    std::uint32_t sharedId(const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(m_namesMutex);
+        auto it = m_names.find(name);
+        if (it == m_names.end())
+        {
+            it = m_names.emplace(name, static_cast<std::uint32_t>(m_nameList.size())).first;
+            m_nameList.push_back(&it->first);
+        }
+        return it->second;
+    }
+
+    Node beginContainer(binary::Tag tag, bool array)
+    {
+        writeTag(tag);
+        const Node node{m_buffer.size(), array};
+        writeFixed(0); // byte length, patched by endContainer()
+        m_counts.push_back(0);
+        return node;
+    }
+
+    void endContainer(Node node)
+    {
+        patchFixed(node.m_offset, static_cast<std::uint32_t>(m_buffer.size() - node.m_offset - 4));
+        m_counts.pop_back();
+    }
+
+    std::string& m_buffer;
+    Node m_root;
+    std::vector<std::uint32_t> m_counts; // Item counts of the open containers
+    std::unordered_map<std::string, std::uint32_t> m_names;
+    std::vector<const std::string*> m_nameList; // Names, in order of id
+    BinaryArchiveWriter* m_parent = nullptr; // Archive of a fragment
+    std::mutex m_namesMutex; // Guards the names used by the fragments
+};
+
+namespace detail {
+
+// Buffer of a fragment, constructed before the writer using it
+struct BinaryFragmentBuffer
+{
+    std::string m_data;
+};
+
+} // namespace detail
+
+class BinaryArchiveWriter::Fragment : private detail::BinaryFragmentBuffer, public BinaryArchiveWriter
+{
+public:
+
+    //! Start a fragment of archive, root() is the node of the array to write items into
+    explicit Fragment(BinaryArchiveWriter& archive) : BinaryArchiveWriter(m_data, archive) {}
+
+private:
+
+    friend class BinaryArchiveWriter;
+};
+
+inline void BinaryArchiveWriter::appendFragment(Node, const Fragment& fragment)
+{
+    m_buffer.append(fragment.m_data);
+    m_counts.back() += static_cast<const BinaryArchiveWriter&>(fragment).m_counts.front();
+}
+
+/**
+ * \brief Read from an archive that uses a compact binary format as storage.
+ *
+ * The archive is read in place: the buffer must outlive the reader. A buffer which is
+ * not a complete binary archive has an invalid root().
+ *
+ * \code
+ * ponder::archive::BinaryArchiveReader archive(buffer.data(), buffer.size());
+ * ponder::archive::ArchiveReader reader(archive);
+ * reader.read(archive.root(), object);
+ * \endcode
+ *
+ * \sa binary, BinaryArchiveWriter
+ */
+class BinaryArchiveReader
+{
+public:
+
+    //! A value within the binary archive, null if invalid.
+    struct Node
+    {
+        const char* m_data = nullptr; // Tag of the value
+    };
+
+    //! Facilitate iteration over binary arrays.
+    struct ArrayIterator
+    {
+        const BinaryArchiveReader* m_reader;
+        const char* m_item;
+        const char* m_end;
+        size_t m_size;
+
+        [[nodiscard]] bool isEnd() const { return m_item == nullptr || m_item >= m_end; }
+        void next() { m_item = m_reader->skip(m_item); }
+        [[nodiscard]] Node getItem() const { return Node{m_item}; }
+        [[nodiscard]] size_t size() const { return m_size; }
+    };
+
+    //! Facilitate iteration over the members of binary objects.
+    struct MemberIterator
+    {
+        const BinaryArchiveReader* m_reader;
+        const char* m_value;    // Value of the current member, after its name id
+        const char* m_end;
+        std::uint64_t m_id;
+
+        [[nodiscard]] bool isEnd() const { return m_value == nullptr; }
+        void next() { *this = m_reader->member(m_reader->skip(m_value), m_end); }
+        [[nodiscard]] string_view name() const
+        {
+            return m_id < m_reader->m_names.size() ? m_reader->m_names[m_id] : string_view();
+        }
+        [[nodiscard]] Node getItem() const { return Node{m_value}; }
+    };
+
+    BinaryArchiveReader(const char* data, size_t size)
+        : m_end(data + size)
+    {
+        if (size < binary::c_headerSize + 5 || std::memcmp(data, binary::c_magic, 4) != 0
+            || static_cast<std::uint8_t>(data[4]) < 1
+            || static_cast<std::uint8_t>(data[4]) > binary::c_version)
+            return;
+
+        const std::uint32_t namesOffset = readFixed(data + 5);
+        if (namesOffset < binary::c_headerSize || namesOffset > size)
+            return;
+
+        const char* p = data + namesOffset;
+        std::uint64_t count = 0;
+        p = readVarint(p, count);
+        for (std::uint64_t id = 0; p && id < count; ++id)
+        {
+            std::uint64_t length = 0;
+            p = readVarint(p, length);
+            if (!p || length > static_cast<size_t>(m_end - p))
+                return;
+            m_ids.emplace(std::string_view(p, length), static_cast<std::uint64_t>(id));
+            m_names.emplace_back(p, length);
+            p += length;
+        }
+        if (p)
+            m_root = Node{data + binary::c_headerSize};
+    }
+
+    //! Node of the root object, to pass to ArchiveReader::read().
+    [[nodiscard]] Node root() const { return m_root; }
+
+    Node findProperty(Node node, const std::string& name)
+    {
+        if (!isContainer(node, binary::Tag::Object))
+            return {};
+        const auto id = m_ids.find(name);
+        if (id == m_ids.end())
+            return {};
+
+        const char* end = nullptr;
+        for (const char* p = children(node, end); p && p < end; p = skip(p))
+        {
+            std::uint64_t key = 0;
+            p = readVarint(p, key);
+            if (p && key == id->second)
+                return Node{p};
+        }
+        return {};
+    }
+
+    ArrayIterator createArrayIterator(Node node, const std::string&)
+    {
+        if (!isContainer(node, binary::Tag::Array))
+            return ArrayIterator{this, nullptr, nullptr, 0};
+        const char* end = nullptr;
+        const char* items = children(node, end);
+        if (end - items < 4)
+            return ArrayIterator{this, nullptr, nullptr, 0};
+
+        // Each item takes a byte at least, so a corrupt count can't reserve more than that
+        const size_t count = std::min<size_t>(readFixed(items), static_cast<size_t>(end - items - 4));
+        return ArrayIterator{this, items + 4, end, count};
+    }
+
+    MemberIterator createMemberIterator(Node node)
+    {
+        if (!isContainer(node, binary::Tag::Object))
+            return MemberIterator{this, nullptr, nullptr, 0};
+        const char* end = nullptr;
+        const char* members = children(node, end);
+        return member(members, end);
+    }
+
+    Value getValue(Node node)
+    {
+        if (!isValid(node))
+            return {};
+
+        switch (static_cast<binary::Tag>(*node.m_data))
+        {
+            case binary::Tag::False:
+                return false;
+            case binary::Tag::True:
+                return true;
+            case binary::Tag::Int:
+            {
+                std::uint64_t zigzag = 0;
+                if (!readVarint(node.m_data + 1, zigzag))
+                    break;
+                const auto i = static_cast<long long>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+                if (i >= std::numeric_limits<long>::min() && i <= std::numeric_limits<long>::max())
+                    return static_cast<long>(i);
+                return i;
+            }
+            case binary::Tag::Double:
+            {
+                if (m_end - node.m_data < 9)
+                    break;
+                std::uint64_t bits = 0;
+                for (int i = 0; i < 8; ++i)
+                    bits |= static_cast<std::uint64_t>(static_cast<std::uint8_t>(node.m_data[1 + i])) << (i * 8);
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                return d;
+            }
+            case binary::Tag::String:
+            {
+                std::uint64_t length = 0;
+                const char* p = readVarint(node.m_data + 1, length);
+                if (!p || length > static_cast<size_t>(m_end - p))
+                    break;
+                return std::string_view(p, length);
+            }
+            default:
+                break;
+        }
+        return {};
+    }
+
+    template <typename T>
+    bool readArray(Node node, std::vector<T>& values)
+    {
+        if (!isContainer(node, binary::Tag::Numbers))
+            return false;
+
+        const char* end = nullptr;
+        const char* p = children(node, end);
+        if (end - p < 5)
+            return false;
+        const auto type = static_cast<binary::NumberType>(*p);
+        const std::uint32_t count = readFixed(p + 1);
+        const size_t size = binary::numberSize(type);
+        p += 5;
+        if (size == 0 || count > static_cast<size_t>(end - p) / size)
+            return false;
+
+        values.resize(count);
+        if (type == binary::numberType<T>() && binary::isLittleEndian())
+        {
+            std::memcpy(values.data(), p, count * sizeof(T));
+            return true;
+        }
+        for (size_t i = 0; i < count; ++i, p += size)
+            values[i] = readNumber<T>(type, p);
+        return true;
+    }
+
+    bool isValid(Node node)
+    {
+        return node.m_data != nullptr && node.m_data < m_end
+            && static_cast<binary::Tag>(*node.m_data) != binary::Tag::Null;
+    }
+
+private:
+
+    // Read a number stored as U
+    template <typename U>
+    static U readNumber(const char* p)
+    {
+        binary::NumberBits<U> bits = 0;
+        for (size_t b = 0; b < sizeof(U); ++b)
+            bits |= static_cast<binary::NumberBits<U>>(static_cast<std::uint8_t>(p[b])) << (b * 8);
+        U value;
+        std::memcpy(&value, &bits, sizeof(U));
+        return value;
+    }
+
+    // Read a number stored with another type than T
+    template <typename T>
+    static T readNumber(binary::NumberType type, const char* p)
+    {
+        switch (type)
+        {
+            case binary::NumberType::Int8: return static_cast<T>(readNumber<std::int8_t>(p));
+            case binary::NumberType::UInt8: return static_cast<T>(readNumber<std::uint8_t>(p));
+            case binary::NumberType::Int16: return static_cast<T>(readNumber<std::int16_t>(p));
+            case binary::NumberType::UInt16: return static_cast<T>(readNumber<std::uint16_t>(p));
+            case binary::NumberType::Int32: return static_cast<T>(readNumber<std::int32_t>(p));
+            case binary::NumberType::UInt32: return static_cast<T>(readNumber<std::uint32_t>(p));
+            case binary::NumberType::Int64: return static_cast<T>(readNumber<std::int64_t>(p));
+            case binary::NumberType::UInt64: return static_cast<T>(readNumber<std::uint64_t>(p));
+            case binary::NumberType::Float: return static_cast<T>(readNumber<float>(p));
+            case binary::NumberType::Double: return static_cast<T>(readNumber<double>(p));
+        }
+        return T();
+    }
+
+    static std::uint32_t readFixed(const char* p)
+    {
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+            value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(p[i])) << (i * 8);
+        return value;
+    }
+
+    // Read a varint, return the following byte or null if the archive is truncated
+    const char* readVarint(const char* p, std::uint64_t& value) const
+    {
+        value = 0;
+        for (int shift = 0; p < m_end && shift < 64; shift += 7)
+        {
+            const auto byte = static_cast<std::uint8_t>(*p++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return p;
+        }
+        return nullptr;
+    }
+
+    bool isContainer(Node node, binary::Tag tag) const
+    {
+        return node.m_data != nullptr && m_end - node.m_data >= 5
+            && static_cast<binary::Tag>(*node.m_data) == tag;
+    }
+
+    // Get the children of a container, and the end of the container
+    const char* children(Node node, const char*& end) const
+    {
+        const char* p = node.m_data + 5;
+        end = p + std::min<size_t>(readFixed(node.m_data + 1), static_cast<size_t>(m_end - p));
+        return p;
+    }
+
+    // Decode the member starting at p, or the end of the object
+    MemberIterator member(const char* p, const char* end) const
+    {
+        std::uint64_t id = 0;
+        if (p && p < end)
+            p = readVarint(p, id);
+        if (!p || p >= end)
+            return MemberIterator{this, nullptr, end, 0};
+        return MemberIterator{this, p, end, id};
+    }
+
+    // Skip a value, return the following byte or null if the archive is truncated
+    const char* skip(const char* p) const
+    {
+        if (p == nullptr || p >= m_end)
+            return nullptr;
+
+        std::uint64_t length = 0;
+        switch (static_cast<binary::Tag>(*p))
+        {
+            case binary::Tag::Null:
+            case binary::Tag::False:
+            case binary::Tag::True:
+                return p + 1;
+            case binary::Tag::Int:
+                return readVarint(p + 1, length);
+            case binary::Tag::Double:
+                length = 8;
+                ++p;
+                break;
+            case binary::Tag::String:
+                p = readVarint(p + 1, length);
+                break;
+            case binary::Tag::Object:
+            case binary::Tag::Array:
+            case binary::Tag::Numbers:
+                if (m_end - p < 5)
+                    return nullptr;
+                length = readFixed(p + 1);
+                p += 5;
+                break;
+            default:
+                return nullptr;
+        }
+        return p && length <= static_cast<size_t>(m_end - p) ? p + length : nullptr;
+    }
+
+    const char* m_end;
+    Node m_root;
+    std::unordered_map<std::string_view, std::uint64_t> m_ids; // Name table
+    std::vector<std::string_view> m_names; // Names by id
+};
+
+} // namespace archive
+} // namespace ponder
+
+#endif // PONDER_ARCHIVE_BINARY_HPP
@@ -0,0 +1,790 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_ARCHIVE_MAPPED_HPP
+#define PONDER_ARCHIVE_MAPPED_HPP
+
+#include <ponder/class.hpp>
+#include <ponder/userproperty.hpp>
+#include <ponder/uses/serialise.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#   define PONDER_ARCHIVE_MAPPED_FILE
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace ponder {
+namespace archive {
+
+/**
+ * \brief Layout of the memory-mapped archive format
+ *
+ * The format is designed to be read in place, e.g. from a memory-mapped file, reading
+ * only the values accessed. An archive starts with a header: the magic "PNDM", a version
+ * byte and the offset of the name table as a 32 bit integer. It is followed by the root
+ * object and the name table. Values start with a tag byte:
+ * - Null, False and True have no payload,
+ * - Int is followed by the 8 bytes of a signed integer,
+ * - Double by the 8 bytes of the IEEE 754 value,
+ * - String by its 32 bit byte length and the bytes of the string,
+ * - Object by its 32 bit byte length, the values of its members, its offset table and
+ *   its 32 bit member count. The offset table has an entry per member, sorted by name
+ *   id: the 32 bit name id and the 32 bit offset of the value from the object tag.
+ * - Array by its 32 bit byte length, its items, the 32 bit offsets of the items from the
+ *   array tag and its 32 bit item count.
+ *
+ * The name table lists the names used as member ids, in order: a 32 bit count, then each
+ * name as a 32 bit length and its bytes. All integers are little endian and unaligned.
+ */
+namespace mapped {
+
+enum class Tag : std::uint8_t
+{
+    Null,
+    False,
+    True,
+    Int,
+    Double,
+    String,
+    Object,
+    Array,
+};
+
+constexpr char c_magic[4] = {'P', 'N', 'D', 'M'};
+constexpr std::uint8_t c_version = 1;
+constexpr size_t c_headerSize = sizeof(c_magic) + 1 + 4;
+
+} // namespace mapped
+
+/**
+ * \brief Write to an archive in the memory-mapped format.
+ *
+ * The archive is written into a string buffer, which is complete once finish() has been
+ * called. It can then be saved to a file and read with MappedArchiveReader.
+ *
+ * \code
+ * std::string buffer;
+ * ponder::archive::MappedArchiveWriter archive(buffer);
+ * ponder::archive::ArchiveWriter writer(archive);
+ * writer.write(archive.root(), object);
+ * archive.finish();
+ * \endcode
+ *
+ * \sa mapped, MappedArchiveReader
+ */
+class MappedArchiveWriter
+{
+public:
+
+    //! An open object or array of the archive.
+    struct Node
+    {
+        size_t m_level = 0; // Depth of the container
+    };
+
+    MappedArchiveWriter(std::string& buffer) : m_buffer(buffer)
+    {
+        m_buffer.append(mapped::c_magic, sizeof(mapped::c_magic));
+        m_buffer.push_back(static_cast<char>(mapped::c_version));
+        writeFixed(0); // name table offset, patched by finish()
+        m_root = beginContainer(mapped::Tag::Object);
+    }
+
+    //! Node of the root object, to pass to ArchiveWriter::write().
+    [[nodiscard]] Node root() const { return m_root; }
+
+    Node beginChild(Node parent, const std::string& name)
+    {
+        addMember(parent, name);
+        return beginContainer(mapped::Tag::Object);
+    }
+
+    void endChild(Node, Node child)
+    {
+        endContainer(child);
+    }
+
+    Node beginArray(Node parent, const std::string& name)
+    {
+        addMember(parent, name);
+        return beginContainer(mapped::Tag::Array);
+    }
+
+    void endArray(Node, Node arrayNode)
+    {
+        endContainer(arrayNode);
+    }
+
+    void setProperty(Node node, const std::string& name, const Value& value)
+    {
+        addMember(node, name);
+        switch (value.kind())
+        {
+            case ValueKind::Boolean:
+                writeTag(value.to<bool>() ? mapped::Tag::True : mapped::Tag::False);
+                break;
+            case ValueKind::Integer:
+            case ValueKind::LongInteger:
+            {
+                writeTag(mapped::Tag::Int);
+                writeFixed64(static_cast<std::uint64_t>(value.to<long long>()));
+                break;
+            }
+            case ValueKind::Real:
+            {
+                const double d = value.to<double>();
+                std::uint64_t bits;
+                std::memcpy(&bits, &d, sizeof(bits));
+                writeTag(mapped::Tag::Double);
+                writeFixed64(bits);
+                break;
+            }
+            case ValueKind::String:
+            case ValueKind::Enum:
+            case ValueKind::Reference:
+            {
+                const std::string str = value.to<std::string>();
+                writeTag(mapped::Tag::String);
+                writeFixed(static_cast<std::uint32_t>(str.size()));
+                m_buffer.append(str);
+                break;
+            }
+            default:
+                writeTag(mapped::Tag::Null);
+                break;
+        }
+    }
+
+    /**
+     * \brief Complete the archive
+     *
+     * Closes the root object and appends the name table. Nothing can be written after.
+     */
+    void finish()
+    {
+        endContainer(m_root);
+        patchFixed(sizeof(mapped::c_magic) + 1, static_cast<std::uint32_t>(m_buffer.size()));
+        writeFixed(static_cast<std::uint32_t>(m_nameList.size()));
+        for (auto&& name : m_nameList)
+        {
+            writeFixed(static_cast<std::uint32_t>(name->size()));
+            m_buffer.append(*name);
+        }
+    }
+
+private:
+
+    // An open container: where it starts and where its members are
+    struct Container
+    {
+        size_t m_offset = 0;    // Offset of the tag
+        bool m_array = false;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> m_entries; // id (objects), offset
+    };
+
+    void writeTag(mapped::Tag tag)
+    {
+        m_buffer.push_back(static_cast<char>(tag));
+    }
+
+    void writeFixed(std::uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_buffer.push_back(static_cast<char>(value >> (i * 8)));
+    }
+
+    void writeFixed64(std::uint64_t value)
+    {
+        for (int i = 0; i < 8; ++i)
+            m_buffer.push_back(static_cast<char>(value >> (i * 8)));
+    }
+
+    void patchFixed(size_t offset, std::uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            m_buffer[offset + i] = static_cast<char>(value >> (i * 8));
+    }
+
+    // Record the value about to be written in the offset table of its container
+    void addMember(Node parent, const std::string& name)
+    {
+        Container& container = m_containers[parent.m_level];
+        const auto offset = static_cast<std::uint32_t>(m_buffer.size() - container.m_offset);
+        if (container.m_array)
+        {
+            container.m_entries.emplace_back(0, offset);
+            return;
+        }
+
+        auto it = m_names.find(name);
+        if (it == m_names.end())
+        {
+            it = m_names.emplace(name, static_cast<std::uint32_t>(m_nameList.size())).first;
+            m_nameList.push_back(&it->first);
+        }
+        container.m_entries.emplace_back(it->second, offset);
+    }
+
+    Node beginContainer(mapped::Tag tag)
+    {
+        // Containers are reused, to keep the capacity of their tables
+        const Node node{m_level++};
+        if (m_containers.size() < m_level)
+            m_containers.resize(m_level);
+        Container& container = m_containers[node.m_level];
+        container.m_offset = m_buffer.size();
+        container.m_array = tag == mapped::Tag::Array;
+        container.m_entries.clear();
+
+        writeTag(tag);
+        writeFixed(0); // byte length, patched by endContainer()
+        return node;
+    }
+
+    void endContainer(Node node)
+    {
+        Container& container = m_containers[node.m_level];
+        if (container.m_array)
+        {
+            for (auto&& entry : container.m_entries)
+                writeFixed(entry.second);
+        }
+        else
+        {
+            std::sort(container.m_entries.begin(), container.m_entries.end());
+            for (auto&& entry : container.m_entries)
+            {
+                writeFixed(entry.first);
+                writeFixed(entry.second);
+            }
+        }
+        writeFixed(static_cast<std::uint32_t>(container.m_entries.size()));
+        patchFixed(container.m_offset + 1,
+                   static_cast<std::uint32_t>(m_buffer.size() - container.m_offset - 5));
+        --m_level;
+    }
+
+    std::string& m_buffer;
+    Node m_root;
+    std::vector<Container> m_containers; // Open containers, by depth
+    size_t m_level = 0;
+    std::unordered_map<std::string, std::uint32_t> m_names;
+    std::vector<const std::string*> m_nameList; // Names, in order of id
+};
+
+class MappedObject;
+
+/**
+ * \brief Read from an archive in the memory-mapped format, in place.
+ *
+ * Opening an archive only reads its header and name table: values are decoded when they
+ * are accessed, so the cost of reading depends on what is accessed, not on the size of
+ * the archive. Members are found by a binary search of the offset table of their object,
+ * and array items are accessed by index.
+ *
+ * The reader can be used with ArchiveReader to deserialise whole objects, or through
+ * MappedObject views to read properties without deserialising. The buffer must outlive
+ * the reader. A buffer which is not a mapped archive has an invalid root().
+ *
+ * \code
+ * ponder::archive::MappedFile file("assets.pndm");
+ * ponder::archive::MappedArchiveReader archive(file.data(), file.size());
+ * ponder::archive::MappedObject bundle = archive.view<Bundle>();
+ * std::string_view name = bundle.getString("name");
+ * \endcode
+ *
+ * \sa mapped, MappedArchiveWriter, MappedObject
+ */
+class MappedArchiveReader
+{
+public:
+
+    //! A value within the archive, null if invalid.
+    struct Node
+    {
+        const char* m_data = nullptr; // Tag of the value
+    };
+
+    //! Facilitate iteration over arrays.
+    struct ArrayIterator
+    {
+        const MappedArchiveReader* m_reader;
+        Node m_array;
+        size_t m_index;
+        size_t m_size;
+
+        [[nodiscard]] bool isEnd() const { return m_index >= m_size; }
+        void next() { ++m_index; }
+        [[nodiscard]] Node getItem() const { return m_reader->item(m_array, m_index); }
+        [[nodiscard]] size_t size() const { return m_size; }
+    };
+
+    MappedArchiveReader(const char* data, size_t size)
+        : m_end(data + size)
+    {
+        if (data == nullptr || size < mapped::c_headerSize + 5
+            || std::memcmp(data, mapped::c_magic, 4) != 0
+            || static_cast<std::uint8_t>(data[4]) != mapped::c_version)
+            return;
+
+        const std::uint32_t namesOffset = readFixed(data + 5);
+        if (namesOffset < mapped::c_headerSize || namesOffset > size || size - namesOffset < 4)
+            return;
+
+        const char* p = data + namesOffset;
+        const std::uint32_t count = readFixed(p);
+        p += 4;
+        if (count > static_cast<size_t>(m_end - p) / 4) // each name has a length
+            return;
+        m_ids.reserve(count);
+        for (std::uint32_t id = 0; id < count; ++id)
+        {
+            if (m_end - p < 4)
+                return;
+            const std::uint32_t length = readFixed(p);
+            p += 4;
+            if (length > static_cast<size_t>(m_end - p))
+                return;
+            m_ids.emplace(std::string_view(p, length), id);
+            p += length;
+        }
+        m_root = Node{data + mapped::c_headerSize};
+        if (!isContainer(m_root, mapped::Tag::Object))
+            m_root = Node();
+    }
+
+    //! Node of the root object, to pass to ArchiveReader::read().
+    [[nodiscard]] Node root() const { return m_root; }
+
+    //! View of the root object, which is an instance of \a metaclass
+    [[nodiscard]] MappedObject view(const Class& metaclass) const;
+
+    //! View of the root object, which is an instance of \a T
+    template <typename T>
+    [[nodiscard]] MappedObject view() const;
+
+    Node findProperty(Node node, string_view name) const
+    {
+        const auto id = m_ids.find(name);
+        if (id == m_ids.end() || !isContainer(node, mapped::Tag::Object))
+            return {};
+
+        // Binary search of the offset table
+        const std::uint32_t count = containerCount(node);
+        const char* table = containerEnd(node) - 4 - count * 8;
+        size_t lo = 0, hi = count;
+        while (lo < hi)
+        {
+            const size_t mid = (lo + hi) / 2;
+            const std::uint32_t key = readFixed(table + mid * 8);
+            if (key < id->second)
+                lo = mid + 1;
+            else if (key > id->second)
+                hi = mid;
+            else
+                return at(node, readFixed(table + mid * 8 + 4));
+        }
+        return {};
+    }
+
+    ArrayIterator createArrayIterator(Node node, const std::string&) const
+    {
+        return ArrayIterator{this, node, 0, arraySize(node)};
+    }
+
+    //! Number of items of an array, 0 if the node is not an array
+    [[nodiscard]] size_t arraySize(Node node) const
+    {
+        return isContainer(node, mapped::Tag::Array) ? containerCount(node) : 0;
+    }
+
+    //! Item of an array, invalid if out of range
+    [[nodiscard]] Node item(Node node, size_t index) const
+    {
+        if (index >= arraySize(node))
+            return {};
+        const char* table = containerEnd(node) - 4 - containerCount(node) * 4;
+        return at(node, readFixed(table + index * 4));
+    }
+
+    Value getValue(Node node) const
+    {
+        if (!isValid(node))
+            return {};
+
+        switch (static_cast<mapped::Tag>(*node.m_data))
+        {
+            case mapped::Tag::False:
+                return false;
+            case mapped::Tag::True:
+                return true;
+            case mapped::Tag::Int:
+            {
+                if (m_end - node.m_data < 9)
+                    break;
+                const auto i = static_cast<long long>(readFixed64(node.m_data + 1));
+                if (i >= std::numeric_limits<long>::min() && i <= std::numeric_limits<long>::max())
+                    return static_cast<long>(i);
+                return i;
+            }
+            case mapped::Tag::Double:
+            {
+                if (m_end - node.m_data < 9)
+                    break;
+                const std::uint64_t bits = readFixed64(node.m_data + 1);
+                double d;
+                std::memcpy(&d, &bits, sizeof(d));
+                return d;
+            }
+            case mapped::Tag::String:
+                return getString(node);
+            default:
+                break;
+        }
+        return {};
+    }
+
+    //! String stored in the archive, empty if the node is not a string
+    [[nodiscard]] string_view getString(Node node) const
+    {
+        if (node.m_data == nullptr || m_end - node.m_data < 5
+            || static_cast<mapped::Tag>(*node.m_data) != mapped::Tag::String)
+            return {};
+        const std::uint32_t length = readFixed(node.m_data + 1);
+        if (length > static_cast<size_t>(m_end - node.m_data - 5))
+            return {};
+        return string_view(node.m_data + 5, length);
+    }
+
+    bool isValid(Node node) const
+    {
+        return node.m_data != nullptr && node.m_data < m_end
+            && static_cast<mapped::Tag>(*node.m_data) != mapped::Tag::Null;
+    }
+
+private:
+
+    static std::uint32_t readFixed(const char* p)
+    {
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i)
+            value |= static_cast<std::uint32_t>(static_cast<std::uint8_t>(p[i])) << (i * 8);
+        return value;
+    }
+
+    static std::uint64_t readFixed64(const char* p)
+    {
+        return readFixed(p) | static_cast<std::uint64_t>(readFixed(p + 4)) << 32;
+    }
+
+    // Is the node a complete container of the given type, with room for its table?
+    bool isContainer(Node node, mapped::Tag tag) const
+    {
+        if (node.m_data == nullptr || m_end - node.m_data < 9
+            || static_cast<mapped::Tag>(*node.m_data) != tag)
+            return false;
+        const std::uint32_t length = readFixed(node.m_data + 1);
+        if (length < 4 || length > static_cast<size_t>(m_end - node.m_data - 5))
+            return false;
+        const size_t entrySize = tag == mapped::Tag::Array ? 4 : 8;
+        return containerCount(node) <= (length - 4) / entrySize;
+    }
+
+    static const char* containerEnd(Node node)
+    {
+        return node.m_data + 5 + readFixed(node.m_data + 1);
+    }
+
+    static std::uint32_t containerCount(Node node)
+    {
+        return readFixed(containerEnd(node) - 4);
+    }
+
+    // Value at an offset of a container, invalid if outside of it
+    static Node at(Node container, std::uint32_t offset)
+    {
+        if (offset < 5 || container.m_data + offset >= containerEnd(container))
+            return {};
+        return Node{container.m_data + offset};
+    }
+
+    const char* m_end;
+    Node m_root;
+    std::unordered_map<std::string_view, std::uint32_t> m_ids; // Name table
+};
+
+class MappedArray;
+
+/**
+ * \brief View of an object stored in a memory-mapped archive
+ *
+ * A view reads the properties of an object as they are accessed, straight from the bytes
+ * of the archive, without creating the object. It is described by the metaclass of the
+ * object, so properties are accessed by name as with a UserObject. Views are cheap
+ * to copy and are valid as long as the reader.
+ *
+ * \code
+ * ponder::archive::MappedObject bundle = archive.view<Bundle>();
+ * long version = bundle.get("version").to<long>();
+ * ponder::archive::MappedArray meshes = bundle.array("meshes");
+ * for (size_t i = 0; i < meshes.size(); ++i)
+ *     std::cout << meshes.object<Mesh>(i).getString("name") << std::endl;
+ * \endcode
+ *
+ * \sa MappedArchiveReader, MappedArray
+ */
+class MappedObject
+{
+public:
+
+    MappedObject(const MappedArchiveReader& archive, MappedArchiveReader::Node node,
+                 const Class& metaclass)
+        : m_archive(&archive), m_node(node), m_class(&metaclass)
+    {}
+
+    //! Metaclass of the object viewed
+    [[nodiscard]] const Class& getClass() const { return *m_class; }
+
+    //! Check if the object is in the archive
+    [[nodiscard]] bool isValid() const { return m_archive->isValid(m_node); }
+
+    /**
+     * \brief Get the value of a property, as stored in the archive
+     *
+     * Strings are copied into the value; see getString() to read them in place. Enums are
+     * stored by name.
+     *
+     * \param property Name of the property
+     * \return Value of the property, or Value::nothing if it is not in the archive
+     *
+     * \throw PropertyNotFound \a property is not a property of the metaclass
+     */
+    [[nodiscard]] Value get(IdRef property) const
+    {
+        return m_archive->getValue(member(property));
+    }
+
+    /**
+     * \brief Get the value of a string property, in place
+     *
+     * \param property Name of the property
+     * \return View of the string in the archive, empty if it is not in the archive
+     *
+     * \throw PropertyNotFound \a property is not a property of the metaclass
+     */
+    [[nodiscard]] string_view getString(IdRef property) const
+    {
+        return m_archive->getString(member(property));
+    }
+
+    /**
+     * \brief Get a view of a user object property
+     *
+     * \param property Name of the property
+     * \return View of the property, invalid if it is not in the archive
+     *
+     * \throw PropertyNotFound \a property is not a property of the metaclass
+     * \throw BadType \a property is not a user object property
+     */
+    [[nodiscard]] MappedObject child(IdRef property) const
+    {
+        const Property& prop = m_class->property(property);
+        if (prop.kind() != ValueKind::User)
+            PONDER_ERROR(BadType(prop.kind(), ValueKind::User));
+        return MappedObject(*m_archive, m_archive->findProperty(m_node, prop.name()),
+                            static_cast<const UserProperty&>(prop).getClass());
+    }
+
+    /**
+     * \brief Get a view of an array property
+     *
+     * \param property Name of the property
+     * \return View of the array, empty if it is not in the archive
+     *
+     * \throw PropertyNotFound \a property is not a property of the metaclass
+     */
+    [[nodiscard]] MappedArray array(IdRef property) const;
+
+    /**
+     * \brief Deserialise the whole object viewed
+     *
+     * \param object Object to read into, of the class viewed or derived from it
+     */
+    void read(const UserObject& object) const
+    {
+        ArchiveReader<const MappedArchiveReader>(*m_archive).read(m_node, object);
+    }
+
+private:
+
+    MappedArchiveReader::Node member(IdRef property) const
+    {
+        return m_archive->findProperty(m_node, m_class->property(property).name());
+    }
+
+    const MappedArchiveReader* m_archive;
+    MappedArchiveReader::Node m_node;
+    const Class* m_class;
+};
+
+/**
+ * \brief View of an array stored in a memory-mapped archive
+ *
+ * Items are accessed by index, without reading the other items.
+ *
+ * \sa MappedObject::array
+ */
+class MappedArray
+{
+public:
+
+    MappedArray(const MappedArchiveReader& archive, MappedArchiveReader::Node node)
+        : m_archive(&archive), m_node(node)
+    {}
+
+    //! Number of items in the array
+    [[nodiscard]] size_t size() const { return m_archive->arraySize(m_node); }
+
+    //! Value of an item, Value::nothing if out of range
+    [[nodiscard]] Value get(size_t index) const
+    {
+        return m_archive->getValue(m_archive->item(m_node, index));
+    }
+
+    //! String item, in place
+    [[nodiscard]] string_view getString(size_t index) const
+    {
+        return m_archive->getString(m_archive->item(m_node, index));
+    }
+
+    //! View of an item which is an instance of \a metaclass
+    [[nodiscard]] MappedObject object(size_t index, const Class& metaclass) const
+    {
+        return MappedObject(*m_archive, m_archive->item(m_node, index), metaclass);
+    }
+
+    //! View of an item which is an instance of \a T
+    template <typename T>
+    [[nodiscard]] MappedObject object(size_t index) const
+    {
+        return object(index, classByType<T>());
+    }
+
+private:
+
+    const MappedArchiveReader* m_archive;
+    MappedArchiveReader::Node m_node;
+};
+
+inline MappedObject MappedArchiveReader::view(const Class& metaclass) const
+{
+    return MappedObject(*this, m_root, metaclass);
+}
+
+template <typename T>
+MappedObject MappedArchiveReader::view() const
+{
+    return view(classByType<T>());
+}
+
+inline MappedArray MappedObject::array(IdRef property) const
+{
+    return MappedArray(*m_archive, member(property));
+}
+
+#ifdef PONDER_ARCHIVE_MAPPED_FILE
+
+/**
+ * \brief Read-only memory mapping of a whole file
+ *
+ * The pages of the file are loaded by the system as they are accessed. A file which
+ * can't be mapped has no data.
+ */
+class MappedFile
+{
+public:
+
+    explicit MappedFile(const char* path)
+    {
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            void* data = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                m_data = static_cast<const char*>(data);
+                m_size = static_cast<size_t>(st.st_size);
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile()
+    {
+        if (m_data)
+            ::munmap(const_cast<char*>(m_data), m_size);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    //! Contents of the file, null if it could not be mapped
+    [[nodiscard]] const char* data() const { return m_data; }
+
+    //! Size of the file
+    [[nodiscard]] size_t size() const { return m_size; }
+
+private:
+
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+#endif // PONDER_ARCHIVE_MAPPED_FILE
+
+} // namespace archive
+} // namespace ponder
+
+#endif // PONDER_ARCHIVE_MAPPED_HPP
@@ -31,11 +31,46 @@
 #define PONDER_ARCHIVE_RAPIDJSON_HPP
 
 #include <ponder/class.hpp>
+#include <ponder/uses/serialise.hpp>
+#include <ponder/uses/archive/asyncsink.hpp>
 #define RAPIDJSON_HAS_STDSTRING 1
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/stringbuffer.h>
+// Writer::RawValue() has a variable only read by an assert, unused in release builds
+#if defined(_MSC_VER)
+#   pragma warning(push)
+#   pragma warning(disable: 4189)
+#elif defined(__GNUC__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wunused-variable"
+#endif
+#include <rapidjson/writer.h>
+#if defined(_MSC_VER)
+#   pragma warning(pop)
+#elif defined(__GNUC__)
+#   pragma GCC diagnostic pop
+#endif
+#include <rapidjson/internal/dtoa.h>
+#include <rapidjson/internal/itoa.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
 #include <stack>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
 
 namespace ponder {
 namespace archive {
@@ -53,16 +88,29 @@ class RapidJsonArchiveWriter
     enum class Type { object, array };
 	std::stack<Type> m_stack;
 
+    template <typename> friend class RapidJsonArchiveWriter;
+
 public:
 
     struct JsonNode {};
     using Node = JsonNode*;
 
+    /**
+     * \brief Items of an array written apart from the archive
+     *
+     * A fragment is written as compact JSON by another thread while the archive waits,
+     * then its items are appended to an array of the archive with appendFragment().
+     */
+    class Fragment;
+
     RapidJsonArchiveWriter(ARCHIVE& archive) : m_archive(archive)
     {
         m_stack.push(Type::object);
     }
 
+    //! Append the items of a fragment to the array being written
+    void appendFragment(Node arrayNode, const Fragment& fragment);
+
     Node beginChild(Node, const std::string& name)
     {
         if (m_stack.top() == Type::object)
@@ -124,6 +172,24 @@ public:
         m_stack.pop();
     }
 
+    template <typename T>
+    void writeArray(Node, const std::string& name, const T* values, size_t count)
+    {
+        if (m_stack.top() == Type::object)
+            m_archive.Key(name);
+        m_archive.StartArray();
+        for (size_t i = 0; i < count; ++i)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                m_archive.Double(values[i]);
+            else if constexpr (std::is_signed_v<T>)
+                m_archive.Int64(values[i]);
+            else
+                m_archive.Uint64(values[i]);
+        }
+        m_archive.EndArray();
+    }
+
     string_view getValue(Node node)
     {
         return string_view();
@@ -135,6 +201,394 @@ public:
     }
 };
 
+namespace detail {
+
+// Text of a JSON fragment, constructed before the writer using it
+struct JsonFragmentBuffer
+{
+    rapidjson::StringBuffer m_text;
+    rapidjson::Writer<rapidjson::StringBuffer> m_writer{m_text};
+    size_t m_end = 0; // End of the last item in the text, 0 if there is none
+};
+
+} // namespace detail
+
+template <typename ARCHIVE>
+class RapidJsonArchiveWriter<ARCHIVE>::Fragment
+    : private detail::JsonFragmentBuffer
+    , public RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>
+{
+    using Base = RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>;
+
+public:
+
+    //! Start a fragment of archive, root() is the node of the array to write items into
+    explicit Fragment(RapidJsonArchiveWriter<ARCHIVE>&) : Base(m_writer)
+    {
+        m_writer.StartArray();
+        m_stack.top() = Type::array;
+    }
+
+    [[nodiscard]] Node root() const { return Node(); }
+
+    void endChild(Node parent, Node child)
+    {
+        Base::endChild(parent, child);
+        if (m_stack.size() == 1)
+            m_end = m_text.GetSize();
+    }
+
+private:
+
+    friend class RapidJsonArchiveWriter<ARCHIVE>;
+};
+
+template <typename ARCHIVE>
+void RapidJsonArchiveWriter<ARCHIVE>::appendFragment(Node, const Fragment& fragment)
+{
+    if (fragment.m_end == 0)
+        return;
+
+    // The items are already separated by commas in the text of the fragment, so they are
+    // written as one raw value: the writer only adds the separator before the first one
+    const char* text = fragment.m_text.GetString();
+    m_archive.RawValue(text + 1, fragment.m_end - 1, rapidjson::kObjectType);
+}
+
+/**
+ * \brief Write JSON straight to a file, without building intermediate strings.
+ *
+ * This is an alternative to RapidJsonArchiveWriter for large outputs. The text is
+ * formatted into a fixed buffer which is flushed to a `FILE*` or a file descriptor when
+ * full, or to an AsyncSink. Property names are escaped and quoted once, then copied for each object, and
+ * numbers are formatted from their stored type with the rapidjson conversion routines.
+ * Once the names of a class have been seen, writing its objects allocates no memory.
+ *
+ * The output is the same as RapidJsonArchiveWriter with a rapidjson::Writer.
+ *
+ * \code
+ * FILE* file = std::fopen("scene.json", "wb");
+ * ponder::archive::RapidJsonStreamWriter archive(file);
+ * ponder::archive::ArchiveWriter writer(archive);
+ * writer.write(archive.root(), ponder::UserObject::makeRef(scene));
+ * archive.finish();
+ * \endcode
+ */
+class RapidJsonStreamWriter
+{
+public:
+
+    struct JsonNode {};
+    using Node = JsonNode*;
+
+    //! Write to a stdio file, which is not closed
+    RapidJsonStreamWriter(FILE* file) : m_file(file) { m_levels.reserve(32); }
+
+    //! Write to a file descriptor, which is not closed
+    RapidJsonStreamWriter(int fd) : m_fd(fd) { m_levels.reserve(32); }
+
+    //! Write to a sink, which writes the file on its own thread
+    RapidJsonStreamWriter(AsyncSink& sink) : m_sink(&sink) { m_levels.reserve(32); }
+
+    ~RapidJsonStreamWriter() { flush(); }
+
+    RapidJsonStreamWriter(const RapidJsonStreamWriter&) = delete;
+    RapidJsonStreamWriter& operator=(const RapidJsonStreamWriter&) = delete;
+
+    //! Start the root object, return its node to pass to ArchiveWriter::write()
+    Node root()
+    {
+        put('{');
+        m_levels.push_back(Level::EmptyObject);
+        return Node();
+    }
+
+    //! End the root object and flush the output. Return false if writing failed.
+    bool finish()
+    {
+        put('}');
+        m_levels.clear();
+        flush();
+        if (m_sink)
+            m_sink->flush(); // hand the end of the output over, without waiting
+        return !m_failed;
+    }
+
+    Node beginChild(Node, const std::string& name)
+    {
+        prefix(name);
+        put('{');
+        m_levels.push_back(Level::EmptyObject);
+        return Node();
+    }
+
+    void endChild(Node, Node)
+    {
+        m_levels.pop_back();
+        put('}');
+    }
+
+    Node beginArray(Node parent, const std::string& name)
+    {
+        prefix(name);
+        put('[');
+        m_levels.push_back(Level::EmptyArray);
+        return parent;
+    }
+
+    void endArray(Node, Node)
+    {
+        m_levels.pop_back();
+        put(']');
+    }
+
+    void setProperty(Node, const std::string& name, const Value& value)
+    {
+        prefix(name);
+        switch (value.kind())
+        {
+            case ValueKind::Boolean:
+                putRaw(value.cref<bool>() ? "true" : "false");
+                break;
+            case ValueKind::Integer:
+                putNumber(value.cref<long>());
+                break;
+            case ValueKind::LongInteger:
+                putNumber(value.cref<long long>());
+                break;
+            case ValueKind::Real:
+                putNumber(value.cref<double>());
+                break;
+            case ValueKind::String:
+            {
+                const String& str = value.cref<String>();
+                putString(str.data(), str.length());
+                break;
+            }
+            case ValueKind::Enum:
+            {
+                const string_view name = value.cref<EnumObject>().name();
+                putString(name.data(), name.length());
+                break;
+            }
+            case ValueKind::Reference:
+            {
+                const std::string str = value.to<std::string>();
+                putString(str.data(), str.length());
+                break;
+            }
+            default:
+                putRaw("null");
+                break;
+        }
+    }
+
+    template <typename T>
+    void writeArray(Node, const std::string& name, const T* values, size_t count)
+    {
+        prefix(name);
+        put('[');
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i > 0)
+                put(',');
+            putNumber(values[i]);
+        }
+        put(']');
+    }
+
+    bool isValid(Node node)
+    {
+        return node != nullptr;
+    }
+
+private:
+
+    enum class Level : char { EmptyObject, Object, EmptyArray, Array };
+
+    struct EncodedName
+    {
+        std::string name;       // To check that the address is still the same name
+        std::string encoded;    // "name":
+    };
+
+    static constexpr size_t c_bufferSize = 64 * 1024;
+
+    // Separate the new value from the previous one, and write its name in objects
+    void prefix(const std::string& name)
+    {
+        Level& level = m_levels.back();
+        switch (level)
+        {
+            case Level::Object:
+                put(',');
+                break;
+            case Level::Array:
+                put(',');
+                return;
+            case Level::EmptyObject:
+                level = Level::Object;
+                break;
+            case Level::EmptyArray:
+                level = Level::Array;
+                return;
+        }
+
+        // Names are usually those of the serialisation plans, which stay in place
+        EncodedName& key = m_names[&name];
+        if (key.name != name || key.encoded.empty())
+        {
+            key.name = name;
+            key.encoded.clear();
+            encode(name.data(), name.length(), key.encoded);
+            key.encoded += ':';
+        }
+        put(key.encoded.data(), key.encoded.length());
+    }
+
+    template <typename OUT>
+    static void encode(const char* str, size_t length, OUT& out)
+    {
+        static const char c_hexDigits[] = "0123456789ABCDEF";
+        out += '"';
+        for (const char* end = str + length; str != end; ++str)
+        {
+            const auto c = static_cast<unsigned char>(*str);
+            switch (c)
+            {
+                case '"': out += '\\'; out += '"'; break;
+                case '\\': out += '\\'; out += '\\'; break;
+                case '\b': out += '\\'; out += 'b'; break;
+                case '\f': out += '\\'; out += 'f'; break;
+                case '\n': out += '\\'; out += 'n'; break;
+                case '\r': out += '\\'; out += 'r'; break;
+                case '\t': out += '\\'; out += 't'; break;
+                default:
+                    if (c < 0x20)
+                    {
+                        out += '\\'; out += 'u'; out += '0'; out += '0';
+                        out += c_hexDigits[c >> 4];
+                        out += c_hexDigits[c & 15];
+                    }
+                    else
+                        out += static_cast<char>(c);
+                    break;
+            }
+        }
+        out += '"';
+    }
+
+    // Appends to the buffer, so that encode() can write to it
+    struct BufferOutput
+    {
+        RapidJsonStreamWriter& writer;
+        BufferOutput& operator+=(char c)
+        {
+            writer.put(c);
+            return *this;
+        }
+    };
+
+    void putString(const char* str, size_t length)
+    {
+        BufferOutput out{*this};
+        encode(str, length, out);
+    }
+
+    void putRaw(const char* str) { put(str, std::strlen(str)); }
+
+    template <typename T>
+    void putNumber(T value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            if (!std::isfinite(value))
+            {
+                putRaw("null"); // not representable in JSON
+                return;
+            }
+            reserve(32);
+            m_pos = rapidjson::internal::dtoa(static_cast<double>(value), m_pos);
+        }
+        else
+        {
+            reserve(24);
+            if constexpr (std::is_signed_v<T>)
+                m_pos = rapidjson::internal::i64toa(static_cast<std::int64_t>(value), m_pos);
+            else
+                m_pos = rapidjson::internal::u64toa(static_cast<std::uint64_t>(value), m_pos);
+        }
+    }
+
+    void put(char c)
+    {
+        reserve(1);
+        *m_pos++ = c;
+    }
+
+    void put(const char* data, size_t size)
+    {
+        while (size > 0)
+        {
+            reserve(1);
+            const size_t chunk = std::min(size, static_cast<size_t>(m_buffer + c_bufferSize - m_pos));
+            std::memcpy(m_pos, data, chunk);
+            m_pos += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+    }
+
+    // Make room for size characters in the buffer
+    void reserve(size_t size)
+    {
+        if (static_cast<size_t>(m_buffer + c_bufferSize - m_pos) < size)
+            flush();
+    }
+
+    void flush()
+    {
+        const size_t size = static_cast<size_t>(m_pos - m_buffer);
+        m_pos = m_buffer;
+        if (size == 0 || m_failed)
+            return;
+
+        if (m_sink)
+        {
+            m_failed = !m_sink->write(m_buffer, size);
+            return;
+        }
+        if (m_file)
+        {
+            m_failed = std::fwrite(m_buffer, 1, size, m_file) != size;
+            return;
+        }
+        for (size_t written = 0; written < size;)
+        {
+#ifdef _WIN32
+            const auto n = ::_write(m_fd, m_buffer + written, static_cast<unsigned>(size - written));
+#else
+            const auto n = ::write(m_fd, m_buffer + written, size - written);
+#endif
+            if (n <= 0)
+            {
+                m_failed = true;
+                return;
+            }
+            written += static_cast<size_t>(n);
+        }
+    }
+
+    FILE* m_file = nullptr;
+    int m_fd = -1;
+    AsyncSink* m_sink = nullptr;
+    bool m_failed = false;
+    char m_buffer[c_bufferSize];
+    char* m_pos = m_buffer;
+    std::vector<Level> m_levels; // Objects and arrays being written, innermost last
+    std::unordered_map<const std::string*, EncodedName> m_names; // Names by address
+};
+
 /**
  * \brief Read from an archive that uses JSON format as storage.
  *
@@ -161,14 +615,33 @@ public:
         [[nodiscard]] bool isEnd() const { return m_iter == m_value.End(); }
         void next() { ++m_iter; }
         Node getItem() const { return *m_iter; }
+        [[nodiscard]] size_t size() const { return m_value.Size(); }
+    };
+
+    //! Facilitate iteration over the members of JSON objects.
+    struct MemberIterator
+    {
+        rapidjson::Value::ConstMemberIterator m_iter, m_end;
+
+        [[nodiscard]] bool isEnd() const { return m_iter == m_end; }
+        void next() { ++m_iter; }
+        [[nodiscard]] string_view name() const
+        {
+            return string_view{ m_iter->name.GetString(), m_iter->name.GetStringLength() };
+        }
+        Node getItem() const { return m_iter->value; }
     };
 
     RapidJsonArchiveReader(rapidjson::Document& archive) : m_archive(archive) {}
 
     Node findProperty(Node node, const std::string& name)
     {
-        const rapidjson::Value& val{ node.m_value[name] };
-        return val;
+        // Missing members are null, which is not a valid node
+        static const rapidjson::Value c_null;
+        if (!node.m_value.IsObject())
+            return c_null;
+        const auto member = node.m_value.FindMember(rapidjson::StringRef(name.data(), name.length()));
+        return member != node.m_value.MemberEnd() ? member->value : c_null;
     }
 
     ArrayIterator createArrayIterator(Node node, const std::string&)
@@ -176,6 +649,35 @@ public:
         return ArrayIterator({ node.m_value, node.m_value.Begin() });
     }
 
+    MemberIterator createMemberIterator(Node node)
+    {
+        if (!node.m_value.IsObject())
+            return MemberIterator();
+        return MemberIterator({ node.m_value.MemberBegin(), node.m_value.MemberEnd() });
+    }
+
+    template <typename T>
+    bool readArray(Node node, std::vector<T>& values)
+    {
+        if (!node.m_value.IsArray())
+            return false;
+
+        values.resize(node.m_value.Size());
+        T* value = values.data();
+        for (auto&& item : node.m_value.GetArray())
+        {
+            if (item.IsInt64())
+                *value++ = static_cast<T>(item.GetInt64());
+            else if (item.IsUint64())
+                *value++ = static_cast<T>(item.GetUint64());
+            else if (item.IsDouble())
+                *value++ = static_cast<T>(item.GetDouble());
+            else
+                return false; // e.g. null, read the items one by one
+        }
+        return true;
+    }
+
     Value getValue(Node node)
     {
         switch (node.m_value.GetType())
@@ -211,6 +713,367 @@ public:
     }
 };
 
+/**
+ * \brief Read JSON as a stream of tokens, populating user objects as they arrive.
+ *
+ * Unlike RapidJsonArchiveReader, no document is built: the rapidjson SAX Reader parses
+ * the input stream and the properties are set as their values are parsed. The memory
+ * used only depends on the nesting depth of the document, not on its size.
+ *
+ * The layout expected is the one written by ArchiveWriter: one JSON object per user
+ * object, arrays of items, and maps as arrays of objects with "key" and "value" members.
+ * The key of a map item must come before its value when the value is a user object.
+ * Members which don't match a property are skipped.
+ *
+ * \code
+ * FILE* file = std::fopen("scene.json", "rb");
+ * char buffer[65536];
+ * rapidjson::FileReadStream stream(file, buffer, sizeof(buffer));
+ *
+ * ponder::archive::RapidJsonStreamReader reader;
+ * if (!reader.read(stream, ponder::UserObject::makeRef(scene)))
+ *     ...
+ * \endcode
+ */
+class RapidJsonStreamReader
+{
+public:
+
+    /**
+     * \brief Parse a JSON document from a stream into an object
+     *
+     * \param stream rapidjson input stream, e.g. rapidjson::FileReadStream
+     * \param object Object to populate from the root object of the document
+     *
+     * \return Result of the parse, which converts to false on error
+     */
+    template <typename InputStream>
+    rapidjson::ParseResult read(InputStream& stream, const UserObject& object)
+    {
+        m_root = object;
+        m_frames.clear();
+        m_skip = 0;
+        rapidjson::Reader reader;
+        return reader.Parse(stream, *this);
+    }
+
+    //! \name Handler called by rapidjson::Reader
+    //! \{
+
+    bool Null()
+    {
+        // A null item keeps its default value, but still takes its place in an array
+        if (m_skip == 0 && !m_frames.empty() && m_frames.back().type == Frame::Type::Array)
+        {
+            Frame& top = m_frames.back();
+            reserveItem(top);
+            ++top.index;
+        }
+        return true;
+    }
+    bool Bool(bool b) { return value(b); }
+    bool Int(int i) { return value(static_cast<long long>(i)); }
+    bool Uint(unsigned u) { return value(static_cast<long long>(u)); }
+    bool Int64(int64_t i) { return value(static_cast<long long>(i)); }
+    bool Uint64(uint64_t u)
+    {
+        if (u > static_cast<uint64_t>(std::numeric_limits<long long>::max()))
+            return value(static_cast<unsigned long long>(u));
+        return value(static_cast<long long>(u));
+    }
+    bool Double(double d) { return value(d); }
+    bool RawNumber(const char* str, rapidjson::SizeType length, bool)
+    {
+        return value(string_view(str, length));
+    }
+    bool String(const char* str, rapidjson::SizeType length, bool)
+    {
+        return value(string_view(str, length));
+    }
+
+    bool StartObject()
+    {
+        if (m_skip > 0)
+        {
+            ++m_skip;
+            return true;
+        }
+
+        if (m_frames.empty())
+        {
+            push(Frame::Type::Object, Value(m_root));
+            return true;
+        }
+
+        Frame& top = m_frames.back();
+        const detail::SerialisedProperty* entry = top.entry;
+        switch (top.type)
+        {
+            case Frame::Type::Object:
+                if (entry && entry->kind == ValueKind::User)
+                {
+                    push(Frame::Type::Object, entry->property->get(top.object));
+                    return true;
+                }
+                if (entry && entry->kind == ValueKind::None)
+                {
+                    Value v = entry->property->getForSerialization(top.object);
+                    if (v.isCompatible<UserObject>())
+                    {
+                        push(Frame::Type::Object, std::move(v));
+                        return true;
+                    }
+                }
+                break;
+
+            case Frame::Type::Array:
+                if (entry->elementKind == ValueKind::User && reserveItem(top))
+                {
+                    auto const& arrayProperty = static_cast<const ArrayProperty&>(*entry->property);
+                    push(Frame::Type::Object, arrayProperty.get(top.object, top.index));
+                    return true;
+                }
+                ++top.index;
+                break;
+
+            case Frame::Type::Map:
+                push(Frame::Type::MapItem, top);
+                return true;
+
+            case Frame::Type::MapItem:
+                if (top.slot == Frame::Slot::Value && entry->elementKind == ValueKind::User
+                    && top.key.kind() != ValueKind::None)
+                {
+                    auto const& mapProperty = static_cast<const MapProperty&>(*entry->property);
+                    push(Frame::Type::Object, mapProperty.getOrInsert(top.object, top.key));
+                    return true;
+                }
+                break;
+        }
+
+        m_skip = 1;
+        return true;
+    }
+
+    bool Key(const char* str, rapidjson::SizeType length, bool)
+    {
+        if (m_skip > 0)
+            return true;
+
+        Frame& top = m_frames.back();
+        const string_view name(str, length);
+        if (top.type == Frame::Type::Object)
+        {
+            // Members usually come in plan order: try the property after the last one
+            const auto& properties = top.plan->properties;
+            size_t index = top.entry ? static_cast<size_t>(top.entry - properties.data()) + 1 : 0;
+            if (index >= properties.size() || properties[index].name != name)
+            {
+                const auto found = top.plan->index.find(name);
+                index = found != top.plan->index.end() ? found->second : properties.size();
+            }
+            top.entry = index < properties.size() ? &properties[index] : nullptr;
+        }
+        else
+        {
+            top.slot = name == m_names.key ? Frame::Slot::Key
+                     : name == m_names.value ? Frame::Slot::Value
+                     : Frame::Slot::None;
+        }
+        return true;
+    }
+
+    bool EndObject(rapidjson::SizeType)
+    {
+        if (m_skip > 0)
+        {
+            --m_skip;
+            return true;
+        }
+
+        Frame frame = std::move(m_frames.back());
+        m_frames.pop_back();
+
+        if (frame.type == Frame::Type::MapItem)
+        {
+            // Value read before its key
+            if (frame.value.kind() != ValueKind::None && frame.key.kind() != ValueKind::None)
+            {
+                auto const& mapProperty = static_cast<const MapProperty&>(*frame.entry->property);
+                mapProperty.set(frame.object, frame.key, frame.value);
+            }
+            return true;
+        }
+
+        // Write the object read back to its owner, as it may be a copy
+        if (m_frames.empty())
+            return true;
+        Frame& parent = m_frames.back();
+        switch (parent.type)
+        {
+            case Frame::Type::Object:
+                parent.entry->property->set(parent.object, frame.value);
+                break;
+            case Frame::Type::Array:
+                static_cast<const ArrayProperty&>(*parent.entry->property)
+                    .set(parent.object, parent.index++, frame.value);
+                break;
+            case Frame::Type::MapItem:
+                static_cast<const MapProperty&>(*parent.entry->property)
+                    .set(parent.object, parent.key, frame.value);
+                break;
+            case Frame::Type::Map:
+                break;
+        }
+        return true;
+    }
+
+    bool StartArray()
+    {
+        if (m_skip > 0)
+        {
+            ++m_skip;
+            return true;
+        }
+
+        if (!m_frames.empty())
+        {
+            Frame& top = m_frames.back();
+            if (top.type == Frame::Type::Object && top.entry)
+            {
+                if (top.entry->kind == ValueKind::Array)
+                {
+                    push(Frame::Type::Array, top);
+                    return true;
+                }
+                if (top.entry->kind == ValueKind::Map)
+                {
+                    push(Frame::Type::Map, top);
+                    return true;
+                }
+            }
+            else if (top.type == Frame::Type::Array)
+                ++top.index;
+        }
+
+        m_skip = 1;
+        return true;
+    }
+
+    bool EndArray(rapidjson::SizeType)
+    {
+        if (m_skip > 0)
+        {
+            --m_skip;
+            return true;
+        }
+
+        m_frames.pop_back();
+        return true;
+    }
+
+    //! \}
+
+private:
+
+    // Where the reader is in the document
+    struct Frame
+    {
+        enum class Type { Object, Array, Map, MapItem };
+        enum class Slot { None, Key, Value }; // Member of a map item being read
+
+        Type type = Type::Object;
+        UserObject object;  // Object read, or owner of the array or map
+        Value value;        // Object: the object as a value. MapItem: value read
+        const detail::SerialisePlan* plan = nullptr;
+        const detail::SerialisedProperty* entry = nullptr; // Member being read, or the array or map
+        size_t index = 0;   // Array: index of the next item
+        size_t count = 0;   // Array: number of items
+        Value key;          // MapItem: key read
+        Slot slot = Slot::None;
+    };
+
+    // Read an object
+    void push(Frame::Type type, Value object)
+    {
+        Frame frame;
+        frame.type = type;
+        frame.object = object.to<UserObject>();
+        frame.value = std::move(object);
+        frame.plan = &m_plans.get(frame.object.getClass());
+        m_frames.push_back(std::move(frame));
+    }
+
+    // Read the array or map property of an object
+    void push(Frame::Type type, const Frame& owner)
+    {
+        Frame frame;
+        frame.type = type;
+        frame.object = owner.object;
+        frame.entry = owner.entry;
+        if (type == Frame::Type::Array)
+            frame.count = static_cast<const ArrayProperty&>(*owner.entry->property).size(owner.object);
+        m_frames.push_back(std::move(frame));
+    }
+
+    // Make sure that the next item of an array exists
+    static bool reserveItem(Frame& frame)
+    {
+        if (frame.index < frame.count)
+            return true;
+        auto const& arrayProperty = static_cast<const ArrayProperty&>(*frame.entry->property);
+        if (!arrayProperty.dynamic())
+            return false;
+        arrayProperty.resize(frame.object, frame.index + 1);
+        frame.count = frame.index + 1;
+        return true;
+    }
+
+    bool value(const Value& v)
+    {
+        if (m_skip > 0 || m_frames.empty())
+            return true;
+
+        Frame& top = m_frames.back();
+        switch (top.type)
+        {
+            case Frame::Type::Object:
+                if (top.entry && top.entry->kind != ValueKind::User && top.entry->kind != ValueKind::Array
+                    && top.entry->kind != ValueKind::Map)
+                    top.entry->property->set(top.object, v);
+                break;
+
+            case Frame::Type::Array:
+                if (top.entry->elementKind != ValueKind::User && reserveItem(top))
+                    static_cast<const ArrayProperty&>(*top.entry->property).set(top.object, top.index, v);
+                ++top.index;
+                break;
+
+            case Frame::Type::MapItem:
+                if (top.slot == Frame::Slot::Key)
+                    top.key = v;
+                else if (top.slot == Frame::Slot::Value && top.entry->elementKind != ValueKind::User)
+                {
+                    if (top.key.kind() != ValueKind::None)
+                        static_cast<const MapProperty&>(*top.entry->property).set(top.object, top.key, v);
+                    else
+                        top.value = v;
+                }
+                break;
+
+            case Frame::Type::Map:
+                break;
+        }
+        return true;
+    }
+
+    UserObject m_root;
+    std::vector<Frame> m_frames;    // Objects and containers being read, innermost last
+    int m_skip = 0;                 // Depth within a skipped object or array
+    detail::SerialisePlans m_plans;
+    const detail::ItemNames m_names;
+};
+
 } // namespace archive
 } // namespace ponder
 
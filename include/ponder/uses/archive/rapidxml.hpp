@@ -32,6 +32,14 @@
 #define PONDER_ARCHIVE_RAPIDXML_HPP
 
 #include <rapidxml/rapidxml.hpp>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 namespace ponder {
 namespace archive {
@@ -41,6 +49,18 @@ namespace archive {
  *
  * The [RapidXML](http://rapidxml.sourceforge.net) library is used to parse and
  * create and XML DOM.
+ *
+ * The text of the nodes written is allocated in the memory pool of the document. Numbers
+ * are formatted straight into it, and an archive constructed with the document keeps one
+ * copy of each node name, shared by all the nodes of that name:
+ *
+ * \code
+ * rapidxml::xml_document<> doc;
+ * auto root = doc.allocate_node(rapidxml::node_element, "scene");
+ * doc.append_node(root);
+ * ponder::archive::RapidXmlArchive<> archive(doc);
+ * ponder::archive::ArchiveWriter(archive).write(root, object);
+ * \endcode
  */
 template <typename CH = char>
 class RapidXmlArchive
@@ -69,32 +89,116 @@ public:
             m_node = m_node->next_sibling(m_name.data(), m_name.length());
         }
         Node getItem() { return m_node; }
+
+        [[nodiscard]] size_t size() const
+        {
+            size_t count = 0;
+            for (Node node = m_node; node; node = node->next_sibling(m_name.data(), m_name.length()))
+                ++count;
+            return count;
+        }
+    };
+
+    //! Facilitate iteration over the child elements of an XML element.
+    class MemberIterator
+    {
+        Node m_node{};
+
+        void skipData()
+        {
+            while (m_node && m_node->type() != rapidxml::node_element)
+                m_node = m_node->next_sibling();
+        }
+
+    public:
+
+        MemberIterator(Node node) : m_node(node->first_node()) { skipData(); }
+
+        [[nodiscard]] bool isEnd() const { return m_node == nullptr; }
+        void next()
+        {
+            m_node = m_node->next_sibling();
+            skipData();
+        }
+        [[nodiscard]] string_view name() const
+        {
+            return string_view(m_node->name(), m_node->name_size());
+        }
+        Node getItem() { return m_node; }
     };
 
+    //! Archive copying the names of each node into the document written
+    RapidXmlArchive() = default;
+
+    /**
+     * \brief Archive writing into a document, with one copy of each node name
+     *
+     * The names are copied into the memory pool of the document the first time they are
+     * written. Clearing the document frees them: call reset() before writing into it again.
+     *
+     * \param document Document of the nodes written
+     */
+    explicit RapidXmlArchive(rapidxml::xml_document<ch_t>& document) : m_document(&document) {}
+
+    //! Forget the names copied into the document, once it has been cleared
+    void reset() { m_names.clear(); }
+
     // Write
 
     Node beginChild(Node parent, const std::string& name)
     {
-        const char* nodeName = parent->document()->allocate_string(name.c_str(), name.length()+1);
-        Node child = parent->document()->allocate_node(rapidxml::node_element, nodeName);
-        parent->append_node(child);
-        return child;
+        return appendElement(parent, name);
     }
 
     void endChild(Node /*parent*/, Node /*child*/) {}
 
     void setProperty(Node parent, const std::string& name, const Value& value)
     {
-        const char* nodeName = parent->document()->allocate_string(name.c_str(), name.length() + 1);
-        Node child = parent->document()->allocate_node(rapidxml::node_element, nodeName);
-        parent->append_node(child);
-        auto text = value.to<std::string>();
-        child->value(child->document()->allocate_string(text.c_str(), text.length() + 1));
+        Node child = appendElement(parent, name);
+        rapidxml::xml_document<ch_t>* doc = document(parent);
+        switch (value.kind())
+        {
+            case ValueKind::Boolean:
+                child->value(value.to<bool>() ? "1" : "0", 1); // static text, the node doesn't own it
+                break;
+            case ValueKind::Integer:
+            case ValueKind::LongInteger:
+                setNumber(doc, child, value.to<long long>());
+                break;
+            case ValueKind::Real:
+                setNumber(doc, child, value.to<double>());
+                break;
+            case ValueKind::String:
+                setText(doc, child, value.cref<String>());
+                break;
+            case ValueKind::Enum:
+                setText(doc, child, value.cref<EnumObject>().name());
+                break;
+            default:
+                setText(doc, child, value.to<std::string>());
+                break;
+        }
+    }
+
+    // Arrays of numbers are written as the text of one element, separated by spaces
+    template <typename T>
+    void writeArray(Node parent, const std::string& name, const T* values, size_t count)
+    {
+        std::string text;
+        char number[32];
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i > 0)
+                text.push_back(' ');
+            text.append(number, formatNumber(number, number + sizeof(number), values[i]));
+        }
+
+        setText(document(parent), appendElement(parent, name), text);
     }
 
     Node beginArray(Node parent, const std::string& name)
     {
-        return beginChild(parent, name);
+        return appendElement(parent, name);
     }
 
     void endArray(Node /*parent*/, Node /*child*/) {}
@@ -111,6 +215,38 @@ public:
         return ArrayIterator(node, string_view(name.c_str(), name.length()));
     }
 
+    MemberIterator createMemberIterator(Node node)
+    {
+        return MemberIterator(node);
+    }
+
+    template <typename T>
+    bool readArray(Node node, std::vector<T>& values)
+    {
+        // Arrays written item by item have child elements
+        for (Node child = node->first_node(); child; child = child->next_sibling())
+        {
+            if (child->type() == rapidxml::node_element)
+                return false;
+        }
+
+        values.clear();
+        const char* p = node->value();
+        const char* end = p + node->value_size();
+        for (;;)
+        {
+            while (p != end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+                ++p;
+            if (p == end)
+                return true;
+            T value;
+            p = parseNumber(p, end, value);
+            if (!p)
+                return false;
+            values.push_back(value);
+        }
+    }
+
     string_view getValue(Node node)
     {
         return string_view(node->value(), node->value_size());
@@ -120,6 +256,119 @@ public:
     {
         return node != nullptr;
     }
+
+private:
+
+    struct InternedName
+    {
+        std::string name;           // To check that the address is still the same name
+        const ch_t* copy = nullptr; // Copy in the memory pool of the document
+    };
+
+    rapidxml::xml_document<ch_t>* document(Node node) const
+    {
+        return m_document ? m_document : node->document();
+    }
+
+    Node appendElement(Node parent, const std::string& name)
+    {
+        rapidxml::xml_document<ch_t>* doc = document(parent);
+        const ch_t* nodeName;
+        if (m_document)
+        {
+            // Names are usually those of the serialisation plans, which stay in place
+            InternedName& interned = m_names[&name];
+            if (!interned.copy || interned.name != name)
+            {
+                interned.name = name;
+                interned.copy = doc->allocate_string(name.c_str(), name.length() + 1);
+            }
+            nodeName = interned.copy;
+        }
+        else
+        {
+            nodeName = doc->allocate_string(name.c_str(), name.length() + 1);
+        }
+        Node child = doc->allocate_node(rapidxml::node_element, nodeName, nullptr, name.length());
+        parent->append_node(child);
+        return child;
+    }
+
+    static void setText(rapidxml::xml_document<ch_t>* doc, Node node, const std::string& text)
+    {
+        if (!text.empty())
+            node->value(doc->allocate_string(text.c_str(), text.length() + 1), text.length());
+    }
+
+    // Format the number on the stack, then copy exactly its length into the pool
+    template <typename T>
+    static void setNumber(rapidxml::xml_document<ch_t>* doc, Node node, T value)
+    {
+        char text[32];
+        char* end = formatNumber(text, text + sizeof(text) - 1, value);
+        *end = '\0';
+        const auto length = static_cast<size_t>(end - text);
+        node->value(doc->allocate_string(text, length + 1), length);
+    }
+
+    // Format a number, returning the end of its text
+    template <typename T>
+    static char* formatNumber(char* first, char* last, T value)
+    {
+#if !defined(__cpp_lib_to_chars)
+        // Not all standard libraries have std::to_chars for reals: use the shortest
+        // precision which reads back as the same value
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            const auto size = static_cast<size_t>(last - first);
+            int length = std::snprintf(first, size, "%.*g", std::numeric_limits<T>::digits10,
+                                       static_cast<double>(value));
+            T check;
+            if (parseNumber(first, first + length, check) != first + length || check != value)
+                length = std::snprintf(first, size, "%.*g", std::numeric_limits<T>::max_digits10,
+                                       static_cast<double>(value));
+            return first + length;
+        }
+        else
+#endif
+        return std::to_chars(first, last, value).ptr;
+    }
+
+    // Parse a number, returning the end of its text or null if there is no number
+    template <typename T>
+    static const char* parseNumber(const char* first, const char* last, T& value)
+    {
+#if !defined(__cpp_lib_to_chars)
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            // The text may not be null terminated: copy the number before strtod reads it
+            char text[64];
+            size_t length = 0;
+            while (first + length != last && length < sizeof(text) - 1
+                   && first[length] != ' ' && first[length] != '\t'
+                   && first[length] != '\n' && first[length] != '\r')
+            {
+                text[length] = first[length];
+                ++length;
+            }
+            text[length] = '\0';
+            char* end = nullptr;
+            if constexpr (std::is_same_v<T, float>)
+                value = std::strtof(text, &end);
+            else
+                value = static_cast<T>(std::strtod(text, &end));
+            return end == text ? nullptr : first + (end - text);
+        }
+        else
+#endif
+        {
+            const std::from_chars_result result = std::from_chars(first, last, value);
+            return result.ec == std::errc() ? result.ptr : nullptr;
+        }
+    }
+
+    rapidxml::xml_document<ch_t>* m_document = nullptr;
+    std::unordered_map<const std::string*, InternedName> m_names; // Names by address
 };
 
 } // namespace archive
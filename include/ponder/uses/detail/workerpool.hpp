@@ -0,0 +1,163 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#pragma once
+#ifndef PONDER_USES_WORKERPOOL_HPP
+#define PONDER_USES_WORKERPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ponder {
+namespace archive {
+namespace detail {
+
+/*
+ * Fixed set of threads running the tasks of a job together with the calling thread.
+ * Jobs are run one at a time: run() returns when all the tasks of its job are done.
+ */
+class WorkerPool
+{
+public:
+
+    // threads: number of threads running the jobs, including the calling one
+    explicit WorkerPool(unsigned threads)
+    {
+        for (unsigned i = 1; i < threads; ++i)
+            m_workers.emplace_back([this] { work(); });
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wake.notify_all();
+        for (auto&& worker : m_workers)
+            worker.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    size_t size() const { return m_workers.size() + 1; }
+
+    // Call task(0) ... task(count - 1) on the threads of the pool, and wait for them. The
+    // first exception thrown by a task is rethrown, once all the tasks are done.
+    void run(size_t count, const std::function<void(size_t)>& task)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_done.wait(lock, [this] { return m_active == 0; }); // late workers of the last job
+            m_task = &task;
+            m_count = count;
+            m_next = 0;
+            m_pending = count;
+            m_error = nullptr;
+            ++m_job;
+        }
+        m_wake.notify_all();
+
+        runTasks();
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_pending == 0 && m_active == 0; });
+        m_task = nullptr;
+        if (m_error)
+            std::rethrow_exception(m_error);
+    }
+
+private:
+
+    void work()
+    {
+        size_t job = 0;
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [&] { return m_stop || m_job != job; });
+                if (m_stop)
+                    return;
+                job = m_job;
+                ++m_active;
+            }
+            runTasks();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_active == 0)
+                m_done.notify_all();
+        }
+    }
+
+    // Take tasks of the current job until there are none left
+    void runTasks()
+    {
+        for (size_t index; (index = m_next++) < m_count;)
+        {
+            try
+            {
+                (*m_task)(index);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_error)
+                    m_error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_pending;
+        }
+    }
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake, m_done;
+    const std::function<void(size_t)>* m_task = nullptr;
+    size_t m_count = 0;
+    std::atomic<size_t> m_next{0};
+    size_t m_pending = 0;   // Tasks of the job not done
+    size_t m_active = 0;    // Workers running tasks
+    size_t m_job = 0;
+    std::exception_ptr m_error;
+    bool m_stop = false;
+};
+
+} // namespace detail
+} // namespace archive
+} // namespace ponder
+
+#endif // PONDER_USES_WORKERPOOL_HPP
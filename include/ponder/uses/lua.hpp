@@ -149,9 +149,12 @@ PONDER_API bool runString(lua_State *L, const char *luaCode);
 
 #include <ponder/uses/runtime.hpp>
 #include <ponder/uses/detail/lua.hpp>
+#include <ponder/mapproperty.hpp>
 
 #define PONDER_LUA_METATBLS "_ponder_meta"
 #define PONDER_LUA_INSTTBLS "_instmt"
+#define PONDER_LUA_MAPMT "_ponder_map"
+#define PONDER_LUA_MAPCURSORMT "_ponder_mapcursor"
 
 namespace ponder {
 namespace lua {
@@ -268,6 +271,111 @@ static Value getValue(lua_State *L, int index,
     return {}; // no value
 }
 
+// Proxy to a map property of an object, its entries are accessed in place
+struct MapProxy
+{
+    const MapProperty* property;
+    UserObject object;
+};
+
+// map[key]
+static int l_map_index(lua_State *L)
+{
+    const auto *proxy = static_cast<MapProxy*>(luaL_checkudata(L, 1, PONDER_LUA_MAPMT));
+    const Value key = getValue(L, 2, proxy->property->keyType());
+
+    if (!proxy->property->contains(proxy->object, key))
+        return 0;
+
+    return pushValue(L, proxy->property->get(proxy->object, key));
+}
+
+// map[key] = value, map[key] = nil erases the entry
+static int l_map_newindex(lua_State *L)
+{
+    const auto *proxy = static_cast<MapProxy*>(luaL_checkudata(L, 1, PONDER_LUA_MAPMT));
+    const Value key = getValue(L, 2, proxy->property->keyType());
+
+    if (lua_isnil(L, 3))
+        proxy->property->erase(proxy->object, key);
+    else
+        proxy->property->set(proxy->object, key, getValue(L, 3, proxy->property->mappedType()));
+
+    return 0;
+}
+
+// #map
+static int l_map_len(lua_State *L)
+{
+    const auto *proxy = static_cast<MapProxy*>(luaL_checkudata(L, 1, PONDER_LUA_MAPMT));
+    lua_pushinteger(L, static_cast<lua_Integer>(proxy->property->size(proxy->object)));
+    return 1;
+}
+
+// iterator function returned by pairs(map), the cursor is its upvalue
+static int l_map_next(lua_State *L)
+{
+    auto *cursor = static_cast<MapCursor*>(lua_touserdata(L, lua_upvalueindex(1)));
+    if (!cursor->valid())
+        return 0;
+
+    pushValue(L, cursor->key());
+    pushValue(L, cursor->value());
+    cursor->next();
+    return 2;
+}
+
+// pairs(map)
+static int l_map_pairs(lua_State *L)
+{
+    const auto *proxy = static_cast<MapProxy*>(luaL_checkudata(L, 1, PONDER_LUA_MAPMT));
+
+    void *ud = lua_newuserdata(L, sizeof(MapCursor));   // +1
+    new(ud) MapCursor(proxy->property->cursor(proxy->object));
+    luaL_setmetatable(L, PONDER_LUA_MAPCURSORMT);
+
+    lua_pushcclosure(L, l_map_next, 1);         // 0 -+ next
+    lua_pushvalue(L, 1);                        // +1 map
+    lua_pushnil(L);                             // +1 initial key
+    return 3;
+}
+
+template <typename T>
+static int l_map_finalise(lua_State* L)
+{
+    static_cast<T*>(lua_touserdata(L, 1))->~T();
+    return 0;
+}
+
+// push a proxy to a map property of an object
+static int pushMap(lua_State *L, const MapProperty& property, const UserObject& object)
+{
+    void *ud = lua_newuserdata(L, sizeof(MapProxy));    // +1
+    new(ud) MapProxy{&property, object};
+
+    // metatables shared by all the maps
+    if (luaL_newmetatable(L, PONDER_LUA_MAPMT))   // +1 mt
+    {
+        const luaL_Reg methods[] = {
+            {"__index", l_map_index},
+            {"__newindex", l_map_newindex},
+            {"__len", l_map_len},
+            {"__pairs", l_map_pairs},
+            {"__gc", l_map_finalise<MapProxy>},
+            {nullptr, nullptr}
+        };
+        luaL_setfuncs(L, methods, 0);
+
+        luaL_newmetatable(L, PONDER_LUA_MAPCURSORMT); // +1
+        lua_pushcfunction(L, l_map_finalise<MapCursor>); // +1
+        lua_setfield(L, -2, "__gc");            // -1
+        lua_pop(L, 1);                          // -1
+    }
+    lua_setmetatable(L, -2);                    // -1
+
+    return 1;
+}
+
 // obj[key]
 static int l_inst_index(lua_State *L)
 {
@@ -282,6 +390,8 @@ static int l_inst_index(lua_State *L)
     if (cls->tryProperty(key, pp))
     {
         const auto *uobj = static_cast<UserObject*>(ud);
+        if (pp->kind() == ValueKind::Map)
+            return pushMap(L, static_cast<const MapProperty&>(*pp), *uobj);
         return pushValue(L, pp->get(*uobj));
     }
 
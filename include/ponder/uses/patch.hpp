@@ -0,0 +1,90 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+/**
+ * \file
+ * \brief Patches describing the changes between two objects.
+ */
+
+#pragma once
+#ifndef PONDER_USES_PATCH_HPP
+#define PONDER_USES_PATCH_HPP
+
+#include <ponder/value.hpp>
+#include <vector>
+
+namespace ponder {
+namespace runtime {
+
+/**
+ * \brief Step of the path leading from an object to a changed value
+ *
+ * A step selects a property of the current object and, for array and map properties,
+ * one of their elements.
+ */
+struct PatchStep
+{
+    Id property;    ///< Name of the property
+    Value key;      ///< Index of the array element or key of the map entry, if any
+};
+
+/**
+ * \brief Single change of a patch
+ *
+ * The path leads from the patched object to the changed value, through composed user
+ * objects and array or map elements. The last step designates the value itself:
+ * - Set assigns \a value to the property, array element or map entry,
+ * - Insert inserts \a value in the array before the given index,
+ * - Remove removes the array element or map entry.
+ */
+struct PatchOp
+{
+    enum class Kind
+    {
+        Set,
+        Insert,
+        Remove
+    };
+
+    Kind kind;                  ///< Kind of change
+    std::vector<PatchStep> path;///< Path to the changed value
+    Value value;                ///< New value, for Set and Insert
+};
+
+/**
+ * \brief List of changes, applied in order
+ *
+ * \sa runtime::diff, runtime::applyPatch, archive::ArchiveWriter
+ */
+using Patch = std::vector<PatchOp>;
+
+} // namespace runtime
+} // namespace ponder
+
+#endif // PONDER_USES_PATCH_HPP
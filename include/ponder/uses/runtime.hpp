@@ -38,6 +38,13 @@
 
 #include <ponder/class.hpp>
 #include <ponder/constructor.hpp>
+#include <ponder/arrayproperty.hpp>
+#include <ponder/mapproperty.hpp>
+#include <ponder/uses/patch.hpp>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
 
 /**
  * \namespace ponder::runtime
@@ -76,6 +83,11 @@ struct UserObjectDeleter {
     void operator () (const UserObject *uo) const { destroy(*uo); }
 };
 
+inline void copyProperties(const UserObject& source, const UserObject& target);
+
+class PatchBuilder;
+inline void applyPatchOp(const UserObject& object, const PatchOp& op, size_t depth);
+
 } // namespace detail
 
 /**
@@ -278,6 +290,185 @@ private:
     const std::unique_ptr<detail::FunctionCaller>& m_caller;
 };
 
+/**
+ * \brief This object is used to get and set all the properties of objects at once
+ *
+ * The readable properties of the class are collected once when the plan is built, so
+ * reading or writing a whole object doesn't look up or check each property again. This
+ * is useful to take snapshots of objects, e.g. for undo or replication. The values are
+ * ordered as the properties of the class which are part of the plan, see property().
+ *
+ * User objects are deep copied (see clone()), so that a snapshot doesn't alias the
+ * members of the object it was taken from. Array and map properties are not part of
+ * the plan, as a Value can't hold a whole container: copy them with ArrayProperty and
+ * MapProperty.
+ *
+ * \code
+ * runtime::PropertyPlan plan(classByType<MyClass>());
+ * std::vector<Value> snapshot;
+ * plan.getAll(object, snapshot);
+ * // ... modify object
+ * plan.setAll(object, snapshot); // restore it
+ * \endcode
+ *
+ * \note The plan must be rebuilt if properties are added to the class.
+ */
+class PropertyPlan
+{
+public:
+
+    /**
+     * \brief Constructor
+     *
+     * \param cls The Class whose properties are accessed
+     */
+    inline PropertyPlan(const Class &cls);
+
+    /**
+     * \brief Get the class begin used
+     *
+     * \return a Class reference
+     */
+    [[nodiscard]] const Class& getClass() const { return m_class; }
+
+    /**
+     * \brief Get the number of properties accessed by the plan
+     *
+     * \return Number of readable properties, except arrays and maps
+     */
+    [[nodiscard]] size_t propertyCount() const { return m_properties.size(); }
+
+    /**
+     * \brief Get a property accessed by the plan
+     *
+     * \param index Index of the property, in the order of the values
+     *
+     * \return Reference to the property
+     */
+    [[nodiscard]] const Property& property(size_t index) const {return *m_properties[index].property;}
+
+    /**
+     * \brief Read all the properties of an object
+     *
+     * \param object Object to read
+     * \param values Buffer receiving the values, resized to propertyCount()
+     *
+     * \throw NullObject object is invalid
+     * \throw ForbiddenCopy a user property holds an object which can't be copied
+     */
+    inline void getAll(const UserObject &object, std::vector<Value> &values) const;
+
+    /**
+     * \brief Write all the writable properties of an object
+     *
+     * Read-only properties are skipped, so values taken with getAll() can be given back.
+     *
+     * \param object Object to write
+     * \param values Values of the properties, as returned by getAll()
+     *
+     * \throw OutOfRange there are less values than properties
+     * \throw NullObject object is invalid
+     */
+    inline void setAll(const UserObject &object, const std::vector<Value> &values) const;
+
+private:
+
+    struct Entry
+    {
+        const Property* property;
+        bool writable;
+    };
+
+    const Class &m_class;
+    std::vector<Entry> m_properties;
+};
+
+/**
+ * \brief This object compares and hashes objects by content
+ *
+ * Objects are compared through their readable properties, recursively: user objects
+ * are compared by content rather than by address, arrays and maps element by element.
+ * The first time a class is met, a plan listing how each of its properties is compared
+ * is built and kept for all the following objects of the class. Scalar data members
+ * without padding bits, and bitwise comparable arrays (see ArrayProperty::bitwise()),
+ * are compared and hashed as raw memory. Pointers are always compared through the
+ * objects they point to, and members which are not properties are ignored.
+ *
+ * Equal objects have equal hashes, and hashes only depend on the content of the
+ * objects, so a comparator can be used to deduplicate objects.
+ *
+ * \code
+ * runtime::ObjectComparator comparator;
+ * for (auto&& object : objects)
+ *     buckets[comparator.hash(object)].push_back(object);
+ * \endcode
+ *
+ * \note The comparator must be rebuilt if properties are added to a class it has met.
+ */
+class ObjectComparator
+{
+public:
+
+    /**
+     * \brief Check if two objects have the same content
+     *
+     * \param first First object to compare
+     * \param second Second object to compare
+     * \return True if the objects have the same class and equal properties
+     */
+    inline bool equal(const UserObject &first, const UserObject &second) const;
+
+    /**
+     * \brief Check if two values have the same content
+     *
+     * User objects are compared by content, other values with Value::operator==.
+     *
+     * \param first First value to compare
+     * \param second Second value to compare
+     * \return True if the values are equal
+     */
+    inline bool equal(const Value &first, const Value &second) const;
+
+    /**
+     * \brief Compute a hash of the content of an object
+     *
+     * \param object Object to hash
+     * \return Hash of the readable properties of the object
+     */
+    [[nodiscard]] inline size_t hash(const UserObject &object) const;
+
+private:
+
+    enum class FieldKind
+    {
+        Value,          // Compared as a Value
+        Bitwise,        // Data member compared as raw memory
+        User,           // Compared by content, recursively
+        Array,          // Compared element by element
+        BitwiseArray,   // Compared as raw memory
+        Map,            // Compared entry by entry
+    };
+
+    struct Field
+    {
+        const Property* property;
+        FieldKind kind;
+    };
+
+    struct Plan
+    {
+        std::vector<Field> fields;
+    };
+
+    inline const Plan& plan(const Class &cls) const;
+    inline size_t hashValue(const Value &value) const;
+    inline bool equalFields(const Field &field, const UserObject &first,
+                            const UserObject &second) const;
+    inline size_t hashField(const Field &field, const UserObject &object) const;
+
+    mutable std::unordered_map<const Class*, Plan> m_plans;
+};
+
 //--------------------------------------------------------------------------------------
 // Helpers
 
@@ -322,6 +513,109 @@ inline void destroy(const UserObject &obj)
     ObjectFactory(obj.getClass()).destroy(obj);
 }
 
+/**
+ * \brief Create a deep copy of a UserObject instance
+ *
+ * The copy is made with the cheapest method the metaclass allows. Trivially copyable
+ * classes are copied bytewise by their copy constructor, as are the classes declared
+ * with ClassBuilder::copyable(). Other classes are default constructed and their
+ * properties copied one by one: user objects exposed by reference are copied in place,
+ * recursively, and arrays and maps are copied element-wise.
+ *
+ * Unlike create(), the returned UserObject owns its instance and must not be destroyed.
+ *
+ * \param source Instance to copy
+ * \return A UserObject owning the copy
+ *
+ * \throw NullObject \a source is empty
+ * \throw ForbiddenCopy the class is neither copy constructible nor default constructible
+ */
+inline UserObject clone(const UserObject &source)
+{
+    const Class& cls = source.getClass();
+    if (source.pointer() == nullptr)
+        PONDER_ERROR(NullObject(&cls));
+
+    if (cls.isCopyConstructible())
+        return cls.getUserObjectCopy(source.pointer());
+
+    UserObject target = cls.getDefaultUserObject();
+    if (target == UserObject::nothing)
+        PONDER_ERROR(ForbiddenCopy(cls.name()));
+
+    detail::copyProperties(source, target);
+    return target;
+}
+
+/**
+ * \brief Check if two objects have the same content
+ *
+ * This is a helper function which uses an ObjectComparator. To compare many objects,
+ * use an ObjectComparator directly so that its comparison plans are reused.
+ *
+ * \param first First object to compare
+ * \param second Second object to compare
+ * \return True if the objects have the same class and equal properties, recursively
+ *
+ * \sa deepHash()
+ */
+inline bool deepEqual(const UserObject &first, const UserObject &second)
+{
+    return ObjectComparator().equal(first, second);
+}
+
+/**
+ * \brief Compute a hash of the content of an object
+ *
+ * This is a helper function which uses an ObjectComparator. Objects which are
+ * deepEqual() have the same hash.
+ *
+ * \param object Object to hash
+ * \return Hash of the readable properties of the object, recursively
+ *
+ * \sa deepEqual()
+ */
+inline size_t deepHash(const UserObject &object)
+{
+    return ObjectComparator().hash(object);
+}
+
+/**
+ * \brief Compute the changes which turn an object into another one
+ *
+ * The objects are walked together, property by property: composed user objects and the
+ * elements of arrays and maps are compared in place and only the values which differ are
+ * recorded. Elements inserted or removed in the middle of an array are detected when the
+ * rest of the array is unchanged, and recorded as Insert and Remove operations.
+ *
+ * Read-only properties are skipped, as they can't be patched.
+ *
+ * \param from Object to start from
+ * \param to Object to reach, of the same class
+ * \return Patch which turns \a from into \a to when given to applyPatch()
+ *
+ * \note User object values in the patch may refer to the elements of \a to, which must
+ *       outlive the patch.
+ *
+ * \throw ClassUnrelated the objects don't have the same class
+ */
+inline Patch diff(const UserObject &from, const UserObject &to);
+
+/**
+ * \brief Apply the changes of a patch to an object
+ *
+ * \param object Object to patch
+ * \param patch Changes, as returned by diff()
+ *
+ * \throw PropertyNotFound the path of a change doesn't match the class of the object
+ * \throw OutOfRange the index of an array element is out of range
+ */
+inline void applyPatch(const UserObject &object, const Patch &patch)
+{
+    for (auto&& op : patch)
+        detail::applyPatchOp(object, op, 0);
+}
+
 /**
  * \brief Call a member function
  *
@@ -487,6 +781,564 @@ FunctionCaller::FunctionCaller(const Function &f)
 {
 }
 
+namespace detail {
+
+inline void copyProperties(const UserObject& source, const UserObject& target)
+{
+    const Class& cls = source.getClass();
+    for (size_t nb = cls.propertyCount(), i = 0; i < nb; ++i)
+    {
+        const Property& prop = cls.property(i);
+        if (!prop.isReadable())
+            continue;
+
+        switch (prop.kind())
+        {
+            case ValueKind::Array:
+            {
+                const auto& array = static_cast<const ArrayProperty&>(prop);
+                if (!array.isWritable())
+                    break;
+                const size_t count = array.size(source);
+                if (array.dynamic())
+                    array.resize(target, count);
+                for (size_t n = std::min(count, array.size(target)), j = 0; j < n; ++j)
+                    array.set(target, j, array.get(source, j));
+                break;
+            }
+
+            case ValueKind::Map:
+            {
+                const auto& map = static_cast<const MapProperty&>(prop);
+                if (!map.isWritable())
+                    break;
+                for (auto it = map.cursor(source); it.valid(); it.next())
+                    map.set(target, it.key(), it.value());
+                break;
+            }
+
+            case ValueKind::User:
+            {
+                if (prop.isWritable())
+                {
+                    prop.set(target, prop.get(source));
+                    break;
+                }
+
+                // Read-only composed object: copy it in place, if it is exposed by reference
+                const UserObject from = prop.get(source).to<UserObject>();
+                const UserObject to = prop.get(target).to<UserObject>();
+                if (from.pointer() == nullptr || to.pointer() == nullptr)
+                    break;
+                if (from.getClass().isTriviallyCopyable() && from.getClass() == to.getClass())
+                    std::memcpy(to.pointer(), from.pointer(), from.getClass().sizeOf());
+                else
+                    copyProperties(from, to);
+                break;
+            }
+
+            default:
+                if (prop.isWritable())
+                    prop.set(target, prop.get(source));
+                break;
+        }
+    }
+}
+
+} // namespace detail
+
+PropertyPlan::PropertyPlan(const Class &cls)
+    :   m_class(cls)
+{
+    m_properties.reserve(cls.propertyCount());
+    for (size_t nb = cls.propertyCount(), i = 0; i < nb; ++i)
+    {
+        const Property& prop = cls.property(i);
+        if (!prop.isReadable() || prop.kind() == ValueKind::Array || prop.kind() == ValueKind::Map)
+            continue;
+        m_properties.push_back(Entry{&prop, prop.isWritable()});
+    }
+}
+
+void PropertyPlan::getAll(const UserObject &object, std::vector<Value> &values) const
+{
+    if (object.pointer() == nullptr)
+        PONDER_ERROR(NullObject(&m_class));
+
+    values.resize(m_properties.size());
+    for (size_t nb = m_properties.size(), i = 0; i < nb; ++i)
+    {
+        Value value = m_properties[i].property->getValue(object);
+
+        // Data members are returned by reference: keep a copy, not an alias
+        if (value.kind() == ValueKind::User)
+        {
+            const UserObject& user = value.cref<UserObject>();
+            if (user.pointer() != nullptr)
+                value = clone(user);
+        }
+        values[i] = std::move(value);
+    }
+}
+
+void PropertyPlan::setAll(const UserObject &object, const std::vector<Value> &values) const
+{
+    if (values.size() < m_properties.size())
+        PONDER_ERROR(OutOfRange(values.size(), m_properties.size()));
+    if (object.pointer() == nullptr)
+        PONDER_ERROR(NullObject(&m_class));
+
+    for (size_t nb = m_properties.size(), i = 0; i < nb; ++i)
+    {
+        if (m_properties[i].writable)
+            object.set(*m_properties[i].property, values[i]);
+    }
+}
+
+namespace detail {
+
+// FNV-1a, so that hashes don't depend on the standard library
+inline size_t hashBytes(size_t seed, const void* data, size_t size)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t h = seed;
+    for (size_t i = 0; i < size; ++i)
+        h = (h ^ bytes[i]) * 0x100000001b3ull;
+    return static_cast<size_t>(h);
+}
+
+template <typename T>
+inline size_t hashScalar(size_t seed, T value)
+{
+    return hashBytes(seed, &value, sizeof(value));
+}
+
+constexpr size_t c_hashSeed = static_cast<size_t>(0xcbf29ce484222325ull);
+
+} // namespace detail
+
+const ObjectComparator::Plan& ObjectComparator::plan(const Class &cls) const
+{
+    if (auto it = m_plans.find(&cls); it != m_plans.end())
+        return it->second;
+
+    Plan& plan = m_plans[&cls];
+    plan.fields.reserve(cls.propertyCount());
+    for (size_t nb = cls.propertyCount(), i = 0; i < nb; ++i)
+    {
+        const Property& prop = cls.property(i);
+        if (!prop.isReadable())
+            continue;
+
+        FieldKind kind = FieldKind::Value;
+        switch (prop.kind())
+        {
+            case ValueKind::User:
+                kind = FieldKind::User;
+                break;
+            case ValueKind::Array:
+                kind = static_cast<const ArrayProperty&>(prop).bitwise() ? FieldKind::BitwiseArray
+                                                                         : FieldKind::Array;
+                break;
+            case ValueKind::Map:
+                kind = FieldKind::Map;
+                break;
+            default:
+                if (prop.m_memberBitwiseSize != 0)
+                    kind = FieldKind::Bitwise;
+                break;
+        }
+        plan.fields.push_back(Field{&prop, kind});
+    }
+    return plan;
+}
+
+bool ObjectComparator::equal(const UserObject &first, const UserObject &second) const
+{
+    if (first.pointer() == nullptr || second.pointer() == nullptr)
+        return first.pointer() == second.pointer();
+
+    const Class& cls = first.getClass();
+    if (cls != second.getClass())
+        return false;
+    if (first.pointer() == second.pointer())
+        return true;
+
+    for (auto&& field : plan(cls).fields)
+    {
+        if (!equalFields(field, first, second))
+            return false;
+    }
+    return true;
+}
+
+size_t ObjectComparator::hash(const UserObject &object) const
+{
+    if (object.pointer() == nullptr)
+        return detail::c_hashSeed;
+
+    size_t h = detail::c_hashSeed;
+    for (auto&& field : plan(object.getClass()).fields)
+        h = detail::hashScalar(h, hashField(field, object));
+    return h;
+}
+
+bool ObjectComparator::equalFields(const Field &field, const UserObject &first,
+                                   const UserObject &second) const
+{
+    switch (field.kind)
+    {
+        case FieldKind::User:
+            return equal(field.property->get(first).to<UserObject>(),
+                         field.property->get(second).to<UserObject>());
+
+        case FieldKind::Bitwise:
+            return std::memcmp(field.property->memberAddress(first),
+                               field.property->memberAddress(second),
+                               field.property->m_memberBitwiseSize) == 0;
+
+        case FieldKind::BitwiseArray:
+        {
+            const auto& array = static_cast<const ArrayProperty&>(*field.property);
+            size_t firstSize = 0, secondSize = 0;
+            const void* firstData = array.bytes(first, firstSize);
+            const void* secondData = array.bytes(second, secondSize);
+            return firstSize == secondSize
+                && (firstSize == 0 || std::memcmp(firstData, secondData, firstSize) == 0);
+        }
+
+        case FieldKind::Array:
+        {
+            const auto& array = static_cast<const ArrayProperty&>(*field.property);
+            auto firstIt = array.cursor(first);
+            auto secondIt = array.cursor(second);
+            if (firstIt.size() != secondIt.size())
+                return false;
+            for (; firstIt.valid(); firstIt.next(), secondIt.next())
+            {
+                if (!equal(firstIt.get(), secondIt.get()))
+                    return false;
+            }
+            return true;
+        }
+
+        case FieldKind::Map:
+        {
+            const auto& map = static_cast<const MapProperty&>(*field.property);
+            if (map.size(first) != map.size(second))
+                return false;
+            for (auto it = map.cursor(first); it.valid(); it.next())
+            {
+                const Value key = it.key();
+                if (!map.contains(second, key) || !equal(it.value(), map.get(second, key)))
+                    return false;
+            }
+            return true;
+        }
+
+        case FieldKind::Value:
+        default:
+            return equal(field.property->get(first), field.property->get(second));
+    }
+}
+
+size_t ObjectComparator::hashField(const Field &field, const UserObject &object) const
+{
+    switch (field.kind)
+    {
+        case FieldKind::User:
+            return hash(field.property->get(object).to<UserObject>());
+
+        case FieldKind::Bitwise:
+            return detail::hashBytes(detail::c_hashSeed, field.property->memberAddress(object),
+                                     field.property->m_memberBitwiseSize);
+
+        case FieldKind::BitwiseArray:
+        {
+            size_t size = 0;
+            const void* data = static_cast<const ArrayProperty&>(*field.property).bytes(object, size);
+            return detail::hashBytes(detail::c_hashSeed, data, size);
+        }
+
+        case FieldKind::Array:
+        {
+            size_t h = detail::c_hashSeed;
+            for (auto it = static_cast<const ArrayProperty&>(*field.property).cursor(object);
+                 it.valid(); it.next())
+                h = detail::hashScalar(h, hashValue(it.get()));
+            return h;
+        }
+
+        case FieldKind::Map:
+        {
+            // Entries are summed so that the iteration order of the map doesn't matter
+            size_t h = 0;
+            for (auto it = static_cast<const MapProperty&>(*field.property).cursor(object);
+                 it.valid(); it.next())
+                h += detail::hashScalar(hashValue(it.key()), hashValue(it.value()));
+            return h;
+        }
+
+        case FieldKind::Value:
+        default:
+            return hashValue(field.property->get(object));
+    }
+}
+
+bool ObjectComparator::equal(const Value &first, const Value &second) const
+{
+    if (first.kind() == ValueKind::User && second.kind() == ValueKind::User)
+        return equal(first.to<UserObject>(), second.to<UserObject>());
+    return first == second;
+}
+
+size_t ObjectComparator::hashValue(const Value &value) const
+{
+    const size_t seed = detail::hashScalar(detail::c_hashSeed, value.kind());
+    switch (value.kind())
+    {
+        case ValueKind::Boolean:
+            return detail::hashScalar(seed, value.to<bool>());
+        case ValueKind::Integer:
+            return detail::hashScalar(seed, value.to<long>());
+        case ValueKind::LongInteger:
+            return detail::hashScalar(seed, value.to<long long>());
+        case ValueKind::Real:
+        {
+            const double real = value.to<double>();
+            return detail::hashScalar(seed, real == 0.0 ? 0.0 : real); // -0 == 0
+        }
+        case ValueKind::String:
+        {
+            const String str = value.to<String>();
+            return detail::hashBytes(seed, str.data(), str.size());
+        }
+        case ValueKind::Enum:
+            return detail::hashScalar(seed, value.to<EnumObject>().value());
+        case ValueKind::User:
+            return hash(value.to<UserObject>());
+        default:
+            return seed;
+    }
+}
+
+namespace detail {
+
+class PatchBuilder
+{
+public:
+
+    PatchBuilder(Patch& patch) : m_patch(patch) {}
+
+    void diffObjects(const UserObject& from, const UserObject& to)
+    {
+        const Class& cls = to.getClass();
+        for (size_t nb = cls.propertyCount(), i = 0; i < nb; ++i)
+        {
+            const Property& prop = cls.property(i);
+            if (!prop.isReadable() || !prop.isWritable())
+                continue;
+
+            m_path.push_back(PatchStep{prop.name(), Value::nothing});
+            switch (prop.kind())
+            {
+                case ValueKind::Array:
+                    diffArray(static_cast<const ArrayProperty&>(prop), from, to);
+                    break;
+                case ValueKind::Map:
+                    diffMap(static_cast<const MapProperty&>(prop), from, to);
+                    break;
+                default:
+                    diffValues(prop.get(from), prop.get(to));
+                    break;
+            }
+            m_path.pop_back();
+        }
+    }
+
+private:
+
+    // Record the difference of two values at the current path
+    void diffValues(const Value& from, const Value& to)
+    {
+        if (from.kind() == ValueKind::User && to.kind() == ValueKind::User)
+        {
+            const UserObject fromObject = from.to<UserObject>();
+            const UserObject toObject = to.to<UserObject>();
+            if (fromObject.pointer() != nullptr && toObject.pointer() != nullptr
+                && fromObject.getClass() == toObject.getClass())
+            {
+                diffObjects(fromObject, toObject);
+                return;
+            }
+        }
+
+        if (!m_comparator.equal(from, to))
+            add(PatchOp::Kind::Set, to);
+    }
+
+    void diffArray(const ArrayProperty& array, const UserObject& from, const UserObject& to)
+    {
+        // Walk each array once: indexed access is linear for some containers (e.g. std::list)
+        const std::vector<Value> fromItems = elements(array, from);
+        const std::vector<Value> toItems = elements(array, to);
+        const size_t fromSize = fromItems.size();
+        const size_t toSize = toItems.size();
+
+        // Skip the common head and, for dynamic arrays, the common tail so that elements
+        // inserted or removed in the middle don't show as a change of all the following ones
+        size_t head = 0;
+        const size_t common = std::min(fromSize, toSize);
+        while (head < common && m_comparator.equal(fromItems[head], toItems[head]))
+            ++head;
+        size_t tail = 0;
+        if (array.dynamic())
+        {
+            while (tail < common - head
+                   && m_comparator.equal(fromItems[fromSize - 1 - tail], toItems[toSize - 1 - tail]))
+                ++tail;
+        }
+
+        const size_t fromEnd = fromSize - tail, toEnd = toSize - tail;
+        const size_t overlap = head + std::min(fromEnd - head, toEnd - head);
+        for (size_t i = head; i < overlap; ++i)
+        {
+            m_path.back().key = i;
+            diffValues(fromItems[i], toItems[i]);
+        }
+        if (overlap < toEnd)
+        {
+            // Inserted elements are copied, as the patch may outlive the array
+            ArrayCursor it = array.cursor(to);
+            while (it.index() < overlap)
+                it.next();
+            for (; it.index() < toEnd; it.next())
+            {
+                m_path.back().key = it.index();
+                add(PatchOp::Kind::Insert, it.get());
+            }
+        }
+        for (size_t i = fromEnd; i > overlap; --i)
+        {
+            m_path.back().key = i - 1;
+            add(PatchOp::Kind::Remove, Value::nothing);
+        }
+        m_path.back().key = Value::nothing;
+    }
+
+    // Get the elements of an array, user objects referring to the elements instead of copies
+    static std::vector<Value> elements(const ArrayProperty& array, const UserObject& object)
+    {
+        std::vector<Value> items;
+        ArrayCursor it = array.cursor(object);
+        items.reserve(it.size());
+        const bool user = array.elementType() == ValueKind::User;
+        for (; it.valid(); it.next())
+            items.push_back(user ? Value(it.getObject()) : it.get());
+        return items;
+    }
+
+    void diffMap(const MapProperty& map, const UserObject& from, const UserObject& to)
+    {
+        for (auto it = map.cursor(from); it.valid(); it.next())
+        {
+            if (const Value key = it.key(); !map.contains(to, key))
+            {
+                m_path.back().key = key;
+                add(PatchOp::Kind::Remove, Value::nothing);
+            }
+        }
+        for (auto it = map.cursor(to); it.valid(); it.next())
+        {
+            m_path.back().key = it.key();
+            if (map.contains(from, m_path.back().key))
+                diffValues(map.get(from, m_path.back().key), it.value());
+            else
+                add(PatchOp::Kind::Set, it.value());
+        }
+        m_path.back().key = Value::nothing;
+    }
+
+    void add(PatchOp::Kind kind, const Value& value)
+    {
+        m_patch.push_back(PatchOp{kind, m_path, value});
+    }
+
+    Patch& m_patch;
+    std::vector<PatchStep> m_path;
+    ObjectComparator m_comparator;
+};
+
+inline void applyPatchOp(const UserObject& object, const PatchOp& op, size_t depth)
+{
+    const PatchStep& step = op.path[depth];
+    const Property& prop = object.getClass().property(step.property);
+    const bool element = step.key.kind() != ValueKind::None;
+
+    if (depth + 1 < op.path.size())
+    {
+        // Walk down to the composed object, and write it back in case it is a copy
+        if (!element)
+        {
+            Value child = prop.get(object);
+            applyPatchOp(child.to<UserObject>(), op, depth + 1);
+            prop.set(object, child);
+        }
+        else if (prop.kind() == ValueKind::Array)
+        {
+            const auto& array = static_cast<const ArrayProperty&>(prop);
+            const size_t index = step.key.to<size_t>();
+            Value child = array.get(object, index);
+            applyPatchOp(child.to<UserObject>(), op, depth + 1);
+            array.set(object, index, child);
+        }
+        else
+        {
+            const auto& map = static_cast<const MapProperty&>(prop);
+            Value child = map.get(object, step.key);
+            applyPatchOp(child.to<UserObject>(), op, depth + 1);
+            map.set(object, step.key, child);
+        }
+        return;
+    }
+
+    if (!element)
+    {
+        prop.set(object, op.value);
+    }
+    else if (prop.kind() == ValueKind::Array)
+    {
+        const auto& array = static_cast<const ArrayProperty&>(prop);
+        const size_t index = step.key.to<size_t>();
+        switch (op.kind)
+        {
+            case PatchOp::Kind::Set: array.set(object, index, op.value); break;
+            case PatchOp::Kind::Insert: array.insert(object, index, op.value); break;
+            case PatchOp::Kind::Remove: array.remove(object, index); break;
+        }
+    }
+    else
+    {
+        const auto& map = static_cast<const MapProperty&>(prop);
+        if (op.kind == PatchOp::Kind::Remove)
+            map.erase(object, step.key);
+        else
+            map.set(object, step.key, op.value);
+    }
+}
+
+} // namespace detail
+
+Patch diff(const UserObject &from, const UserObject &to)
+{
+    if (from.getClass() != to.getClass())
+        PONDER_ERROR(ClassUnrelated(from.getClass().name(), to.getClass().name()));
+
+    Patch patch;
+    detail::PatchBuilder(patch).diffObjects(from, to);
+    return patch;
+}
+
 } // runtime
 } // ponder
 
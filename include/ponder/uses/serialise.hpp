@@ -31,8 +31,197 @@
 #ifndef PONDER_USES_SERIALISE_HPP
 #define PONDER_USES_SERIALISE_HPP
 
+#include <ponder/uses/patch.hpp>
+#include <ponder/uses/detail/workerpool.hpp>
+#include <ponder/detail/enummanager.hpp>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace ponder {
 namespace archive {
+namespace detail {
+
+// Does the archive ArrayIterator I know its number of items?
+template <typename I, typename = void>
+struct HasArraySize : std::false_type {};
+
+template <typename I>
+struct HasArraySize<I, std::void_t<decltype(std::declval<const I&>().size())>> : std::true_type {};
+
+// Can the archive A write array items apart, in fragments? Fragments are not split again.
+template <typename A, typename = void>
+struct HasFragment : std::false_type {};
+
+template <typename A>
+struct HasFragment<A, std::void_t<decltype(std::declval<A&>().appendFragment(
+    std::declval<typename A::Node>(), std::declval<const typename A::Fragment&>()))>>
+    : std::bool_constant<!std::is_same_v<A, typename A::Fragment>> {};
+
+// Can the archive A write arrays of numbers in one block?
+template <typename A, typename = void>
+struct HasWriteArray : std::false_type {};
+
+template <typename A>
+struct HasWriteArray<A, std::void_t<decltype(std::declval<A&>().writeArray(
+    std::declval<typename A::Node>(), std::declval<const std::string&>(),
+    std::declval<const double*>(), size_t()))>> : std::true_type {};
+
+// Can the archive A read arrays of numbers in one block?
+template <typename A, typename = void>
+struct HasReadArray : std::false_type {};
+
+template <typename A>
+struct HasReadArray<A, std::void_t<decltype(std::declval<A&>().readArray(
+    std::declval<typename A::Node>(), std::declval<std::vector<double>&>()))>> : std::true_type {};
+
+// Can the archive A iterate over the members of a node?
+template <typename A, typename = void>
+struct HasMemberIterator : std::false_type {};
+
+template <typename A>
+struct HasMemberIterator<A, std::void_t<decltype(std::declval<A&>().createMemberIterator(
+    std::declval<typename A::Node>()))>> : std::true_type {};
+
+/*
+ * Serialisation plan of a class: what the archive readers and writers need to know about
+ * each property, collected once per class so that objects are walked without looking up
+ * the metaclass again or building property names.
+ */
+struct SerialisedProperty
+{
+    const Property* property;
+    ValueKind kind;         // Kind of the property
+    ValueKind elementKind;  // Kind of the array elements or map values
+    std::string name;       // Name of the property, as given to the archive
+};
+
+struct SerialisePlan
+{
+    std::vector<SerialisedProperty> properties;
+    std::unordered_map<string_view, size_t> index; // Properties by name
+};
+
+class SerialisePlans
+{
+public:
+
+    const SerialisePlan& get(const Class& cls)
+    {
+        // Objects are often written in runs of the same class
+        if (&cls == m_lastClass)
+            return *m_lastPlan;
+
+        auto it = m_plans.find(&cls);
+        if (it == m_plans.end())
+        {
+            it = m_plans.emplace(&cls, SerialisePlan()).first;
+            build(cls, it->second); // in place, as the index refers to the names
+        }
+
+        m_lastClass = &cls;
+        m_lastPlan = &it->second;
+        return it->second;
+    }
+
+private:
+
+    static void build(const Class& cls, SerialisePlan& plan);
+
+    std::unordered_map<const Class*, SerialisePlan> m_plans;
+    const Class* m_lastClass = nullptr;
+    const SerialisePlan* m_lastPlan = nullptr;
+};
+
+// Names of the nodes of array and map items
+struct ItemNames
+{
+    const std::string item{"item"};
+    const std::string key{"key"};
+    const std::string value{"value"};
+};
+
+// Enum values written with EnumFormat::NameId, numbered in order of first use. The writers
+// of the fragments of an array share the table of their parent writer.
+class EnumNameTable
+{
+public:
+
+    using Entry = std::pair<const Enum*, long>;
+
+    size_t id(const EnumObject& value)
+    {
+        const Entry entry{&value.getEnum(), value.value()};
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_ids.emplace(entry, m_entries.size()).first;
+        if (it->second == m_entries.size())
+            m_entries.push_back(entry);
+        return it->second;
+    }
+
+    const std::vector<Entry>& entries() const {return m_entries;}
+
+private:
+
+    struct EntryHash
+    {
+        size_t operator () (const Entry& entry) const
+        {
+            return std::hash<const Enum*>()(entry.first) ^ (std::hash<long>()(entry.second) * 31);
+        }
+    };
+
+    std::mutex m_mutex;
+    std::unordered_map<Entry, size_t, EntryHash> m_ids;
+    std::vector<Entry> m_entries;
+};
+
+} // namespace detail
+
+/**
+ * \brief Options for reading and writing large arrays of objects on several threads
+ *
+ * The items of an array of user objects with at least minItems elements are split in
+ * chunks, which are read or written by a pool of threads. Written chunks go to separate
+ * fragments of the archive which are then appended in order, so the archive is the same
+ * as one written on a single thread, save for the ids the binary archive gives to names
+ * first seen by another thread.
+ *
+ * The metaclasses and metaenums reachable from the properties of the items are looked
+ * up by the calling thread first, which registers the types declared with
+ * PONDER_AUTO_TYPE(). Types which are only known at runtime, like the derived classes of
+ * the items, must be registered beforehand. The items read by the other threads are set
+ * into the array by the calling thread. Ponder is not thread-safe otherwise: while
+ * objects are read or written on several threads, the metaclasses must not be changed,
+ * and the property observers may be called from any of the threads for the properties
+ * of the items.
+ */
+struct Parallelism
+{
+    unsigned threads = 1;   //!< Number of threads, including the calling one
+    size_t minItems = 4096; //!< Number of items from which an array is split
+};
+
+/**
+ * \brief How ArchiveWriter writes the values of enums
+ *
+ * Names are the most readable form, and resist changes of the values of an enum, but cost
+ * a search of the name and a string per value. Values and ids are written as integers.
+ *
+ * ArchiveReader accepts all three forms: a string is read as a name, and a number as an
+ * id if a table of names was read with ArchiveReader::readEnumNames(), as a value otherwise.
+ */
+enum class EnumFormat
+{
+    Name,   //!< Name of the value (default)
+    Value,  //!< Integer value
+    NameId, //!< Index of the name in the table written by ArchiveWriter::writeEnumNames()
+};
     
 /**
  For writing archive requires the following concepts:
@@ -46,7 +235,28 @@ namespace archive {
         NodeType endArray(NodeType parent, NodeType arrayNode);
         void setProperty(NodeType node, const std::string& name, const std::string& value);
     };
+
+ Optionally, for writing arrays of numbers (integer and real elements) in one block:
+
+    class Archive
+    {
+    public:
+        // T is any arithmetic type but bool
+        template <typename T>
+        void writeArray(NodeType parent, const std::string& name, const T* values, size_t count);
+    };
+
+ Optionally, for writing arrays on several threads:
+
+    class Archive
+    {
+    public:
+        class Fragment; // Archive constructed from Fragment(Archive&) with a root() array
+        void appendFragment(NodeType arrayNode, const Fragment& fragment);
+    };
  
+ The properties of each class are collected in a plan the first time the class is
+ written, and the plan is kept by the writer: reuse one writer for many objects.
  */
 template <class ARCHIVE>
 class ArchiveWriter
@@ -56,15 +266,70 @@ public:
     using ArchiveType = ARCHIVE;
     using NodeType = typename ArchiveType::Node;
     
-    ArchiveWriter(ArchiveType& archive)
+    ArchiveWriter(ArchiveType& archive, const Parallelism& parallelism = Parallelism())
     :   m_archive(archive)
-    {}
+    ,   m_parallelism(parallelism)
+    {
+        if (m_parallelism.threads > 1 && detail::HasFragment<ArchiveType>::value)
+            m_pool = std::make_unique<detail::WorkerPool>(m_parallelism.threads);
+    }
     
     void write(NodeType parent, const UserObject& object);
+
+    /**
+     * \brief Write a patch, as returned by runtime::diff()
+     *
+     * The operations are written in order in an array named "patch". Each one has an
+     * "op" ("set", "insert" or "remove"), a "path" array of steps with a "property" name
+     * and an optional "key", and a "value" for set and insert.
+     *
+     * \param parent Node to write the patch into
+     * \param patch Patch to write
+     */
+    void write(NodeType parent, const runtime::Patch& patch);
+
+    /**
+     * \brief Set how the values of enums are written
+     *
+     * \param format Format of the enum values written from now on
+     */
+    void setEnumFormat(EnumFormat format);
+
+    /**
+     * \brief Write the table of the enum names written as ids
+     *
+     * The table is an array of the names of the enum values given an id, in order of id.
+     * Each item has the name of its metaenum ("enum") and the name of the value ("name").
+     * Write it once the objects are written, and read it back with
+     * ArchiveReader::readEnumNames() before reading them.
+     *
+     * \param parent Node to write the table into
+     * \param name Name of the table node
+     */
+    void writeEnumNames(NodeType parent, const std::string& name = "enums");
     
 private:
+
+    template <class> friend class ArchiveWriter;
+
+    // Write a value which isn't a user object, in the chosen enum format
+    void setValue(NodeType node, const std::string& name, const Value& value);
+
+    // Write an array of numbers in one block
+    void writeNumbers(NodeType parent, const detail::SerialisedProperty& entry,
+                      const ArrayProperty& property, const UserObject& object);
+
+    // Write the items of an array of user objects on the threads of the pool
+    void writeItems(NodeType arrayNode, const ArrayProperty& property, const UserObject& object,
+                    size_t count);
     
     ArchiveType& m_archive;
+    const Parallelism m_parallelism;
+    std::unique_ptr<detail::WorkerPool> m_pool;
+    detail::SerialisePlans m_plans;
+    const detail::ItemNames m_names;
+    EnumFormat m_enumFormat = EnumFormat::Name;
+    std::shared_ptr<detail::EnumNameTable> m_enumNames;
 };
 
 /**
@@ -78,8 +343,68 @@ private:
      std::string getValue(NodeType node);
      bool isValid(NodeType node);
  };
+
+ class ArrayIterator
+ {
+ public:
+     bool isEnd() const;
+     void next();
+     NodeType getItem();
+     size_t size() const; // optional: number of items, used to size arrays once
+ };
+
+ Optionally, for reading arrays of numbers written with writeArray():
+
+ class Archive
+ {
+ public:
+     // Return false if the node is not an array of numbers, to read it item by item
+     template <typename T>
+     bool readArray(NodeType node, std::vector<T>& values);
+ };
+
+ Optionally, for ReadMode::SinglePass:
+
+ class Archive
+ {
+ public:
+     MemberIterator createMemberIterator(NodeType node);
+ };
+
+ class MemberIterator
+ {
+ public:
+     bool isEnd() const;
+     void next();
+     string_view name() const;
+     NodeType getItem();
+ };
  
+ As for ArchiveWriter, the plans of the classes read are kept by the reader. With
+ Parallelism, the archive is read by several threads at once: reading must not modify it.
+ */
+/**
+ * \brief How ArchiveReader matches the properties of an object with the archive
  */
+enum class ReadMode
+{
+    /**
+     * Look up each property of the class in the archive node. This costs a search of
+     * the node per property.
+     */
+    FindProperty,
+
+    /**
+     * Walk the members of the archive node once, and dispatch each one to the property
+     * of the same name through a hashed index. Members which don't match a property are
+     * skipped. Archives which can't iterate over members fall back to FindProperty.
+     */
+    SinglePass,
+};
+
+template <class ARCHIVE>
+class ObjectGenerator;
+
 template <class ARCHIVE>
 class ArchiveReader
 {
@@ -89,15 +414,181 @@ public:
     using NodeType = typename ArchiveType::Node;
     using ArrayIterator = typename ArchiveType::ArrayIterator;
 
-    ArchiveReader(ArchiveType& archive)
+    ArchiveReader(ArchiveType& archive, ReadMode mode = ReadMode::FindProperty,
+                  const Parallelism& parallelism = Parallelism())
     :   m_archive(archive)
-    {}
+    ,   m_mode(mode)
+    ,   m_parallelism(parallelism)
+    {
+        if (m_parallelism.threads > 1)
+            m_pool = std::make_unique<detail::WorkerPool>(m_parallelism.threads);
+    }
     
     void read(NodeType node, const UserObject& object);
+
+    /**
+     * \brief Read the table of enum names written by ArchiveWriter::writeEnumNames()
+     *
+     * From then on, unless the table is empty, enum values written as numbers are read as ids
+     * in the table. The names of metaenums which aren't declared are kept, and converted when
+     * read.
+     *
+     * \param node Node the table was written into
+     * \param name Name of the table node
+     *
+     * \return True if the node has a table
+     */
+    bool readEnumNames(NodeType node, const std::string& name = "enums");
+
+    /**
+     * \brief Read the objects of an array one at a time
+     *
+     * Rather than reading the whole array into an array property, the items are read on
+     * demand by the returned generator, so that each object can be handled and discarded
+     * before the next one is read.
+     *
+     * \param arrayNode Array node, as found with the archive's findProperty()
+     * \param cls Metaclass of the items, which must be default constructible
+     * \param reuse Read all the items into the same instance, reset between items
+     *
+     * \return Generator of the objects, which must not outlive the reader
+     *
+     * \sa ObjectGenerator
+     */
+    ObjectGenerator<ARCHIVE> readObjects(NodeType arrayNode, const Class& cls, bool reuse = false);
     
 private:
+
+    // Get the value of a node, converting enum ids to their value
+    Value getValue(NodeType node, ValueKind kind);
+
+    void readProperty(const detail::SerialisedProperty& entry, NodeType child,
+                      const UserObject& object);
+
+    // Read an array of numbers in one block, return false if the archive has no block
+    bool readNumbers(const detail::SerialisedProperty& entry, NodeType node,
+                     const ArrayProperty& property, const UserObject& object);
+
+    // Read the items of an array of user objects on the threads of the pool
+    void readItems(const std::vector<NodeType>& items, const ArrayProperty& property,
+                   const UserObject& object);
     
     ArchiveType& m_archive;
+    const ReadMode m_mode;
+    const Parallelism m_parallelism;
+    std::unique_ptr<detail::WorkerPool> m_pool;
+    detail::SerialisePlans m_plans;
+    const detail::ItemNames m_names;
+    std::shared_ptr<const std::vector<Value>> m_enumIds; // Values of the enum ids, if any
+};
+
+/**
+ * \brief Generator of the objects of an archive array, read one at a time
+ *
+ * Created by ArchiveReader::readObjects(). Each call to next() reads the following item
+ * of the array into a default constructed instance of the class, so that only one object
+ * is in memory at a time however long the array is:
+ *
+ * \code
+ * auto objects = reader.readObjects(archive.findProperty(root, "bodies"), ponder::classByType<Body>());
+ * while (objects.next())
+ *     simulate(objects.current().get<Body>());
+ *
+ * // or
+ * for (const ponder::UserObject& body : reader.readObjects(node, cls, true))
+ *     simulate(body.get<Body>());
+ * \endcode
+ *
+ * Without reuse, current() owns a new instance for each item, which can be kept by copying
+ * the UserObject. With reuse, the same instance is move assigned a default constructed one
+ * before each item is read, so that it keeps no array elements or map entries of the
+ * previous item; classes which aren't move assignable get a new instance instead.
+ *
+ * The items are read on the calling thread, whatever the Parallelism of the reader.
+ */
+template <class ARCHIVE>
+class ObjectGenerator
+{
+public:
+
+    using ReaderType = ArchiveReader<ARCHIVE>;
+    using ArrayIterator = typename ReaderType::ArrayIterator;
+
+    //! Input iterator over the remaining items, for range-based for loops
+    class iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = UserObject;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const UserObject*;
+        using reference = const UserObject&;
+
+        iterator() = default;
+        explicit iterator(ObjectGenerator* generator) : m_generator(generator) {}
+
+        reference operator*() const {return m_generator->current();}
+        pointer operator->() const {return &m_generator->current();}
+        iterator& operator++()
+        {
+            if (!m_generator->next())
+                m_generator = nullptr;
+            return *this;
+        }
+        bool operator==(const iterator& other) const {return m_generator == other.m_generator;}
+        bool operator!=(const iterator& other) const {return m_generator != other.m_generator;}
+
+    private:
+        ObjectGenerator* m_generator = nullptr;
+    };
+
+    ObjectGenerator(const ObjectGenerator&) = delete;
+    ObjectGenerator& operator=(const ObjectGenerator&) = delete;
+    ObjectGenerator(ObjectGenerator&&) = default;
+
+    /**
+     * \brief Read the next item of the array
+     *
+     * \return False once all the items have been read
+     *
+     * \throw NullObject the class of the items is not default constructible
+     */
+    bool next();
+
+    /**
+     * \brief Get the object read by the last call to next()
+     *
+     * \return The object, or UserObject::nothing before the first item and after the last
+     */
+    const UserObject& current() const {return m_object;}
+
+    /**
+     * \brief Get the number of items read so far
+     */
+    size_t count() const {return m_count;}
+
+    //! Read the next item and iterate from it
+    iterator begin() {return next() ? iterator(this) : iterator();}
+    iterator end() {return iterator();}
+
+private:
+
+    friend class ArchiveReader<ARCHIVE>;
+
+    ObjectGenerator(ReaderType& reader, ArrayIterator it, const Class& cls, bool reuse)
+    :   m_reader(reader)
+    ,   m_it(std::move(it))
+    ,   m_class(cls)
+    ,   m_reuse(reuse)
+    {}
+
+    ReaderType& m_reader;
+    ArrayIterator m_it;
+    const Class& m_class;
+    const bool m_reuse;
+    UserObject m_object;    // Object of the current item
+    size_t m_count = 0;     // Number of items read
+    bool m_end = false;     // All the items have been read
 };
 
 } // namespace archive
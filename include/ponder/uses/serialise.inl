@@ -28,53 +28,160 @@
 ****************************************************************************/
 
 #include "ponder/arrayproperty.hpp"
+#include "ponder/mapproperty.hpp"
+#include "ponder/userproperty.hpp"
+#include <unordered_set>
 
 namespace ponder {
 namespace archive {
 
+namespace detail {
+
+inline void SerialisePlans::build(const Class& cls, SerialisePlan& plan)
+{
+    plan.properties.reserve(cls.propertyCount());
+    for (size_t i = 0; i < cls.propertyCount(); ++i)
+    {
+        const Property& property = cls.property(i);
+
+        ValueKind elementKind = ValueKind::None;
+        if (property.kind() == ValueKind::Array)
+            elementKind = static_cast<const ArrayProperty&>(property).elementType();
+        else if (property.kind() == ValueKind::Map)
+            elementKind = static_cast<const MapProperty&>(property).mappedType();
+
+        plan.properties.push_back(SerialisedProperty{&property, property.kind(), elementKind,
+                                                     std::string(property.name())});
+    }
+
+    for (size_t i = 0; i < plan.properties.size(); ++i)
+        plan.index.emplace(plan.properties[i].name, i);
+}
+
+// Look up the metaclasses and metaenums of the properties reachable from a class, so that
+// the types declared with PONDER_AUTO_TYPE() are registered before other threads use them
+inline void registerTypes(const Class& cls, std::unordered_set<const Class*>& visited)
+{
+    if (!visited.insert(&cls).second)
+        return;
+
+    for (size_t i = 0; i < cls.propertyCount(); ++i)
+    {
+        const Property& property = cls.property(i);
+
+        const Class* child = nullptr;
+        if (property.kind() == ValueKind::User)
+        {
+            child = &static_cast<const UserProperty&>(property).getClass();
+        }
+        else if (property.kind() == ValueKind::Array)
+        {
+            const auto& arrayProperty = static_cast<const ArrayProperty&>(property);
+            child = arrayProperty.elementClass();
+            (void)arrayProperty.elementEnum();
+        }
+        else if (property.kind() == ValueKind::Map)
+        {
+            const auto& mapProperty = static_cast<const MapProperty&>(property);
+            child = mapProperty.mappedClass();
+            (void)mapProperty.mappedEnum();
+        }
+
+        if (child != nullptr)
+            registerTypes(*child, visited);
+    }
+}
+
+inline void registerTypes(const Class& cls)
+{
+    std::unordered_set<const Class*> visited;
+    registerTypes(cls, visited);
+}
+
+// Call f with a null T* if the elements of the array are numbers stored contiguously as T
+template <typename... Ts, typename F>
+bool visitData(const ArrayProperty& property, F& f)
+{
+    return ((property.isContiguousOf<Ts>() && (f(static_cast<Ts*>(nullptr)), true)) || ...);
+}
+
+template <typename F>
+bool visitNumberData(const ArrayProperty& property, F&& f)
+{
+    return visitData<char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+                     long, unsigned long, long long, unsigned long long, float, double>(property, f);
+}
+
+} // namespace detail
+
 template <class ARCHIVE>
 void ArchiveWriter<ARCHIVE>::write(NodeType parent, const UserObject& object)
 {
-    const Class& metaclass = object.getClass();
-    for (size_t i = 0; i < metaclass.propertyCount(); ++i)
+    for (auto&& entry : m_plans.get(object.getClass()).properties)
     {
-        const Property& property = metaclass.property(i);
+        const Property& property = *entry.property;
 
         // If the property has the exclude tag, ignore it
         //                if ((exclude != Value::nothing) && property.hasTag(exclude))
         //                    continue;
 
-        auto kind = property.kind();
-        if (kind == ValueKind::None)
+        if (entry.kind == ValueKind::User || entry.kind == ValueKind::None)
         {
-            kind = property.get(object).kind();
-        }
-
-        if (kind == ValueKind::User)
-        {
-            NodeType child = m_archive.beginChild(parent, property.name());
+            // The kind of a None property is the kind of its current value
+            const Value value = property.get(object);
+            if (value.kind() == ValueKind::User)
+            {
+                NodeType child = m_archive.beginChild(parent, entry.name);
 
-            // recurse
-            write(child, property.get(object).to<UserObject>());
+                // recurse
+                write(child, value.to<UserObject>());
 
-            m_archive.endChild(parent, child);
+                m_archive.endChild(parent, child);
+            }
+            else
+            {
+                setValue(parent, entry.name, value);
+            }
         }
-        else if (kind == ValueKind::Array)
+        else if (entry.kind == ValueKind::Array)
         {
             auto const& arrayProperty = static_cast<const ArrayProperty&>(property);
 
-            NodeType arrayNode = m_archive.beginArray(parent, property.name());
+            if constexpr (detail::HasWriteArray<ArchiveType>::value)
+            {
+                // Arrays of numbers are handed to the archive in one block
+                if (entry.elementKind == ValueKind::Integer || entry.elementKind == ValueKind::Real)
+                {
+                    writeNumbers(parent, entry, arrayProperty, object);
+                    continue;
+                }
+            }
+
+            NodeType arrayNode = m_archive.beginArray(parent, entry.name);
+
+            if constexpr (detail::HasFragment<ArchiveType>::value)
+            {
+                // Large arrays of objects are written on the threads of the pool
+                if (m_pool && entry.elementKind == ValueKind::User)
+                {
+                    if (const size_t count = arrayProperty.size(object);
+                        count >= std::max<size_t>(m_parallelism.minItems, 2))
+                    {
+                        writeItems(arrayNode, arrayProperty, object, count);
+                        m_archive.endArray(parent, arrayNode);
+                        continue;
+                    }
+                }
+            }
 
             // Iterate over the array elements
-            const size_t count = arrayProperty.size(object);
-            const std::string itemName("item");
-            for (size_t j = 0; j < count; ++j)
+            for (ArrayCursor it = arrayProperty.cursor(object); it.valid(); it.next())
             {
-                if (arrayProperty.elementType() == ValueKind::User)
+                if (entry.elementKind == ValueKind::User)
                 {
-                    const UserObject& arrayItem = arrayProperty.get(object, j).to<UserObject>();
+                    const UserObject arrayItem = it.getObject();
 
-                    NodeType child = m_archive.beginChild(arrayNode, itemName);
+                    NodeType child = m_archive.beginChild(arrayNode, m_names.item);
 
                     write(child, arrayItem);
 
@@ -82,92 +189,544 @@ void ArchiveWriter<ARCHIVE>::write(NodeType parent, const UserObject& object)
                 }
                 else
                 {
-                    m_archive.setProperty(arrayNode, itemName, arrayProperty.get(object, j));
+                    setValue(arrayNode, m_names.item, it.get());
                 }
             }
 
             m_archive.endArray(parent, arrayNode);
         }
+        else if (entry.kind == ValueKind::Map)
+        {
+            auto const& mapProperty = static_cast<const MapProperty&>(property);
+
+            NodeType mapNode = m_archive.beginArray(parent, entry.name);
+
+            // Iterate over the map entries, each one written as a key/value pair
+            for (MapCursor it = mapProperty.cursor(object); it.valid(); it.next())
+            {
+                NodeType child = m_archive.beginChild(mapNode, m_names.item);
+
+                setValue(child, m_names.key, it.key());
+
+                if (entry.elementKind == ValueKind::User)
+                {
+                    NodeType valueNode = m_archive.beginChild(child, m_names.value);
+
+                    write(valueNode, it.value().to<UserObject>());
+
+                    m_archive.endChild(child, valueNode);
+                }
+                else
+                {
+                    setValue(child, m_names.value, it.value());
+                }
+
+                m_archive.endChild(mapNode, child);
+            }
+
+            m_archive.endArray(parent, mapNode);
+        }
         else
         {
-            m_archive.setProperty(parent, property.name(), property.get(object));
+            setValue(parent, entry.name, property.get(object));
+        }
+    }
+}
+
+template <class ARCHIVE>
+void ArchiveWriter<ARCHIVE>::setValue(NodeType node, const std::string& name, const Value& value)
+{
+    if (value.kind() == ValueKind::Enum && m_enumFormat != EnumFormat::Name)
+    {
+        const EnumObject& enumObject = value.cref<EnumObject>();
+        const long number = m_enumFormat == EnumFormat::Value
+            ? enumObject.value()
+            : static_cast<long>(m_enumNames->id(enumObject));
+        m_archive.setProperty(node, name, Value(number));
+        return;
+    }
+
+    m_archive.setProperty(node, name, value);
+}
+
+template <class ARCHIVE>
+void ArchiveWriter<ARCHIVE>::setEnumFormat(EnumFormat format)
+{
+    m_enumFormat = format;
+    if (format == EnumFormat::NameId && !m_enumNames)
+        m_enumNames = std::make_shared<detail::EnumNameTable>();
+}
+
+template <class ARCHIVE>
+void ArchiveWriter<ARCHIVE>::writeEnumNames(NodeType parent, const std::string& name)
+{
+    const std::string enumName("enum"), valueName("name");
+
+    NodeType tableNode = m_archive.beginArray(parent, name);
+    if (m_enumNames)
+    {
+        for (auto&& entry : m_enumNames->entries())
+        {
+            NodeType itemNode = m_archive.beginChild(tableNode, m_names.item);
+            m_archive.setProperty(itemNode, enumName, String(entry.first->name()));
+            m_archive.setProperty(itemNode, valueName, String(entry.first->name(entry.second)));
+            m_archive.endChild(tableNode, itemNode);
+        }
+    }
+    m_archive.endArray(parent, tableNode);
+}
+
+template <class ARCHIVE>
+void ArchiveWriter<ARCHIVE>::writeNumbers(NodeType parent, const detail::SerialisedProperty& entry,
+                                          const ArrayProperty& property, const UserObject& object)
+{
+    if (!property.isReadable())
+        PONDER_ERROR(ForbiddenRead(property.name()));
+
+    // Contiguous arrays are written in place, others are copied as the widest type
+    const bool contiguous = detail::visitNumberData(property, [&](auto* type)
+    {
+        using T = std::remove_pointer_t<decltype(type)>;
+        const ArraySpan<const T> values = property.span<const T>(object);
+        m_archive.writeArray(parent, entry.name, values.begin(), values.size());
+    });
+    if (contiguous)
+        return;
+
+    if (entry.elementKind == ValueKind::Integer)
+    {
+        std::vector<long long> values;
+        property.getElements(object, values);
+        m_archive.writeArray(parent, entry.name, values.data(), values.size());
+    }
+    else
+    {
+        std::vector<double> values;
+        property.getElements(object, values);
+        m_archive.writeArray(parent, entry.name, values.data(), values.size());
+    }
+}
+
+template <class ARCHIVE>
+void ArchiveWriter<ARCHIVE>::writeItems(NodeType arrayNode, const ArrayProperty& property,
+                                        const UserObject& object, size_t count)
+{
+    using Fragment = typename ArchiveType::Fragment;
+
+    if (const Class* cls = property.elementClass())
+        detail::registerTypes(*cls);
+
+    // Write the first item here, the other threads append their fragments after it
+    const ArrayCursor first = property.cursor(object);
+    NodeType child = m_archive.beginChild(arrayNode, m_names.item);
+    write(child, first.getObject());
+    m_archive.endChild(arrayNode, child);
+
+    // Split the other items in a few chunks per thread, to balance the load
+    const size_t chunks = std::min(count - 1, m_pool->size() * 4);
+    std::vector<std::unique_ptr<Fragment>> fragments;
+    fragments.reserve(chunks);
+    for (size_t i = 0; i < chunks; ++i)
+        fragments.push_back(std::make_unique<Fragment>(m_archive));
+
+    m_pool->run(chunks, [&](size_t chunk)
+    {
+        const size_t begin = 1 + (count - 1) * chunk / chunks;
+        const size_t end = 1 + (count - 1) * (chunk + 1) / chunks;
+
+        Fragment& fragment = *fragments[chunk];
+        ArchiveWriter<Fragment> writer(fragment);
+        writer.m_enumFormat = m_enumFormat;
+        writer.m_enumNames = m_enumNames;
+        ArrayCursor it = property.cursor(object);
+        for (size_t index = 0; index < begin && it.valid(); ++index)
+            it.next();
+        for (size_t index = begin; index < end && it.valid(); ++index, it.next())
+        {
+            auto itemNode = fragment.beginChild(fragment.root(), m_names.item);
+            writer.write(itemNode, it.getObject());
+            fragment.endChild(fragment.root(), itemNode);
+        }
+    });
+
+    for (auto&& fragment : fragments)
+        m_archive.appendFragment(arrayNode, *fragment);
+}
+
+template <class ARCHIVE>
+void ArchiveWriter<ARCHIVE>::write(NodeType parent, const runtime::Patch& patch)
+{
+    static const char* const c_opNames[] = {"set", "insert", "remove"};
+    const std::string opName("op"), pathName("path"), propertyName("property");
+
+    NodeType patchNode = m_archive.beginArray(parent, "patch");
+    for (auto&& op : patch)
+    {
+        NodeType opNode = m_archive.beginChild(patchNode, m_names.item);
+
+        m_archive.setProperty(opNode, opName, c_opNames[static_cast<int>(op.kind)]);
+
+        NodeType pathNode = m_archive.beginArray(opNode, pathName);
+        for (auto&& step : op.path)
+        {
+            NodeType stepNode = m_archive.beginChild(pathNode, m_names.item);
+            m_archive.setProperty(stepNode, propertyName, step.property);
+            if (step.key.kind() != ValueKind::None)
+                m_archive.setProperty(stepNode, m_names.key, step.key);
+            m_archive.endChild(pathNode, stepNode);
+        }
+        m_archive.endArray(opNode, pathNode);
+
+        if (op.value.kind() == ValueKind::User)
+        {
+            NodeType valueNode = m_archive.beginChild(opNode, m_names.value);
+            write(valueNode, op.value.to<UserObject>());
+            m_archive.endChild(opNode, valueNode);
+        }
+        else if (op.kind != runtime::PatchOp::Kind::Remove)
+        {
+            m_archive.setProperty(opNode, m_names.value, op.value);
         }
+
+        m_archive.endChild(patchNode, opNode);
     }
+    m_archive.endArray(parent, patchNode);
 }
 
 template <class ARCHIVE>
 void ArchiveReader<ARCHIVE>::read(NodeType node, const UserObject& object)
 {
-    // Iterate over the object's properties using its metaclass
-    const Class& metaclass = object.getClass();
-    for (size_t i = 0; i < metaclass.propertyCount(); ++i)
+    const detail::SerialisePlan& plan = m_plans.get(object.getClass());
+
+    if constexpr (detail::HasMemberIterator<ArchiveType>::value)
     {
-        const Property& property = metaclass.property(i);
+        if (m_mode == ReadMode::SinglePass)
+        {
+            // Dispatch the members of the node to the properties they match. Archives
+            // written by ArchiveWriter have their members in plan order, so try the
+            // property following the last one matched before hashing the name.
+            size_t expected = 0;
+            for (auto it = m_archive.createMemberIterator(node); !it.isEnd(); it.next())
+            {
+                const string_view name = it.name();
+                size_t index = expected;
+                if (index >= plan.properties.size() || plan.properties[index].name != name)
+                {
+                    const auto found = plan.index.find(name);
+                    if (found == plan.index.end())
+                        continue;
+                    index = found->second;
+                }
+                readProperty(plan.properties[index], it.getItem(), object);
+                expected = index + 1;
+            }
+            return;
+        }
+    }
 
+    // Iterate over the object's properties using the plan of its metaclass
+    for (auto&& entry : plan.properties)
+    {
         // If the property has the exclude tag, ignore it
         //                if ((exclude != Value::nothing) && property.hasTag(exclude))
         //                    continue;
 
         // Find the child node corresponding to the new property
-        NodeType child = m_archive.findProperty(node, property.name());
-        if (!m_archive.isValid(child))
-            continue;
+        readProperty(entry, m_archive.findProperty(node, entry.name), object);
+    }
+}
 
-        if (property.kind() == ValueKind::User)
+template <class ARCHIVE>
+void ArchiveReader<ARCHIVE>::readProperty(const detail::SerialisedProperty& entry, NodeType child,
+                                          const UserObject& object)
+{
+    if (!m_archive.isValid(child))
+        return;
+
+    const Property& property = *entry.property;
+
+    if (entry.kind == ValueKind::User)
+    {
+        // The current property is a composed type: deserialize it recursively
+        auto v = property.get(object);
+        read(child, v.to<UserObject>());
+        property.set(object, v);
+    }
+    else if (entry.kind == ValueKind::None)
+    {
+        auto v = property.getForSerialization(object);
+        if (v.isCompatible<UserObject>())
         {
-            // The current property is a composed type: deserialize it recursively
-            auto v = property.get(object);
             read(child, v.to<UserObject>());
-            property.set(object, v);
         }
-        else if (property.kind() == ValueKind::None)
+        else
         {
-            auto v = property.getForSerialization(object);
-            if (v.isCompatible<UserObject>())
+            v = getValue(child, v.kind());
+        }
+        property.set(object, v);
+    }
+    else if (entry.kind == ValueKind::Array)
+    {
+        auto const& arrayProperty = static_cast<const ArrayProperty&>(property);
+
+        if constexpr (detail::HasReadArray<ArchiveType>::value)
+        {
+            if ((entry.elementKind == ValueKind::Integer || entry.elementKind == ValueKind::Real)
+                && readNumbers(entry, child, arrayProperty, object))
+                return;
+        }
+
+        if (m_pool && entry.elementKind == ValueKind::User)
+        {
+            // Large arrays of objects are read on the threads of the pool
+            std::vector<NodeType> items;
+            for (ArrayIterator it{ m_archive.createArrayIterator(child, m_names.item) }; !it.isEnd(); it.next())
+                items.push_back(it.getItem());
+            if (items.size() >= std::max<size_t>(m_parallelism.minItems, 2))
             {
-                read(child, v.to<UserObject>());
+                readItems(items, arrayProperty, object);
+                return;
             }
-            else
+        }
+
+        ArrayIterator it{ m_archive.createArrayIterator(child, m_names.item) };
+
+        // Size the array once when the archive knows the number of items
+        size_t count = arrayProperty.size(object);
+        if constexpr (detail::HasArraySize<ArrayIterator>::value)
+        {
+            if (const size_t itemCount = it.size(); itemCount > count && arrayProperty.dynamic())
             {
-                v = m_archive.getValue(child);
+                arrayProperty.resize(object, itemCount);
+                count = itemCount;
             }
-            property.set(object, v);
         }
-        else if (property.kind() == ValueKind::Array)
+
+        for (size_t index = 0; !it.isEnd(); it.next(), ++index)
         {
-            auto const& arrayProperty = static_cast<const ArrayProperty&>(property);
+            // Make sure that there are enough elements in the array
+            if (index >= count)
+            {
+                if (!arrayProperty.dynamic())
+                    break;
+                arrayProperty.resize(object, index + 1);
+                count = index + 1;
+            }
 
-            size_t index = 0;
-            const std::string itemName("item");
-            for (ArrayIterator it{ m_archive.createArrayIterator(child, itemName) }; !it.isEnd(); it.next())
+            if (entry.elementKind == ValueKind::User)
             {
-                // Make sure that there are enough elements in the array
-                if (const size_t count = arrayProperty.size(object); index >= count)
-                {
-                    if (!arrayProperty.dynamic())
-                        break;
-                    arrayProperty.resize(object, index + 1);
-                }
+                auto arrayItem = arrayProperty.get(object, index).to<UserObject>();
+                read(it.getItem(), arrayItem);
+                arrayProperty.set(object, index, arrayItem);
+            }
+            else
+            {
+                arrayProperty.set(object, index, getValue(it.getItem(), entry.elementKind));
+            }
+        }
+    }
+    else if (entry.kind == ValueKind::Map)
+    {
+        auto const& mapProperty = static_cast<const MapProperty&>(property);
 
-                if (arrayProperty.elementType() == ValueKind::User)
-                {
-                    auto arrayItem = arrayProperty.get(object, index).to<UserObject>();
-                    read(it.getItem(), arrayItem);
-                    arrayProperty.set(object, index, arrayItem);
-                }
-                else
-                {
-                    arrayProperty.set(object, index, m_archive.getValue(it.getItem()));
-                }
+        for (ArrayIterator it{ m_archive.createArrayIterator(child, m_names.item) }; !it.isEnd(); it.next())
+        {
+            const Value key = getValue(m_archive.findProperty(it.getItem(), m_names.key),
+                                       mapProperty.keyType());
+            NodeType valueNode = m_archive.findProperty(it.getItem(), m_names.value);
 
-                ++index;
+            if (entry.elementKind == ValueKind::User)
+            {
+                auto mapItem = mapProperty.getOrInsert(object, key).to<UserObject>();
+                read(valueNode, mapItem);
+                mapProperty.set(object, key, mapItem);
+            }
+            else
+            {
+                mapProperty.set(object, key, getValue(valueNode, entry.elementKind));
             }
         }
+    }
+    else
+    {
+        property.set(object, getValue(child, entry.kind));
+    }
+}
+
+template <class ARCHIVE>
+Value ArchiveReader<ARCHIVE>::getValue(NodeType node, ValueKind kind)
+{
+    Value value = m_archive.getValue(node);
+    if (kind != ValueKind::Enum || !m_enumIds)
+        return value;
+
+    // Numbers are ids in the table of names, strings are names
+    long id;
+    if (value.kind() == ValueKind::Integer || value.kind() == ValueKind::LongInteger)
+        id = value.to<long>();
+    else if (value.kind() != ValueKind::String || !ponder::detail::conv(value.cref<String>(), id))
+        return value;
+
+    if (id < 0 || static_cast<size_t>(id) >= m_enumIds->size())
+        PONDER_ERROR(OutOfRange(static_cast<size_t>(id), m_enumIds->size()));
+    return (*m_enumIds)[static_cast<size_t>(id)];
+}
+
+template <class ARCHIVE>
+bool ArchiveReader<ARCHIVE>::readEnumNames(NodeType node, const std::string& name)
+{
+    const NodeType tableNode = m_archive.findProperty(node, name);
+    if (!m_archive.isValid(tableNode))
+        return false;
+
+    // Resolve the names once: ids of declared enums are read as their value
+    const std::string enumName("enum"), valueName("name");
+    auto text = [this](NodeType item, const std::string& member)
+    {
+        return Value(m_archive.getValue(m_archive.findProperty(item, member))).to<String>();
+    };
+
+    auto values = std::make_shared<std::vector<Value>>();
+    for (ArrayIterator it{ m_archive.createArrayIterator(tableNode, m_names.item) }; !it.isEnd(); it.next())
+    {
+        const String metaenum = text(it.getItem(), enumName);
+        const String enumValue = text(it.getItem(), valueName);
+
+        const Enum* enumType = ponder::detail::EnumManager::instance().getByNameSafe(metaenum);
+        if (enumType && enumType->hasName(enumValue))
+            values->emplace_back(enumType->value(enumValue));
         else
+            values->emplace_back(enumValue);
+    }
+    // An empty table has no ids: numbers are still read as values
+    if (!values->empty())
+        m_enumIds = std::move(values);
+    return true;
+}
+
+template <class ARCHIVE>
+bool ArchiveReader<ARCHIVE>::readNumbers(const detail::SerialisedProperty& entry, NodeType node,
+                                         const ArrayProperty& property, const UserObject& object)
+{
+    // As for items, dynamic arrays grow to the number of values, extra values are ignored
+    auto sizeFor = [&](size_t count)
+    {
+        size_t size = property.size(object);
+        if (count > size && property.dynamic())
         {
-            property.set(object, m_archive.getValue(child));
+            property.resize(object, count);
+            size = count;
         }
+        return std::min(size, count);
+    };
+
+    // Contiguous arrays are assigned in bulk, others value by value
+    bool read = false;
+    const bool contiguous = detail::visitNumberData(property, [&](auto* type)
+    {
+        using T = std::remove_pointer_t<decltype(type)>;
+        std::vector<T> values;
+        if (!m_archive.readArray(node, values))
+            return;
+        const size_t count = sizeFor(values.size());
+        const ArraySpan<T> elements = property.span<T>(object);
+        std::copy_n(values.begin(), count, elements.begin());
+        read = true;
+    });
+    if (contiguous)
+        return read;
+
+    auto assign = [&](auto& values)
+    {
+        if (!m_archive.readArray(node, values))
+            return false;
+        const size_t count = sizeFor(values.size());
+        for (size_t index = 0; index < count; ++index)
+            property.set(object, index, values[index]);
+        return true;
+    };
+    if (entry.elementKind == ValueKind::Integer)
+    {
+        std::vector<long long> values;
+        return assign(values);
+    }
+    std::vector<double> values;
+    return assign(values);
+}
+
+template <class ARCHIVE>
+void ArchiveReader<ARCHIVE>::readItems(const std::vector<NodeType>& items,
+                                       const ArrayProperty& property, const UserObject& object)
+{
+    size_t count = property.size(object);
+    if (items.size() > count && property.dynamic())
+    {
+        property.resize(object, items.size());
+        count = items.size();
+    }
+    count = std::min(count, items.size());
+    if (count == 0)
+        return;
+
+    if (const Class* cls = property.elementClass())
+        detail::registerTypes(*cls);
+
+    // The items are read into copies by the other threads, and set back by this one, so that
+    // the array and its observers are only used here
+    std::vector<UserObject> objects(count);
+    const size_t chunks = std::min(count, m_pool->size() * 4);
+    m_pool->run(chunks, [&](size_t chunk)
+    {
+        const size_t begin = count * chunk / chunks;
+        const size_t end = count * (chunk + 1) / chunks;
+
+        ArchiveReader reader(m_archive, m_mode);
+        reader.m_enumIds = m_enumIds;
+        for (size_t index = begin; index < end; ++index)
+        {
+            UserObject item = property.get(object, index).to<UserObject>();
+            reader.read(items[index], item);
+            objects[index] = std::move(item);
+        }
+    });
+
+    for (size_t index = 0; index < count; ++index)
+        property.set(object, index, objects[index]);
+}
+
+template <class ARCHIVE>
+ObjectGenerator<ARCHIVE> ArchiveReader<ARCHIVE>::readObjects(NodeType arrayNode, const Class& cls,
+                                                             bool reuse)
+{
+    return ObjectGenerator<ARCHIVE>(*this, m_archive.createArrayIterator(arrayNode, m_names.item),
+                                    cls, reuse);
+}
+
+template <class ARCHIVE>
+bool ObjectGenerator<ARCHIVE>::next()
+{
+    if (m_end)
+        return false;
+    if (m_count > 0)
+        m_it.next();
+    if (m_it.isEnd())
+    {
+        m_object = UserObject::nothing;
+        m_end = true;
+        return false;
     }
+
+    // Fill the same instance again when asked to, and when the class can be reset
+    if (!m_reuse || m_object == UserObject::nothing || !m_class.resetUserObject(m_object.pointer()))
+    {
+        m_object = m_class.getDefaultUserObject();
+        if (m_object == UserObject::nothing)
+            PONDER_ERROR(NullObject(&m_class));
+    }
+
+    m_reader.read(m_it.getItem(), m_object);
+    ++m_count;
+    return true;
 }
 
 } // namespace archive
@@ -36,6 +36,7 @@
 #include <ponder/enumobject.hpp>
 #include <ponder/userobject.hpp>
 #include <ponder/arraymapper.hpp>
+#include <ponder/mapmapper.hpp>
 #include <ponder/errors.hpp>
 #include <ponder/detail/util.hpp>
 #include <ponder/detail/valueref.hpp>
@@ -456,6 +457,7 @@ struct ValueMapper<const char*>
         // If you get this error, it means you're trying to cast
         // a ponder::Value to a const char*, which is not allowed
         static_assert(T::CONVERSION_TO_CONST_CHAR_PTR_IS_NOT_ALLOWED(), "Conversion to cont char* is not allowed");
+        return nullptr;
     }
 
     template <typename T>
@@ -464,6 +466,7 @@ struct ValueMapper<const char*>
         // If you get this error, it means you're trying to cast
         // a ponder::Value to a const char*, which is not allowed
         static_assert(T::CONVERSION_TO_CONST_CHAR_PTR_IS_NOT_ALLOWED(), "Conversion to cont char* is not allowed");
+        return false;
     }
 };
 
@@ -484,6 +487,16 @@ struct ValueMapper<T,
     static constexpr ponder::ValueKind kind = ponder::ValueKind::Array;
 };
 
+/**
+ * Specialization of ValueMapper for maps.
+ * No conversion allowed, only type mapping is provided.
+ */
+template <typename T>
+struct ValueMapper<T, std::enable_if_t<MapMapper<T>::isMap>>
+{
+    static constexpr ponder::ValueKind kind = ponder::ValueKind::Map;
+};
+
 /**
  * Specializations of ValueMapper for char arrays.
  * Conversion to char[N] is disabled (can't return an array).
@@ -32,10 +32,85 @@
 
 namespace ponder {
 
-ArrayProperty::ArrayProperty(IdRef name, ValueKind elementType, bool dynamic)
+namespace {
+
+// Cursor for arrays which only provide indexed access
+class IndexArrayCursor final : public detail::AbstractArrayCursor
+{
+public:
+    IndexArrayCursor(const ArrayProperty& property, const UserObject& object)
+        : m_property(property), m_object(object), m_index(0) {}
+
+    Value get() const override {return m_property.get(m_object, m_index);}
+    UserObject getObject() const override {return get().to<UserObject>();}
+    void set(const Value& value) override {m_property.set(m_object, m_index, value);}
+    void next() override {++m_index;}
+
+private:
+    const ArrayProperty& m_property;
+    UserObject m_object;
+    size_t m_index;
+};
+
+} // namespace
+
+ArrayCursor::ArrayCursor(const ArrayProperty& property, const UserObject& object, size_t size,
+                         std::unique_ptr<detail::AbstractArrayCursor> cursor)
+    : m_property(&property)
+    , m_object(object)
+    , m_cursor(std::move(cursor))
+    , m_index(0)
+    , m_size(size)
+{
+}
+
+Value ArrayCursor::get() const
+{
+    if (!valid())
+        PONDER_ERROR(OutOfRange(m_index, m_size));
+
+    return m_cursor->get();
+}
+
+UserObject ArrayCursor::getObject() const
+{
+    if (!valid())
+        PONDER_ERROR(OutOfRange(m_index, m_size));
+
+    return m_cursor->getObject();
+}
+
+void ArrayCursor::set(const Value& value) const
+{
+    // Check if the property is writable
+    if (!m_property->isWritable())
+        PONDER_ERROR(ForbiddenWrite(m_property->name()));
+
+    if (!valid())
+        PONDER_ERROR(OutOfRange(m_index, m_size));
+
+    m_cursor->set(value);
+    m_object.notifyChanged(*m_property);
+}
+
+void ArrayCursor::next()
+{
+    if (valid())
+    {
+        ++m_index;
+        if (valid())
+            m_cursor->next();
+    }
+}
+
+
+ArrayProperty::ArrayProperty(IdRef name, ValueKind elementType, bool dynamic,
+                             const std::type_info* dataType, size_t bitwiseSize)
     : Property(name, ValueKind::Array)
     , m_elementType(elementType)
     , m_dynamic(dynamic)
+    , m_dataType(dataType)
+    , m_bitwiseSize(dataType ? bitwiseSize : 0)
 {
 }
 
@@ -44,11 +119,43 @@ ValueKind ArrayProperty::elementType() const
     return m_elementType;
 }
 
+const Class* ArrayProperty::elementClass() const
+{
+    return getElementClass();
+}
+
+const Enum* ArrayProperty::elementEnum() const
+{
+    return getElementEnum();
+}
+
 bool ArrayProperty::dynamic() const
 {
     return m_dynamic;
 }
 
+bool ArrayProperty::contiguous() const
+{
+    return m_dataType != nullptr;
+}
+
+bool ArrayProperty::bitwise() const
+{
+    return m_bitwiseSize != 0;
+}
+
+const void* ArrayProperty::bytes(const UserObject& object, size_t& size) const
+{
+    if (!isReadable())
+        PONDER_ERROR(ForbiddenRead(name()));
+    if (!bitwise())
+        PONDER_ERROR(BadType(ValueKind::Array, m_elementType));
+
+    const void* data = getData(object, size);
+    size *= m_bitwiseSize;
+    return data;
+}
+
 size_t ArrayProperty::size(const UserObject& object) const
 {
     // Check if the property is readable
@@ -69,6 +176,20 @@ void ArrayProperty::resize(const UserObject& object, size_t newSize) const
         PONDER_ERROR(ForbiddenWrite(name()));
 
     setSize(object, newSize);
+    object.notifyChanged(*this);
+}
+
+void ArrayProperty::reserve(const UserObject& object, size_t capacity) const
+{
+    // Check if the array is dynamic
+    if (!dynamic())
+        PONDER_ERROR(ForbiddenWrite(name()));
+
+    // Check if the property is writable
+    if (!isWritable())
+        PONDER_ERROR(ForbiddenWrite(name()));
+
+    setCapacity(object, capacity);
 }
 
 Value ArrayProperty::get(const UserObject& object, size_t index) const
@@ -84,6 +205,16 @@ Value ArrayProperty::get(const UserObject& object, size_t index) const
     return getElement(object, index);
 }
 
+ArrayCursor ArrayProperty::cursor(const UserObject& object) const
+{
+    // Check if the property is readable
+    if (!isReadable())
+        PONDER_ERROR(ForbiddenRead(name()));
+
+    const size_t count = getSize(object);
+    return ArrayCursor(*this, object, count, createCursor(object));
+}
+
 void ArrayProperty::set(const UserObject& object, size_t index, const Value& value) const
 {
     // Check if the property is writable
@@ -94,7 +225,8 @@ void ArrayProperty::set(const UserObject& object, size_t index, const Value& val
     if (const size_t range = size(object); index >= range)
         PONDER_ERROR(OutOfRange(index, range));
 
-    return setElement(object, index, value);
+    setElement(object, index, value);
+    object.notifyChanged(*this);
 }
 
 void ArrayProperty::insert(const UserObject& object, size_t before, const Value& value) const
@@ -111,7 +243,8 @@ void ArrayProperty::insert(const UserObject& object, size_t before, const Value&
     if (const size_t range = size(object) + 1; before >= range)
         PONDER_ERROR(OutOfRange(before, range));
 
-    return insertElement(object, before, value);
+    insertElement(object, before, value);
+    object.notifyChanged(*this);
 }
 
 void ArrayProperty::remove(const UserObject& object, size_t index) const
@@ -128,7 +261,33 @@ void ArrayProperty::remove(const UserObject& object, size_t index) const
     if (const size_t range = size(object); index >= range)
         PONDER_ERROR(OutOfRange(index, range));
 
-    return removeElement(object, index);
+    removeElement(object, index);
+    object.notifyChanged(*this);
+}
+
+void ArrayProperty::setCapacity(const UserObject&, size_t) const
+{
+}
+
+const Class* ArrayProperty::getElementClass() const
+{
+    return nullptr;
+}
+
+const Enum* ArrayProperty::getElementEnum() const
+{
+    return nullptr;
+}
+
+void* ArrayProperty::getData(const UserObject&, size_t& size) const
+{
+    size = 0;
+    return nullptr;
+}
+
+std::unique_ptr<detail::AbstractArrayCursor> ArrayProperty::createCursor(const UserObject& object) const
+{
+    return std::make_unique<IndexArrayCursor>(*this, object);
 }
 
 void ArrayProperty::accept(ClassVisitor& visitor) const
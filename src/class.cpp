@@ -37,6 +37,10 @@ Class::Class(TypeId const& id, IdRef name)
     , m_name(name)
     , m_destructor(nullptr)
     , m_userObjectCreator(nullptr)
+    , m_userObjectCopier(nullptr)
+    , m_userObjectDefaulter(nullptr)
+    , m_userObjectResetter(nullptr)
+    , m_triviallyCopyable(false)
 {
 }
 
@@ -50,6 +54,16 @@ size_t Class::sizeOf() const noexcept
     return m_sizeof;
 }
 
+bool Class::isTriviallyCopyable() const noexcept
+{
+    return m_triviallyCopyable;
+}
+
+bool Class::isCopyConstructible() const noexcept
+{
+    return m_userObjectCopier != nullptr;
+}
+
 size_t Class::constructorCount() const noexcept
 {
     return m_constructors.size();
@@ -145,6 +159,27 @@ const Property& Class::property(IdRef name) const
     return *it->second;
 }
 
+size_t Class::propertyIndex(IdRef name) const
+{
+    PropertyTable::const_iterator it;
+    if (!m_properties.tryFind(name, it))
+    {
+        PONDER_ERROR(PropertyNotFound(name, this->name()));
+    }
+
+    return static_cast<size_t>(std::distance(m_properties.begin(), it));
+}
+
+size_t Class::propertyIndex(const Property& property) const noexcept
+{
+    // A property of another class may have the same name (e.g. hidden by a derived class)
+    PropertyTable::const_iterator it;
+    if (!m_properties.tryFind(property.name(), it) || it->second.get() != &property)
+        return m_properties.size();
+
+    return static_cast<size_t>(std::distance(m_properties.begin(), it));
+}
+
 void Class::visit(ClassVisitor& visitor) const
 {
     // First visit properties
@@ -48,6 +48,11 @@ void ClassVisitor::visit(const ArrayProperty&)
     // The default implementation does nothing
 }
 
+void ClassVisitor::visit(const MapProperty&)
+{
+    // The default implementation does nothing
+}
+
 void ClassVisitor::visit(const EnumProperty&)
 {
     // The default implementation does nothing
@@ -101,6 +101,11 @@ ForbiddenCall::ForbiddenCall(IdRef functionName)
 {
 }
 
+ForbiddenCopy::ForbiddenCopy(IdRef className)
+    : Error("objects of the metaclass " + String(className) + " cannot be copied")
+{
+}
+
 ForbiddenRead::ForbiddenRead(IdRef propertyName)
     : Error("the property " + String(propertyName) + " is not readable")
 {
@@ -116,6 +121,11 @@ FunctionNotFound::FunctionNotFound(IdRef name, IdRef className)
 {
 }
 
+KeyNotFound::KeyNotFound(const String& key, IdRef propertyName)
+    : Error("the key " + key + " couldn't be found in property " + String(propertyName))
+{
+}
+
 NotEnoughArguments::NotEnoughArguments(IdRef functionName,
                                        size_t provided,
                                        size_t expected)
@@ -0,0 +1,208 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#include <ponder/mapproperty.hpp>
+#include <ponder/classvisitor.hpp>
+
+namespace ponder {
+
+MapCursor::MapCursor(const MapProperty& property, const UserObject& object, size_t size,
+                     std::unique_ptr<detail::AbstractMapCursor> cursor)
+    : m_property(&property)
+    , m_object(object)
+    , m_cursor(std::move(cursor))
+    , m_index(0)
+    , m_size(size)
+{
+}
+
+Value MapCursor::key() const
+{
+    if (!valid())
+        PONDER_ERROR(OutOfRange(m_index, m_size));
+
+    return m_cursor->key();
+}
+
+Value MapCursor::value() const
+{
+    if (!valid())
+        PONDER_ERROR(OutOfRange(m_index, m_size));
+
+    return m_cursor->value();
+}
+
+void MapCursor::setValue(const Value& value) const
+{
+    // Check if the property is writable
+    if (!m_property->isWritable())
+        PONDER_ERROR(ForbiddenWrite(m_property->name()));
+
+    if (!valid())
+        PONDER_ERROR(OutOfRange(m_index, m_size));
+
+    m_cursor->setValue(value);
+    m_object.notifyChanged(*m_property);
+}
+
+void MapCursor::next()
+{
+    if (valid())
+    {
+        ++m_index;
+        if (valid())
+            m_cursor->next();
+    }
+}
+
+
+MapProperty::MapProperty(IdRef name, ValueKind keyType, ValueKind mappedType)
+    : Property(name, ValueKind::Map)
+    , m_keyType(keyType)
+    , m_mappedType(mappedType)
+{
+}
+
+ValueKind MapProperty::keyType() const
+{
+    return m_keyType;
+}
+
+ValueKind MapProperty::mappedType() const
+{
+    return m_mappedType;
+}
+
+const Class* MapProperty::mappedClass() const
+{
+    return getMappedClass();
+}
+
+const Enum* MapProperty::mappedEnum() const
+{
+    return getMappedEnum();
+}
+
+size_t MapProperty::size(const UserObject& object) const
+{
+    // Check if the property is readable
+    if (!isReadable())
+        PONDER_ERROR(ForbiddenRead(name()));
+
+    return getSize(object);
+}
+
+bool MapProperty::contains(const UserObject& object, const Value& key) const
+{
+    // Check if the property is readable
+    if (!isReadable())
+        PONDER_ERROR(ForbiddenRead(name()));
+
+    return findElement(object, key, nullptr);
+}
+
+Value MapProperty::get(const UserObject& object, const Value& key) const
+{
+    // Check if the property is readable
+    if (!isReadable())
+        PONDER_ERROR(ForbiddenRead(name()));
+
+    Value value;
+    if (!findElement(object, key, &value))
+    {
+        // Only describe keys which have a textual representation
+        const String keyName = key.isCompatible<String>() ? key.to<String>() : String("?");
+        PONDER_ERROR(KeyNotFound(keyName, name()));
+    }
+
+    return value;
+}
+
+void MapProperty::set(const UserObject& object, const Value& key, const Value& value) const
+{
+    // Check if the property is writable
+    if (!isWritable())
+        PONDER_ERROR(ForbiddenWrite(name()));
+
+    setElement(object, key, value);
+    object.notifyChanged(*this);
+}
+
+Value MapProperty::getOrInsert(const UserObject& object, const Value& key) const
+{
+    // Check if the property is writable
+    if (!isWritable())
+        PONDER_ERROR(ForbiddenWrite(name()));
+
+    // The returned value may be written back, so assume the entry changes
+    Value value = getOrInsertElement(object, key);
+    object.notifyChanged(*this);
+    return value;
+}
+
+bool MapProperty::erase(const UserObject& object, const Value& key) const
+{
+    // Check if the property is writable
+    if (!isWritable())
+        PONDER_ERROR(ForbiddenWrite(name()));
+
+    if (!eraseElement(object, key))
+        return false;
+
+    object.notifyChanged(*this);
+    return true;
+}
+
+MapCursor MapProperty::cursor(const UserObject& object) const
+{
+    // Check if the property is readable
+    if (!isReadable())
+        PONDER_ERROR(ForbiddenRead(name()));
+
+    const size_t count = getSize(object);
+    return MapCursor(*this, object, count, createCursor(object));
+}
+
+void MapProperty::accept(ClassVisitor& visitor) const
+{
+    visitor.visit(*this);
+}
+
+Value MapProperty::getValue(const UserObject&) const
+{
+    // A map has no single value, its entries are accessed by key
+    PONDER_ERROR(ForbiddenRead(name()));
+}
+
+void MapProperty::setValue(const UserObject&, const Value&) const
+{
+    PONDER_ERROR(ForbiddenWrite(name()));
+}
+
+} // namespace ponder
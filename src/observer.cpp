@@ -30,6 +30,8 @@
 #include <ponder/observer.hpp>
 #include <ponder/detail/classmanager.hpp>
 #include <ponder/detail/enummanager.hpp>
+#include <ponder/detail/propertynotifier.hpp>
+#include <exception>
 
 namespace ponder {
 
@@ -67,4 +69,65 @@ PONDER_API void removeObserver(Observer* observer)
     detail::EnumManager::instance().removeObserver(observer);
 }
 
+PropertyObserver::PropertyObserver() = default;
+
+PONDER_API void addPropertyObserver(const Class& metaclass, PropertyObserver* observer)
+{
+    detail::PropertyNotifier::instance().addObserver(&metaclass, observer);
+}
+
+PONDER_API void addPropertyObserver(const Property& property, PropertyObserver* observer)
+{
+    detail::PropertyNotifier::instance().addObserver(&property, observer);
+}
+
+PONDER_API void removePropertyObserver(const Class& metaclass, PropertyObserver* observer)
+{
+    detail::PropertyNotifier::instance().removeObserver(&metaclass, observer);
+}
+
+PONDER_API void removePropertyObserver(const Property& property, PropertyObserver* observer)
+{
+    detail::PropertyNotifier::instance().removeObserver(&property, observer);
+}
+
+PropertyChangeBatch::PropertyChangeBatch()
+    : m_open(true)
+    , m_exceptions(std::uncaught_exceptions())
+{
+    detail::PropertyNotifier::instance().beginBatch();
+}
+
+PropertyChangeBatch::~PropertyChangeBatch()
+{
+    if (!m_open)
+        return;
+
+    // Don't notify changes made by an operation which failed
+    if (std::uncaught_exceptions() > m_exceptions)
+    {
+        m_open = false;
+        detail::PropertyNotifier::instance().endBatch(false);
+        return;
+    }
+
+    try
+    {
+        commit();
+    }
+    catch (...)
+    {
+        // Use commit() to handle the exceptions of the observers
+    }
+}
+
+void PropertyChangeBatch::commit()
+{
+    if (!m_open)
+        return;
+
+    m_open = false;
+    detail::PropertyNotifier::instance().endBatch();
+}
+
 } // namespace ponder
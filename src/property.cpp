@@ -29,6 +29,7 @@
 
 #include <ponder/property.hpp>
 #include <ponder/classvisitor.hpp>
+#include <ponder/class.hpp>
 
 namespace ponder {
 
@@ -81,6 +82,21 @@ void Property::set(const UserObject& object, const Value& value) const
     object.set(*this, value);
 }
 
+PropertyKind Property::propertyKind() const
+{
+    return m_propertyKind;
+}
+
+size_t Property::memberOffset() const
+{
+    return m_memberOffset;
+}
+
+TypeId Property::memberType() const
+{
+    return m_memberType != nullptr ? TypeId(*m_memberType) : TypeId(typeid(void));
+}
+
 void Property::accept(ClassVisitor& visitor) const
 {
     visitor.visit(*this);
@@ -89,7 +105,29 @@ void Property::accept(ClassVisitor& visitor) const
 Property::Property(IdRef name, ValueKind type)
     : m_name(name)
     , m_type(type)
+    , m_propertyKind(PropertyKind::Function)
+    , m_memberOffset(0)
+    , m_memberType(nullptr)
+    , m_memberConst(false)
+    , m_memberBitwiseSize(0)
+    , m_ownerClass(nullptr)
+{
+}
+
+void* Property::memberAddress(const UserObject& object) const
 {
+    if (m_propertyKind != PropertyKind::MemberObject)
+        PONDER_ERROR(ForbiddenRead(name()));
+
+    void* pointer = object.pointer();
+    if (!pointer)
+        PONDER_ERROR(NullObject(&object.getClass()));
+
+    // Apply the base offset first, the object may be of a class derived from the owner
+    if (m_ownerClass)
+        pointer = classCast(pointer, object.getClass(), *m_ownerClass);
+
+    return static_cast<char*>(pointer) + m_memberOffset;
 }
 
 void* Property::getRawData(const UserObject& object) const
@@ -0,0 +1,146 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+#include <ponder/detail/propertynotifier.hpp>
+#include <ponder/observer.hpp>
+#include <ponder/class.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace ponder {
+namespace detail {
+
+PropertyNotifier& PropertyNotifier::instance()
+{
+    static PropertyNotifier notifier;
+    return notifier;
+}
+
+PropertyNotifier::PropertyNotifier()
+    : m_count(0)
+{
+}
+
+PropertyNotifier::Batch& PropertyNotifier::threadBatch()
+{
+    thread_local Batch batch;
+    return batch;
+}
+
+void PropertyNotifier::addObserver(const void* subject, PropertyObserver* observer)
+{
+    assert(observer != nullptr);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ObserverList& observers = m_observers[subject];
+    if (std::find(observers.begin(), observers.end(), observer) == observers.end())
+    {
+        observers.push_back(observer);
+        ++m_count;
+    }
+}
+
+void PropertyNotifier::removeObserver(const void* subject, PropertyObserver* observer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_observers.find(subject);
+    if (it == m_observers.end())
+        return;
+
+    ObserverList& observers = it->second;
+    if (const auto found = std::find(observers.begin(), observers.end(), observer);
+        found != observers.end())
+    {
+        observers.erase(found);
+        --m_count;
+    }
+
+    if (observers.empty())
+        m_observers.erase(it);
+}
+
+void PropertyNotifier::notify(const UserObject& object, const Property& property)
+{
+    Batch& batch = threadBatch();
+    if (batch.depth > 0)
+    {
+        // Queue the first change of this property of this object in the batch
+        if (batch.pendingSet.emplace(object.pointer(), &property).second)
+            batch.pending.emplace_back(object, &property);
+        return;
+    }
+
+    dispatch(object, property);
+}
+
+void PropertyNotifier::beginBatch()
+{
+    ++threadBatch().depth;
+}
+
+void PropertyNotifier::endBatch(bool notify)
+{
+    Batch& batch = threadBatch();
+    assert(batch.depth > 0);
+
+    if (--batch.depth > 0)
+        return;
+
+    // Observers may change properties again, those changes are notified immediately
+    const auto pending = std::move(batch.pending);
+    batch.pending.clear();
+    batch.pendingSet.clear();
+
+    if (notify)
+    {
+        for (const auto& [object, property] : pending)
+            dispatch(object, *property);
+    }
+}
+
+void PropertyNotifier::dispatch(const UserObject& object, const Property& property)
+{
+    // Copy the lists, observers may unsubscribe or change properties while being notified
+    ObserverList observers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const void* subject : {static_cast<const void*>(&object.getClass()),
+                                    static_cast<const void*>(&property)})
+        {
+            if (const auto it = m_observers.find(subject); it != m_observers.end())
+                observers.insert(observers.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    for (PropertyObserver* observer : observers)
+        observer->propertyChanged(object, property);
+}
+
+} // namespace detail
+} // namespace ponder
@@ -30,6 +30,8 @@
 #include <ponder/userobject.hpp>
 #include <ponder/userproperty.hpp>
 #include <ponder/class.hpp>
+#include <ponder/dirtyset.hpp>
+#include <ponder/detail/propertynotifier.hpp>
 
 namespace ponder {
 
@@ -113,8 +115,8 @@ void UserObject::set(const Property& property, const Value& value) const
 {
     if (m_holder)
     {
-        // Just forward to the property, no extra processing required
         property.setValue(*this, value);
+        notifyChanged(property);
     }
     else
     {
@@ -123,4 +125,58 @@ void UserObject::set(const Property& property, const Value& value) const
     }
 }
 
+void UserObject::trackChanges(bool enable) const
+{
+    if (!m_holder)
+        PONDER_ERROR(NullObject(m_class));
+
+    if (enable)
+    {
+        const Class& metaclass = getClass();
+        m_holder->m_trackedClass = &metaclass;
+        m_holder->m_dirty = DirtySet(metaclass.propertyCount());
+    }
+    else
+    {
+        m_holder->m_trackedClass = nullptr;
+        m_holder->m_dirty = DirtySet();
+    }
+}
+
+bool UserObject::isTrackingChanges() const
+{
+    return m_holder && m_holder->m_trackedClass;
+}
+
+const DirtySet& UserObject::dirtyProperties() const
+{
+    static const DirtySet empty;
+    return m_holder ? m_holder->m_dirty : empty;
+}
+
+bool UserObject::isDirty(IdRef property) const
+{
+    return dirtyProperties().test(getClass().propertyIndex(property));
+}
+
+void UserObject::clearDirty() const
+{
+    if (m_holder)
+        m_holder->m_dirty.clear();
+}
+
+void UserObject::notifyChanged(const Property& property) const
+{
+    // Record the change, if the object is tracked
+    if (m_holder && m_holder->m_trackedClass)
+    {
+        // The object may be accessed through another metaclass sharing its address (e.g. base)
+        m_holder->m_dirty.set(m_holder->m_trackedClass->propertyIndex(property));
+    }
+
+    // Notify the observers, if any
+    if (auto& notifier = detail::PropertyNotifier::instance(); !notifier.empty())
+        notifier.notify(*this, property);
+}
+
 } // namespace ponder
@@ -28,6 +28,7 @@
  ****************************************************************************/
 
 #include <ponder/detail/util.hpp>
+#include <stdexcept>
 
 #if defined(__GNUWIN32__) && __cplusplus >= 201103L
     // MinGW support using C++11 defines __STRICT_ANSI__ which removes strcasecmp
@@ -190,12 +191,13 @@ static const char* c_typeNames[] =
     "array",    // ValueKind::Array
     "reference",// ValueKind::Reference
     "user",     // ValueKind::User
+    "map",      // ValueKind::Map
 };
 
 const char* valueKindAsString(ValueKind t)
 {
     const auto i = static_cast<unsigned int>(t);
-    return i <= static_cast<unsigned int>(ValueKind::User) ? c_typeNames[i] : "unknown";
+    return i <= static_cast<unsigned int>(ValueKind::Map) ? c_typeNames[i] : "unknown";
 }
 
 } // namespace detail
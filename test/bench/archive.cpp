@@ -0,0 +1,650 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+// Benchmark the archive backends on the same data.
+//  - Compares the size of the archives and the time to write and read them back.
+//  - Reads are timed looking up each property and walking the members in a single pass.
+//  - The mapped archive is timed reading a whole file, and opening it to read one item.
+//  - Large arrays are written and read on 1 to 8 threads, to show how they scale.
+//  - Arrays of numbers are written and read in one block, and item by item.
+//  - Enums are written as names, values and ids in a table of names.
+//  - XML is written copying the names of each node, and sharing one copy per name.
+
+#include <ponder/classbuilder.hpp>
+#include <ponder/uses/serialise.hpp>
+#include <ponder/uses/archive/binary.hpp>
+#include <ponder/uses/archive/mapped.hpp>
+#include <ponder/uses/archive/rapidjson.hpp>
+#include <ponder/uses/archive/rapidxml.hpp>
+#include "bench.hpp"
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ArchiveBench
+{
+    // Same layout as the serialisation tests
+    struct Simple
+    {
+        int i = 0;
+        float f = 0.f;
+        std::string s;
+        std::vector<int> v;
+        bool b = false;
+        long long ll = 0;
+    };
+
+    struct Complex
+    {
+        std::vector<Simple> items;
+    };
+
+    struct Signal
+    {
+        std::vector<float> samples;
+    };
+
+    // Telemetry records, mostly enums
+    enum class Severity { Trace, Debug, Info, Notice, Warning, Error, Critical, Fatal };
+    enum class Subsystem { Audio, Input, Network, Physics, Render, Scripting, Storage, Ui };
+
+    struct Event
+    {
+        Severity severity = Severity::Trace;
+        Subsystem subsystem = Subsystem::Audio;
+        Severity previous = Severity::Trace;
+        int code = 0;
+    };
+
+    struct Telemetry
+    {
+        std::vector<Event> events;
+    };
+
+    void declare()
+    {
+        ponder::Class::declare<Simple>("ArchiveBench::Simple")
+            .property("int", &Simple::i)
+            .property("float", &Simple::f)
+            .property("string", &Simple::s)
+            .property("vector", &Simple::v)
+            .property("bool", &Simple::b)
+            .property("longlong", &Simple::ll);
+
+        ponder::Class::declare<Complex>("ArchiveBench::Complex")
+            .property("vect", &Complex::items);
+
+        ponder::Class::declare<Signal>("ArchiveBench::Signal")
+            .property("samples", &Signal::samples);
+
+        ponder::Enum::declare<Severity>("ArchiveBench::Severity")
+            .value("Trace", Severity::Trace)
+            .value("Debug", Severity::Debug)
+            .value("Info", Severity::Info)
+            .value("Notice", Severity::Notice)
+            .value("Warning", Severity::Warning)
+            .value("Error", Severity::Error)
+            .value("Critical", Severity::Critical)
+            .value("Fatal", Severity::Fatal);
+
+        ponder::Enum::declare<Subsystem>("ArchiveBench::Subsystem")
+            .value("Audio", Subsystem::Audio)
+            .value("Input", Subsystem::Input)
+            .value("Network", Subsystem::Network)
+            .value("Physics", Subsystem::Physics)
+            .value("Render", Subsystem::Render)
+            .value("Scripting", Subsystem::Scripting)
+            .value("Storage", Subsystem::Storage)
+            .value("Ui", Subsystem::Ui);
+
+        ponder::Class::declare<Event>("ArchiveBench::Event")
+            .property("severity", &Event::severity)
+            .property("subsystem", &Event::subsystem)
+            .property("previous", &Event::previous)
+            .property("code", &Event::code);
+
+        ponder::Class::declare<Telemetry>("ArchiveBench::Telemetry")
+            .property("events", &Telemetry::events);
+    }
+
+    Complex makeData(size_t count)
+    {
+        Complex c;
+        c.items.resize(count);
+        for (size_t n = 0; n < count; ++n)
+        {
+            Simple& s = c.items[n];
+            s.i = static_cast<int>(n);
+            s.f = static_cast<float>(n) * 0.25f;
+            s.s = "item" + std::to_string(n);
+            s.v = {1, 2, 3, static_cast<int>(n)};
+            s.b = (n & 1) != 0;
+            s.ll = 9999999999LL + static_cast<long long>(n);
+        }
+        return c;
+    }
+}
+
+PONDER_AUTO_TYPE(ArchiveBench::Simple, &ArchiveBench::declare)
+PONDER_AUTO_TYPE(ArchiveBench::Complex, &ArchiveBench::declare)
+PONDER_AUTO_TYPE(ArchiveBench::Signal, &ArchiveBench::declare)
+PONDER_AUTO_TYPE(ArchiveBench::Severity, &ArchiveBench::declare)
+PONDER_AUTO_TYPE(ArchiveBench::Subsystem, &ArchiveBench::declare)
+PONDER_AUTO_TYPE(ArchiveBench::Event, &ArchiveBench::declare)
+PONDER_AUTO_TYPE(ArchiveBench::Telemetry, &ArchiveBench::declare)
+
+using namespace ArchiveBench;
+
+using JsonArchive = ponder::archive::RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>;
+
+using ponder::archive::Parallelism;
+
+static std::string writeJson(const Complex& c, const Parallelism& parallelism = Parallelism())
+{
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> jwriter(sb);
+    jwriter.StartObject();
+    JsonArchive archive(jwriter);
+    ponder::archive::ArchiveWriter<JsonArchive>(archive, parallelism).write(nullptr, ponder::UserObject::makeRef(c));
+    jwriter.EndObject();
+    return sb.GetString();
+}
+
+using ponder::archive::ReadMode;
+
+static size_t readJson(const std::string& storage, ReadMode mode = ReadMode::FindProperty,
+                       const Parallelism& parallelism = Parallelism())
+{
+    rapidjson::Document jdoc;
+    jdoc.Parse(storage.data());
+    ponder::archive::RapidJsonArchiveReader archive(jdoc);
+    Complex c;
+    ponder::archive::ArchiveReader(archive, mode, parallelism).read(jdoc, ponder::UserObject::makeRef(c));
+    return c.items.size();
+}
+
+static std::string writeBinary(const Complex& c, const Parallelism& parallelism = Parallelism())
+{
+    std::string storage;
+    ponder::archive::BinaryArchiveWriter archive(storage);
+    ponder::archive::ArchiveWriter(archive, parallelism).write(archive.root(), ponder::UserObject::makeRef(c));
+    archive.finish();
+    return storage;
+}
+
+static size_t readBinary(const std::string& storage, ReadMode mode = ReadMode::FindProperty,
+                         const Parallelism& parallelism = Parallelism())
+{
+    ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+    Complex c;
+    ponder::archive::ArchiveReader(archive, mode, parallelism).read(archive.root(), ponder::UserObject::makeRef(c));
+    return c.items.size();
+}
+
+TEST_CASE("Archive backends")
+{
+    constexpr size_t c_count = 1000;
+    const Complex data = makeData(c_count);
+
+    const std::string json = writeJson(data);
+    const std::string binary = writeBinary(data);
+    REQUIRE(readJson(json) == c_count);
+    REQUIRE(readBinary(binary) == c_count);
+    REQUIRE(readJson(json, ReadMode::SinglePass) == c_count);
+    REQUIRE(readBinary(binary, ReadMode::SinglePass) == c_count);
+
+    std::cout << c_count << " objects: JSON " << json.size() << " bytes, binary "
+              << binary.size() << " bytes" << std::endl;
+
+    BENCHMARK("write JSON")
+    {
+        return writeJson(data);
+    };
+    BENCHMARK("write binary")
+    {
+        return writeBinary(data);
+    };
+    BENCHMARK("read JSON")
+    {
+        return readJson(json);
+    };
+    BENCHMARK("read binary")
+    {
+        return readBinary(binary);
+    };
+    BENCHMARK("read JSON single pass")
+    {
+        return readJson(json, ReadMode::SinglePass);
+    };
+    BENCHMARK("read binary single pass")
+    {
+        return readBinary(binary, ReadMode::SinglePass);
+    };
+}
+
+TEST_CASE("Parallel archives")
+{
+    constexpr size_t c_count = 100000;
+    const Complex data = makeData(c_count);
+
+    const std::string json = writeJson(data);
+    const std::string binary = writeBinary(data);
+
+    std::cout << c_count << " objects, " << std::thread::hardware_concurrency()
+              << " hardware threads" << std::endl;
+
+    for (const unsigned threads : {1u, 2u, 4u, 8u})
+    {
+        const Parallelism parallelism{threads};
+        REQUIRE(writeBinary(data, parallelism) == binary);
+        REQUIRE(readJson(json, ReadMode::FindProperty, parallelism) == c_count);
+
+        const std::string suffix = " x" + std::to_string(threads);
+        BENCHMARK("write JSON" + suffix)
+        {
+            return writeJson(data, parallelism);
+        };
+        BENCHMARK("write binary" + suffix)
+        {
+            return writeBinary(data, parallelism);
+        };
+        BENCHMARK("read JSON" + suffix)
+        {
+            return readJson(json, ReadMode::SinglePass, parallelism);
+        };
+        BENCHMARK("read binary" + suffix)
+        {
+            return readBinary(binary, ReadMode::SinglePass, parallelism);
+        };
+    }
+}
+
+// Archive without the hooks for arrays of numbers, which are then written item by item
+template <class A>
+struct ItemByItem : A
+{
+    using A::A;
+    template <typename T> void writeArray(typename A::Node, const std::string&, const T*, size_t) = delete;
+    template <typename T> bool readArray(typename A::Node, std::vector<T>&) = delete;
+};
+
+template <class WriterArchive, class ReaderArchive>
+static void benchNumbers(const char* format, const Signal& signal)
+{
+    const std::string blockName = std::string(format) + " block";
+    const std::string itemName = std::string(format) + " item by item";
+
+    BENCHMARK("write " + blockName)
+    {
+        return WriterArchive::template write<WriterArchive>(signal);
+    };
+    BENCHMARK("write " + itemName)
+    {
+        return WriterArchive::template write<ItemByItem<WriterArchive>>(signal);
+    };
+
+    const auto blocks = WriterArchive::template write<WriterArchive>(signal);
+    const auto items = WriterArchive::template write<ItemByItem<WriterArchive>>(signal);
+    REQUIRE(ReaderArchive::template read<ReaderArchive>(blocks) == signal.samples.size());
+    REQUIRE(ReaderArchive::template read<ItemByItem<ReaderArchive>>(items) == signal.samples.size());
+
+    BENCHMARK("read " + blockName)
+    {
+        return ReaderArchive::template read<ReaderArchive>(blocks);
+    };
+    BENCHMARK("read " + itemName)
+    {
+        return ReaderArchive::template read<ItemByItem<ReaderArchive>>(items);
+    };
+}
+
+// Write and read a signal with each backend, A being the archive or ItemByItem<archive>
+struct BinaryWriter : ponder::archive::BinaryArchiveWriter
+{
+    using BinaryArchiveWriter::BinaryArchiveWriter;
+
+    template <class A>
+    static std::string write(const Signal& signal)
+    {
+        std::string storage;
+        A archive(storage);
+        ponder::archive::ArchiveWriter(archive).write(archive.root(), ponder::UserObject::makeRef(signal));
+        archive.finish();
+        return storage;
+    }
+};
+
+struct BinaryReader : ponder::archive::BinaryArchiveReader
+{
+    using BinaryArchiveReader::BinaryArchiveReader;
+
+    template <class A>
+    static size_t read(const std::string& storage)
+    {
+        A archive(storage.data(), storage.size());
+        Signal signal;
+        ponder::archive::ArchiveReader(archive).read(archive.root(), ponder::UserObject::makeRef(signal));
+        return signal.samples.size();
+    }
+};
+
+struct JsonWriter : JsonArchive
+{
+    using JsonArchive::JsonArchive;
+
+    template <class A>
+    static std::string write(const Signal& signal)
+    {
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer<rapidjson::StringBuffer> jwriter(sb);
+        jwriter.StartObject();
+        A archive(jwriter);
+        ponder::archive::ArchiveWriter(archive).write(nullptr, ponder::UserObject::makeRef(signal));
+        jwriter.EndObject();
+        return sb.GetString();
+    }
+};
+
+struct JsonReader : ponder::archive::RapidJsonArchiveReader
+{
+    using RapidJsonArchiveReader::RapidJsonArchiveReader;
+
+    template <class A>
+    static size_t read(const std::string& storage)
+    {
+        rapidjson::Document jdoc;
+        jdoc.Parse(storage.data());
+        A archive(jdoc);
+        Signal signal;
+        ponder::archive::ArchiveReader(archive).read(jdoc, ponder::UserObject::makeRef(signal));
+        return signal.samples.size();
+    }
+};
+
+struct XmlArchive : ponder::archive::RapidXmlArchive<>
+{
+    template <class A>
+    static std::shared_ptr<rapidxml::xml_document<>> write(const Signal& signal)
+    {
+        auto doc = std::make_shared<rapidxml::xml_document<>>();
+        auto root = doc->allocate_node(rapidxml::node_element, "signal");
+        doc->append_node(root);
+        A archive;
+        ponder::archive::ArchiveWriter(archive).write(root, ponder::UserObject::makeRef(signal));
+        return doc;
+    }
+
+    template <class A>
+    static size_t read(const std::shared_ptr<rapidxml::xml_document<>>& doc)
+    {
+        A archive;
+        Signal signal;
+        ponder::archive::ArchiveReader(archive).read(doc->first_node(), ponder::UserObject::makeRef(signal));
+        return signal.samples.size();
+    }
+};
+
+TEST_CASE("Arrays of numbers")
+{
+    constexpr size_t c_count = 1000000;
+    Signal signal;
+    signal.samples.resize(c_count);
+    for (size_t n = 0; n < c_count; ++n)
+        signal.samples[n] = static_cast<float>(n) * 0.125f;
+
+    std::cout << c_count << " floats" << std::endl;
+
+    benchNumbers<BinaryWriter, BinaryReader>("binary", signal);
+    benchNumbers<JsonWriter, JsonReader>("JSON", signal);
+    benchNumbers<XmlArchive, XmlArchive>("XML", signal);
+}
+
+// Write XML, with an archive bound to the document if shared, so that names are copied once
+static bool writeXml(const Complex& c, bool shared)
+{
+    rapidxml::xml_document<> doc;
+    auto root = doc.allocate_node(rapidxml::node_element, "complex");
+    doc.append_node(root);
+    auto archive = shared ? ponder::archive::RapidXmlArchive<>(doc) : ponder::archive::RapidXmlArchive<>();
+    ponder::archive::ArchiveWriter(archive).write(root, ponder::UserObject::makeRef(c));
+    return root->first_node() != nullptr;
+}
+
+TEST_CASE("XML writer")
+{
+    const Complex data = makeData(100000);
+
+    BENCHMARK("write XML copying names")
+    {
+        return writeXml(data, false);
+    };
+    BENCHMARK("write XML sharing names")
+    {
+        return writeXml(data, true);
+    };
+}
+
+using ponder::archive::EnumFormat;
+
+static std::string writeTelemetryJson(const Telemetry& telemetry, EnumFormat format)
+{
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> jwriter(sb);
+    jwriter.StartObject();
+    JsonArchive archive(jwriter);
+    ponder::archive::ArchiveWriter<JsonArchive> writer(archive);
+    writer.setEnumFormat(format);
+    archive.beginChild(nullptr, "data");
+    writer.write(nullptr, ponder::UserObject::makeRef(telemetry));
+    archive.endChild(nullptr, nullptr);
+    writer.writeEnumNames(nullptr);
+    jwriter.EndObject();
+    return sb.GetString();
+}
+
+static size_t readTelemetryJson(const std::string& storage)
+{
+    rapidjson::Document jdoc;
+    jdoc.Parse(storage.data());
+    ponder::archive::RapidJsonArchiveReader archive(jdoc);
+    ponder::archive::ArchiveReader reader(archive);
+    reader.readEnumNames(jdoc);
+    Telemetry telemetry;
+    reader.read(jdoc["data"], ponder::UserObject::makeRef(telemetry));
+    return telemetry.events.size();
+}
+
+static std::shared_ptr<rapidxml::xml_document<>> writeTelemetryXml(const Telemetry& telemetry,
+                                                                   EnumFormat format)
+{
+    auto doc = std::make_shared<rapidxml::xml_document<>>();
+    auto root = doc->allocate_node(rapidxml::node_element, "telemetry");
+    doc->append_node(root);
+    auto data = doc->allocate_node(rapidxml::node_element, "data");
+    root->append_node(data);
+    ponder::archive::RapidXmlArchive<> archive;
+    ponder::archive::ArchiveWriter writer(archive);
+    writer.setEnumFormat(format);
+    writer.write(data, ponder::UserObject::makeRef(telemetry));
+    writer.writeEnumNames(root);
+    return doc;
+}
+
+static size_t readTelemetryXml(const std::shared_ptr<rapidxml::xml_document<>>& doc)
+{
+    ponder::archive::RapidXmlArchive<> archive;
+    ponder::archive::ArchiveReader reader(archive);
+    reader.readEnumNames(doc->first_node());
+    Telemetry telemetry;
+    reader.read(doc->first_node()->first_node("data"), ponder::UserObject::makeRef(telemetry));
+    return telemetry.events.size();
+}
+
+TEST_CASE("Enum formats")
+{
+    constexpr size_t c_count = 100000;
+    Telemetry telemetry;
+    telemetry.events.resize(c_count);
+    for (size_t n = 0; n < c_count; ++n)
+    {
+        Event& event = telemetry.events[n];
+        event.severity = static_cast<Severity>(n % 8);
+        event.subsystem = static_cast<Subsystem>((n / 8) % 8);
+        event.previous = static_cast<Severity>((n + 3) % 8);
+        event.code = static_cast<int>(n);
+    }
+
+    const std::pair<EnumFormat, const char*> formats[] = {
+        {EnumFormat::Name, "names"}, {EnumFormat::Value, "values"}, {EnumFormat::NameId, "ids"}};
+
+    std::cout << c_count << " events:";
+    for (auto&& [format, name] : formats)
+    {
+        const std::string json = writeTelemetryJson(telemetry, format);
+        REQUIRE(readTelemetryJson(json) == c_count);
+        REQUIRE(readTelemetryXml(writeTelemetryXml(telemetry, format)) == c_count);
+        std::cout << " JSON " << name << " " << json.size() << " bytes;";
+    }
+    std::cout << std::endl;
+
+    for (auto&& [format, name] : formats)
+    {
+        const std::string suffix = std::string(" ") + name;
+        const std::string json = writeTelemetryJson(telemetry, format);
+        const auto xml = writeTelemetryXml(telemetry, format);
+
+        BENCHMARK("write JSON" + suffix)
+        {
+            return writeTelemetryJson(telemetry, format);
+        };
+        BENCHMARK("read JSON" + suffix)
+        {
+            return readTelemetryJson(json);
+        };
+        BENCHMARK("write XML" + suffix)
+        {
+            return writeTelemetryXml(telemetry, format);
+        };
+        BENCHMARK("read XML" + suffix)
+        {
+            return readTelemetryXml(xml);
+        };
+    }
+}
+
+#ifdef PONDER_ARCHIVE_MAPPED_FILE
+
+enum class Items { Array, NewObjects, OneObject };
+
+// Sum the items of the archive, reading them all at once or one at a time
+static long long sumBinary(const std::string& storage, Items items)
+{
+    ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+    ponder::archive::ArchiveReader reader(archive, ReadMode::SinglePass);
+    long long sum = 0;
+    if (items == Items::Array)
+    {
+        Complex c;
+        reader.read(archive.root(), ponder::UserObject::makeRef(c));
+        for (const Simple& item : c.items)
+            sum += item.ll + item.v.back();
+        return sum;
+    }
+    for (const ponder::UserObject& object :
+         reader.readObjects(archive.findProperty(archive.root(), "vect"),
+                            ponder::classByType<Simple>(), items == Items::OneObject))
+    {
+        const Simple& item = object.get<Simple>();
+        sum += item.ll + item.v.back();
+    }
+    return sum;
+}
+
+TEST_CASE("Reading objects one at a time")
+{
+    constexpr size_t c_count = 100000;
+    const std::string binary = writeBinary(makeData(c_count));
+    REQUIRE(sumBinary(binary, Items::NewObjects) == sumBinary(binary, Items::Array));
+    REQUIRE(sumBinary(binary, Items::OneObject) == sumBinary(binary, Items::Array));
+
+    BENCHMARK("read whole array")
+    {
+        return sumBinary(binary, Items::Array);
+    };
+    BENCHMARK("read new objects")
+    {
+        return sumBinary(binary, Items::NewObjects);
+    };
+    BENCHMARK("read into one object")
+    {
+        return sumBinary(binary, Items::OneObject);
+    };
+}
+
+TEST_CASE("Mapped archive")
+{
+    constexpr size_t c_count = 100000;
+    const std::string path = (std::filesystem::temp_directory_path() / "ponderbench.pndm").string();
+    {
+        const Complex data = makeData(c_count);
+        std::string storage;
+        ponder::archive::MappedArchiveWriter archive(storage);
+        ponder::archive::ArchiveWriter(archive).write(archive.root(), ponder::UserObject::makeRef(data));
+        archive.finish();
+        std::ofstream(path, std::ios::binary) << storage;
+        std::cout << c_count << " objects: mapped archive " << storage.size() << " bytes" << std::endl;
+    }
+
+    BENCHMARK("read whole file")
+    {
+        ponder::archive::MappedFile file(path.c_str());
+        ponder::archive::MappedArchiveReader archive(file.data(), file.size());
+        Complex c;
+        ponder::archive::ArchiveReader(archive).read(archive.root(), ponder::UserObject::makeRef(c));
+        return c.items.size();
+    };
+    BENCHMARK("open and view one item")
+    {
+        ponder::archive::MappedFile file(path.c_str());
+        ponder::archive::MappedArchiveReader archive(file.data(), file.size());
+        const ponder::archive::MappedObject item = archive.view<Complex>().array("vect").object<Simple>(c_count / 2);
+        return item.getString("string").size() + item.array("vector").get(3).to<size_t>();
+    };
+
+    std::remove(path.c_str());
+}
+
+#endif // PONDER_ARCHIVE_MAPPED_FILE
@@ -0,0 +1,112 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+** 
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+** 
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+// Benchmark walking array properties by index and with a cursor.
+//  - Indexed access to a std::list is linear, so walking it by index is quadratic.
+
+#include <ponder/classbuilder.hpp>
+#include "bench.hpp"
+#include <list>
+#include <numeric>
+#include <vector>
+
+namespace ArrayCursorBench
+{
+    struct Arrays
+    {
+        std::list<int> list;
+        std::vector<int> vector;
+    };
+
+    void declare()
+    {
+        ponder::Class::declare<Arrays>("ArrayCursorBench::Arrays")
+            .property("list", &Arrays::list)
+            .property("vector", &Arrays::vector);
+    }
+}
+
+PONDER_AUTO_TYPE(ArrayCursorBench::Arrays, &ArrayCursorBench::declare)
+
+using namespace ArrayCursorBench;
+
+static long long sumByIndex(const ponder::ArrayProperty& property, const ponder::UserObject& object)
+{
+    long long sum = 0;
+    for (size_t i = 0, count = property.size(object); i < count; ++i)
+        sum += property.get(object, i).to<int>();
+    return sum;
+}
+
+static long long sumByCursor(const ponder::ArrayProperty& property, const ponder::UserObject& object)
+{
+    long long sum = 0;
+    for (ponder::ArrayCursor it = property.cursor(object); it.valid(); it.next())
+        sum += it.get().to<int>();
+    return sum;
+}
+
+TEST_CASE("Walk array properties")
+{
+    const ponder::Class& metaclass = ponder::classByType<Arrays>();
+    const auto& list = static_cast<const ponder::ArrayProperty&>(metaclass.property("list"));
+    const auto& vector = static_cast<const ponder::ArrayProperty&>(metaclass.property("vector"));
+
+    for (size_t size : {1000, 10000})
+    {
+        Arrays arrays;
+        arrays.vector.resize(size);
+        std::iota(arrays.vector.begin(), arrays.vector.end(), 0);
+        arrays.list.assign(arrays.vector.begin(), arrays.vector.end());
+        const ponder::UserObject object(&arrays);
+
+        const long long expected = std::accumulate(arrays.vector.begin(), arrays.vector.end(), 0LL);
+        REQUIRE(sumByIndex(list, object) == expected);
+        REQUIRE(sumByCursor(list, object) == expected);
+
+        const std::string suffix = " " + std::to_string(size);
+
+        BENCHMARK("list by index" + suffix)
+        {
+            return sumByIndex(list, object);
+        };
+        BENCHMARK("list by cursor" + suffix)
+        {
+            return sumByCursor(list, object);
+        };
+        BENCHMARK("vector by index" + suffix)
+        {
+            return sumByIndex(vector, object);
+        };
+        BENCHMARK("vector by cursor" + suffix)
+        {
+            return sumByCursor(vector, object);
+        };
+    }
+}
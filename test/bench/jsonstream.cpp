@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+// Compare the ways of reading and writing large JSON documents.
+//  - Reading through a DOM or streaming: reports the time and the peak resident memory.
+//  - Writing through rapidjson::Writer or straight to the file: reports the throughput.
+
+#include <ponder/classbuilder.hpp>
+#include <ponder/uses/serialise.hpp>
+#include <ponder/uses/archive/rapidjson.hpp>
+#include "bench.hpp"
+#include <rapidjson/filereadstream.h>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/writer.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace JsonStreamBench
+{
+    struct Item
+    {
+        int id = 0;
+        double weight = 0.0;
+        std::string name;
+        std::vector<int> links;
+    };
+
+    struct Scene
+    {
+        std::vector<Item> items;
+    };
+
+    void declare()
+    {
+        ponder::Class::declare<Item>("JsonStreamBench::Item")
+            .property("id", &Item::id)
+            .property("weight", &Item::weight)
+            .property("name", &Item::name)
+            .property("links", &Item::links);
+
+        ponder::Class::declare<Scene>("JsonStreamBench::Scene")
+            .property("items", &Scene::items);
+    }
+
+    // Peak resident memory in KB since the last reset, where the OS reports it
+    long peakMemory()
+    {
+        std::ifstream status("/proc/self/status");
+        for (std::string line; std::getline(status, line);)
+        {
+            if (line.compare(0, 6, "VmHWM:") == 0)
+                return std::stol(line.substr(6));
+        }
+        return -1;
+    }
+
+    void resetPeakMemory()
+    {
+        std::ofstream("/proc/self/clear_refs") << "5";
+    }
+}
+
+PONDER_AUTO_TYPE(JsonStreamBench::Item, &JsonStreamBench::declare)
+PONDER_AUTO_TYPE(JsonStreamBench::Scene, &JsonStreamBench::declare)
+
+using namespace JsonStreamBench;
+
+static Scene makeScene(size_t count)
+{
+    Scene scene;
+    scene.items.resize(count);
+    for (size_t n = 0; n < count; ++n)
+    {
+        Item& item = scene.items[n];
+        item.id = static_cast<int>(n);
+        item.weight = static_cast<double>(n) * 0.5;
+        item.name = "item" + std::to_string(n);
+        item.links = {static_cast<int>(n) - 1, static_cast<int>(n) + 1};
+    }
+    return scene;
+}
+
+static void writeRapidJson(const char* path, const Scene& scene)
+{
+    FILE* file = std::fopen(path, "wb");
+    char buffer[65536];
+    rapidjson::FileWriteStream stream(file, buffer, sizeof(buffer));
+    rapidjson::Writer<rapidjson::FileWriteStream> jwriter(stream);
+    using Archive = ponder::archive::RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::FileWriteStream>>;
+    Archive archive(jwriter);
+    jwriter.StartObject();
+    ponder::archive::ArchiveWriter<Archive>(archive).write(nullptr, ponder::UserObject::makeRef(scene));
+    jwriter.EndObject();
+    stream.Flush();
+    std::fclose(file);
+}
+
+static void writeStream(const char* path, const Scene& scene)
+{
+    FILE* file = std::fopen(path, "wb");
+    {
+        ponder::archive::RapidJsonStreamWriter archive(file);
+        ponder::archive::ArchiveWriter<ponder::archive::RapidJsonStreamWriter> writer(archive);
+        writer.write(archive.root(), ponder::UserObject::makeRef(scene));
+        archive.finish();
+    }
+    std::fclose(file);
+}
+
+static size_t readDom(const char* path)
+{
+    FILE* file = std::fopen(path, "rb");
+    char buffer[65536];
+    rapidjson::FileReadStream stream(file, buffer, sizeof(buffer));
+    rapidjson::Document jdoc;
+    jdoc.ParseStream(stream);
+    std::fclose(file);
+
+    Scene scene;
+    ponder::archive::RapidJsonArchiveReader archive(jdoc);
+    ponder::archive::ArchiveReader(archive).read(jdoc, ponder::UserObject::makeRef(scene));
+    return scene.items.size();
+}
+
+static size_t readStream(const char* path)
+{
+    FILE* file = std::fopen(path, "rb");
+    char buffer[65536];
+    rapidjson::FileReadStream stream(file, buffer, sizeof(buffer));
+
+    Scene scene;
+    ponder::archive::RapidJsonStreamReader reader;
+    reader.read(stream, ponder::UserObject::makeRef(scene));
+    std::fclose(file);
+    return scene.items.size();
+}
+
+TEST_CASE("JSON DOM vs stream reader")
+{
+    constexpr size_t c_count = 300000;
+    const std::string path = (std::filesystem::temp_directory_path() / "ponderbench.json").string();
+    writeStream(path.c_str(), makeScene(c_count));
+
+    for (auto [name, read] : {std::make_pair("DOM", &readDom), std::make_pair("stream", &readStream)})
+    {
+        resetPeakMemory();
+        const long before = peakMemory();
+        const auto start = std::chrono::steady_clock::now();
+        const size_t count = read(path.c_str());
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        const long peak = peakMemory();
+
+        CHECK(count == c_count);
+        std::cout << name << ": " << elapsed.count() << " ms, peak memory +"
+                  << (peak - before) / 1024 << " MB" << std::endl;
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("JSON writers")
+{
+    constexpr size_t c_count = 300000;
+    const std::string path = (std::filesystem::temp_directory_path() / "ponderbench.json").string();
+    const Scene scene = makeScene(c_count);
+
+    for (auto [name, write] : {std::make_pair("rapidjson writer", &writeRapidJson),
+                               std::make_pair("stream writer", &writeStream)})
+    {
+        write(path.c_str(), scene); // warm up the plans and the file cache
+
+        constexpr int c_runs = 5;
+        const auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < c_runs; ++run)
+            write(path.c_str(), scene);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const auto size = std::filesystem::file_size(path);
+        std::cout << name << ": " << size << " bytes, " << elapsed.count() * 1000 / c_runs << " ms, "
+                  << size * c_runs / elapsed.count() / (1024 * 1024) << " MB/s" << std::endl;
+    }
+
+    std::remove(path.c_str());
+}
@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+// Benchmark setting properties with and without property observers.
+//  - Without any observer, notifying changes must cost next to nothing.
+
+#include <ponder/classbuilder.hpp>
+#include <ponder/observer.hpp>
+#include "bench.hpp"
+
+namespace PropertyObserverBench
+{
+    struct Point
+    {
+        int x = 0;
+        int y = 0;
+    };
+
+    struct Other
+    {
+        int z = 0;
+    };
+
+    struct Counter : ponder::PropertyObserver
+    {
+        size_t count = 0;
+
+        void propertyChanged(const ponder::UserObject&, const ponder::Property&) override
+        {
+            ++count;
+        }
+    };
+
+    void declare()
+    {
+        ponder::Class::declare<Point>("PropertyObserverBench::Point")
+            .property("x", &Point::x)
+            .property("y", &Point::y);
+
+        ponder::Class::declare<Other>("PropertyObserverBench::Other")
+            .property("z", &Other::z);
+    }
+}
+
+PONDER_AUTO_TYPE(PropertyObserverBench::Point, &PropertyObserverBench::declare)
+PONDER_AUTO_TYPE(PropertyObserverBench::Other, &PropertyObserverBench::declare)
+
+using namespace PropertyObserverBench;
+
+static int setMany(const ponder::Property& property, const ponder::UserObject& object)
+{
+    constexpr int c_count = 1000;
+    for (int i = 0; i < c_count; ++i)
+        property.set(object, i);
+    return c_count;
+}
+
+TEST_CASE("Set properties with observers")
+{
+    const ponder::Class& metaclass = ponder::classByType<Point>();
+    const ponder::Property& x = metaclass.property("x");
+    Point point;
+    const ponder::UserObject object(&point);
+    Counter counter;
+
+    BENCHMARK("set without observer")
+    {
+        return setMany(x, object);
+    };
+
+    ponder::addPropertyObserver(ponder::classByType<Other>(), &counter);
+    BENCHMARK("set with an observer on another class")
+    {
+        return setMany(x, object);
+    };
+    ponder::removePropertyObserver(ponder::classByType<Other>(), &counter);
+    REQUIRE(counter.count == 0);
+
+    ponder::addPropertyObserver(metaclass, &counter);
+    BENCHMARK("set with an observer")
+    {
+        return setMany(x, object);
+    };
+    BENCHMARK("set with an observer in a batch")
+    {
+        ponder::PropertyChangeBatch batch;
+        return setMany(x, object);
+    };
+    ponder::removePropertyObserver(metaclass, &counter);
+    REQUIRE(counter.count > 0);
+}
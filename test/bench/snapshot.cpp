@@ -0,0 +1,296 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+// Frame times of a main loop which writes periodic snapshots of its state.
+//  - Each frame does a fixed amount of work, and every tenth frame writes a snapshot.
+//  - Snapshots are written as JSON and binary archives, straight to the file or through
+//    an AsyncSink which writes the file on its own thread.
+//  - The same is done with a device slower than the page cache: a pipe read at 50 MB/s.
+//  - Reports a histogram of the frame times and their percentiles, compared to frames
+//    without snapshots.
+
+#include <ponder/classbuilder.hpp>
+#include <ponder/uses/serialise.hpp>
+#include <ponder/uses/archive/asyncsink.hpp>
+#include <ponder/uses/archive/binary.hpp>
+#include <ponder/uses/archive/rapidjson.hpp>
+#include "bench.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#ifdef _WIN32
+#   include <io.h>
+#else
+#   include <unistd.h>
+#endif
+
+namespace SnapshotBench
+{
+    struct Body
+    {
+        int id = 0;
+        double position = 0.0;
+        double velocity = 0.0;
+        std::string name;
+    };
+
+    struct World
+    {
+        std::vector<Body> bodies;
+    };
+
+    void declare()
+    {
+        ponder::Class::declare<Body>("SnapshotBench::Body")
+            .property("id", &Body::id)
+            .property("position", &Body::position)
+            .property("velocity", &Body::velocity)
+            .property("name", &Body::name);
+
+        ponder::Class::declare<World>("SnapshotBench::World")
+            .property("bodies", &World::bodies);
+    }
+}
+
+PONDER_AUTO_TYPE(SnapshotBench::Body, &SnapshotBench::declare)
+PONDER_AUTO_TYPE(SnapshotBench::World, &SnapshotBench::declare)
+
+using namespace SnapshotBench;
+using Clock = std::chrono::steady_clock;
+using ponder::archive::AsyncSink;
+
+// Frame times in microseconds, sorted
+using FrameTimes = std::vector<double>;
+
+static void simulate(World& world, Clock::duration work)
+{
+    const auto end = Clock::now() + work;
+    for (size_t n = 0; Clock::now() < end; n = (n + 64) % world.bodies.size())
+    {
+        for (size_t i = n; i < std::min(n + 64, world.bodies.size()); ++i)
+            world.bodies[i].position += world.bodies[i].velocity * 0.001;
+    }
+}
+
+static FrameTimes runFrames(World& world, size_t frames, const std::function<void()>& snapshot)
+{
+    FrameTimes times;
+    times.reserve(frames);
+    for (size_t frame = 0; frame < frames; ++frame)
+    {
+        const auto start = Clock::now();
+        simulate(world, std::chrono::milliseconds(2));
+        if (snapshot && frame % 10 == 9)
+            snapshot();
+        times.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+static double percentile(const FrameTimes& times, double p)
+{
+    const auto index = static_cast<size_t>(p * static_cast<double>(times.size() - 1) + 0.5);
+    return times[std::min(index, times.size() - 1)];
+}
+
+static void report(const char* name, const FrameTimes& times)
+{
+    static const double c_edges[] = {2500, 3000, 4000, 6000, 10000, 20000};
+
+    std::cout << std::left << std::setw(32) << name << std::right << std::fixed << std::setprecision(2)
+              << " p50 " << std::setw(7) << percentile(times, 0.5) / 1000
+              << " ms  p90 " << std::setw(7) << percentile(times, 0.9) / 1000
+              << " ms  p99 " << std::setw(7) << percentile(times, 0.99) / 1000
+              << " ms  max " << std::setw(7) << times.back() / 1000 << " ms  |";
+
+    auto it = times.begin();
+    for (double edge : c_edges)
+    {
+        const auto end = std::lower_bound(it, times.end(), edge);
+        std::cout << std::setw(5) << (end - it);
+        it = end;
+    }
+    std::cout << std::setw(5) << (times.end() - it) << std::endl;
+}
+
+static void reportStalls(const AsyncSink& sink)
+{
+    const AsyncSink::Stats stats = sink.stats();
+    std::cout << "  waited for the file " << stats.stalls << " times, "
+              << std::chrono::duration<double, std::milli>(stats.stallTime).count() << " ms" << std::endl;
+}
+
+static void writeAll(int fd, const std::string& data)
+{
+    for (size_t written = 0; written < data.size();)
+    {
+#ifdef _WIN32
+        const auto n = ::_write(fd, data.data() + written, static_cast<unsigned>(data.size() - written));
+#else
+        const auto n = ::write(fd, data.data() + written, data.size() - written);
+#endif
+        if (n <= 0)
+            return;
+        written += static_cast<size_t>(n);
+    }
+}
+
+#ifndef _WIN32
+
+// Pipe read by a thread at a limited rate, as a slow device. Writes block once it is full.
+class ThrottledPipe
+{
+public:
+
+    ThrottledPipe(double bytesPerSecond)
+    {
+        int fds[2];
+        if (::pipe(fds) != 0)
+            return;
+        m_fd = fds[1];
+        m_reader = std::thread([fd = fds[0], bytesPerSecond] {
+            // Each read takes its time at the given rate, idle time is not made up for
+            char block[16 * 1024];
+            for (ssize_t n; (n = ::read(fd, block, sizeof(block))) > 0;)
+            {
+                std::this_thread::sleep_for(std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(static_cast<double>(n) / bytesPerSecond)));
+            }
+            ::close(fd);
+        });
+    }
+
+    ~ThrottledPipe()
+    {
+        if (m_fd < 0)
+            return;
+        ::close(m_fd);
+        m_reader.join();
+    }
+
+    int fd() const { return m_fd; }
+
+private:
+
+    int m_fd = -1;
+    std::thread m_reader;
+};
+
+#endif
+
+TEST_CASE("Snapshot frame times")
+{
+    constexpr size_t c_bodies = 20000;
+    constexpr size_t c_frames = 500;
+
+    World world;
+    world.bodies.resize(c_bodies);
+    for (size_t n = 0; n < c_bodies; ++n)
+    {
+        world.bodies[n].id = static_cast<int>(n);
+        world.bodies[n].velocity = static_cast<double>(n % 100);
+        world.bodies[n].name = "body" + std::to_string(n);
+    }
+    const ponder::UserObject state = ponder::UserObject::makeRef(world);
+
+    auto jsonTo = [&](auto& target) {
+        ponder::archive::RapidJsonStreamWriter archive(target);
+        ponder::archive::ArchiveWriter(archive).write(archive.root(), state);
+        archive.finish();
+    };
+    auto binary = [&] {
+        std::string storage;
+        ponder::archive::BinaryArchiveWriter archive(storage);
+        ponder::archive::ArchiveWriter(archive).write(archive.root(), state);
+        archive.finish();
+        return storage;
+    };
+
+    std::cout << c_bodies << " bodies, a snapshot every 10 frames of 2 ms: binary " << binary().size()
+              << " bytes" << std::endl
+              << "Histogram of frame times: <2.5 <3 <4 <6 <10 <20 >=20 ms" << std::endl;
+
+    report("no snapshot", runFrames(world, c_frames, nullptr));
+
+    // The sink holds a whole snapshot, so that it only waits if the device can't keep up
+    constexpr size_t c_sinkBuffer = 4 * 1024 * 1024;
+
+    auto compare = [&](const std::string& device, int fd) {
+        report(("JSON to " + device).c_str(), runFrames(world, c_frames, [&] { jsonTo(fd); }));
+        {
+            AsyncSink sink(fd, c_sinkBuffer);
+            report(("JSON through sink to " + device).c_str(),
+                   runFrames(world, c_frames, [&] { jsonTo(sink); }));
+            reportStalls(sink);
+        }
+
+        Clock::duration writeTime{};
+        report(("binary to " + device).c_str(), runFrames(world, c_frames, [&] {
+            const std::string storage = binary();
+            const auto start = Clock::now();
+            writeAll(fd, storage);
+            writeTime += Clock::now() - start;
+        }));
+        std::cout << "  write(2) took " << std::chrono::duration<double, std::milli>(writeTime).count()
+                                           / static_cast<double>(c_frames / 10)
+                  << " ms per snapshot" << std::endl;
+        {
+            AsyncSink sink(fd, c_sinkBuffer);
+            report(("binary through sink to " + device).c_str(), runFrames(world, c_frames, [&] {
+                sink.write(binary());
+                sink.flush();
+            }));
+            reportStalls(sink);
+        }
+    };
+
+    const std::string path = (std::filesystem::temp_directory_path() / "ponderbench.snapshots").string();
+    const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    compare("file", fd);
+    ::close(fd);
+    std::filesystem::remove(path);
+
+#ifndef _WIN32
+    {
+        ThrottledPipe pipe(50.0 * 1024 * 1024);
+        REQUIRE(pipe.fd() >= 0);
+        compare("50 MB/s", pipe.fd());
+    }
+#endif
+}
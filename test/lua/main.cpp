@@ -33,6 +33,7 @@
 #include <ponder/uses/lua.hpp>
 #include <cstdio>
 #include <cmath>
+#include <map>
 
 extern "C" {
 #include <lualib.h>
@@ -115,6 +116,11 @@ namespace lib
 
     enum class Colour { Red, Green, Blue };
 
+    struct Inventory
+    {
+        std::map<std::string, int> counts{{"apples", 3}, {"pears", 7}};
+    };
+
     struct Parsing
     {
         int a{0};
@@ -190,6 +196,11 @@ namespace lib
             .property("a", &Parsing::a)
             .property("b", &Parsing::b)
             ;
+
+        Class::declare<Inventory>()
+            .constructor()
+            .property("counts", &Inventory::counts)
+            ;
     }
 
 } // namespace lib
@@ -202,6 +213,7 @@ PONDER_TYPE(lib::Types::Obj)
 PONDER_TYPE(lib::Static)
 PONDER_TYPE(lib::Colour)
 PONDER_TYPE(lib::Parsing)
+PONDER_TYPE(lib::Inventory)
 
 static bool luaTest(lua_State *L, const char *source, int lineNb, bool success = true)
 {
@@ -242,6 +254,7 @@ int main()
     ponder::lua::expose<lib::Static>(L, "Static");
     ponder::lua::expose<lib::Colour>(L, "Colour");
     ponder::lua::expose<lib::Parsing>(L, "Parsing");
+    ponder::lua::expose<lib::Inventory>(L, "Inventory");
 
     //------------------------------------------------------------------
 
@@ -344,6 +357,16 @@ int main()
     LUA_PASS("p = Parsing(); assert(type(p)=='userdata')");
     LUA_PASS("p:init{a=77, b='w00t'}; assert(p.a == 77 and p.b == 'w00t')");
 
+    //------------------------------------------------------------------
+
+    // Maps
+    LUA_PASS("inv = Inventory(); m = inv.counts; assert(#m == 2)");
+    LUA_PASS("assert(m.apples == 3 and m['pears'] == 7 and m.plums == nil)");
+    LUA_PASS("m.plums = 5; assert(#inv.counts == 3 and inv.counts.plums == 5)");
+    LUA_PASS("m.apples = nil; assert(#m == 2 and m.apples == nil)");
+    LUA_PASS("n = 0; for k,v in pairs(m) do n = n + v end; assert(n == 12)");
+    LUA_FAIL("m.pears = 'fail'");
+
     lua_close(L);
 
     //printf("lib::Vec::instanceCount = %d\n", lib::Vec::instanceCount);
@@ -276,3 +276,145 @@ TEST_CASE_METHOD(ArrayPropertyFixture, "Property arrays can be removed from")
 }
 
 
+
+TEST_CASE_METHOD(ArrayPropertyFixture, "Contiguous property arrays can be accessed directly")
+{
+    SECTION("contiguous arrays are detected")
+    {
+        REQUIRE(bools->contiguous() == true);
+        REQUIRE(ints->contiguous() == true);
+        REQUIRE(longints->contiguous() == true);
+        REQUIRE(strings->contiguous() == true);
+        REQUIRE(objects->contiguous() == false);
+    }
+
+    SECTION("spans view the elements")
+    {
+        ponder::ArraySpan<int> span = ints->span<int>(&object);
+        REQUIRE(span.data() == object.ints.data());
+        REQUIRE(span.size() == object.ints.size());
+
+        span[1] = 42;
+        REQUIRE(object.ints[1] == 42);
+
+        ponder::ArraySpan<const ponder::String> cspan = strings->span<const ponder::String>(&object);
+        REQUIRE(cspan.size() == 4);
+        REQUIRE(cspan[2] == "string 2");
+
+        REQUIRE_THROWS_AS(ints->span<long long>(&object), ponder::BadType);
+        REQUIRE_THROWS_AS(objects->span<MyType>(&object), ponder::BadType);
+    }
+
+    SECTION("elements can be copied out")
+    {
+        std::vector<long long> longs;
+        longints->getElements(&object, longs);
+        REQUIRE(longs == std::vector<long long>(object.longints.begin(), object.longints.end()));
+
+        // not contiguous, or converted
+        std::vector<MyType> types;
+        objects->getElements(&object, types);
+        REQUIRE(types == std::vector<MyType>(object.objects.begin(), object.objects.end()));
+
+        std::vector<long long> converted;
+        ints->getElements(&object, converted);
+        REQUIRE(converted == std::vector<long long>{-10, 10, 100});
+    }
+
+    SECTION("elements can be copied in")
+    {
+        const ponder::String strs[] = {"a", "b"};
+        strings->setElements(&object, strs, 2);
+        REQUIRE(object.strings == std::vector<ponder::String>{"a", "b"});
+
+        const int someInts[] = {1, 2};
+        ints->setElements(&object, someInts, 2);
+        REQUIRE(object.ints[0] == 1);
+        REQUIRE(object.ints[1] == 2);
+        REQUIRE(object.ints[2] == 100);
+
+        const MyType types[] = {MyType(7)};
+        objects->setElements(&object, types, 1);
+        REQUIRE(object.objects.size() == 1);
+        REQUIRE(object.objects.front() == MyType(7));
+
+        const int tooMany[] = {1, 2, 3, 4};
+        REQUIRE_THROWS_AS(ints->setElements(&object, tooMany, 4), ponder::OutOfRange);
+    }
+}
+
+TEST_CASE_METHOD(ArrayPropertyFixture, "Property arrays can be walked with a cursor")
+{
+    SECTION("cursors visit all elements in order")
+    {
+        size_t count = 0;
+        for (ponder::ArrayCursor it = objects->cursor(&object); it.valid(); it.next())
+        {
+            REQUIRE(it.index() == count);
+            REQUIRE(it.get().to<MyType>().x == static_cast<int>(count));
+            ++count;
+        }
+        REQUIRE(count == object.objects.size());
+
+        std::vector<ponder::String> strs;
+        for (ponder::ArrayCursor it = strings->cursor(&object); it.valid(); it.next())
+            strs.push_back(it.get().to<ponder::String>());
+        REQUIRE(strs == object.strings);
+    }
+
+    SECTION("cursors give user objects in place")
+    {
+        for (ponder::ArrayCursor it = objects->cursor(&object); it.valid(); it.next())
+            REQUIRE(&it.getObject().get<MyType>() == &*std::next(object.objects.begin(), it.index()));
+
+        ponder::ArrayCursor it = strings->cursor(&object);
+        REQUIRE_THROWS_AS(it.getObject(), ponder::BadType);
+    }
+
+    SECTION("cursors can set elements")
+    {
+        int x = 10;
+        for (ponder::ArrayCursor it = objects->cursor(&object); it.valid(); it.next())
+            it.set(MyType(x++));
+        REQUIRE(object.objects.front() == MyType(10));
+        REQUIRE(object.objects.back() == MyType(14));
+
+        ponder::ArrayCursor it = ints->cursor(&object);
+        it.next();
+        it.set(7);
+        REQUIRE(object.ints[1] == 7);
+    }
+
+    SECTION("cursors past the end can't be accessed")
+    {
+        ponder::ArrayCursor it = bools->cursor(&object);
+        it.next();
+        it.next();
+        REQUIRE(it.valid() == false);
+        REQUIRE_THROWS_AS(it.get(), ponder::OutOfRange);
+        REQUIRE_THROWS_AS(it.set(true), ponder::OutOfRange);
+    }
+}
+
+TEST_CASE_METHOD(ArrayPropertyFixture, "Property arrays can be resized")
+{
+    REQUIRE_THROWS_AS(ints->resize(&object, 5),  ponder::ForbiddenWrite);
+    REQUIRE_THROWS_AS(ints->reserve(&object, 5), ponder::ForbiddenWrite);
+
+    strings->reserve(&object, 100);
+    REQUIRE(object.strings.capacity() >= 100);
+    REQUIRE(object.strings.size() == 4);
+
+    strings->resize(&object, 6);
+    REQUIRE(object.strings.size() == 6);
+    REQUIRE(object.strings[3] == "string 3");
+    REQUIRE(object.strings[5].empty());
+
+    strings->resize(&object, 1);
+    REQUIRE(object.strings == std::vector<ponder::String>{"string 0"});
+
+    objects->reserve(&object, 100); // not supported by lists, ignored
+    objects->resize(&object, 7);
+    REQUIRE(object.objects.size() == 7);
+    REQUIRE(object.objects.back() == MyType());
+}
@@ -206,6 +206,17 @@ TEST_CASE("Classes support inheritence")
         REQUIRE(class4->property("p4").get(base4) == ponder::Value(40));
     }
 
+    SECTION("expose member addresses through bases")
+    {
+        MyClass4 object4;
+
+        REQUIRE(class4->property("p1").memberPointer<int>(&object4) == &object4.p1);
+        REQUIRE(class4->property("p2").memberPointer<int>(&object4) == &object4.p2);
+        REQUIRE(class4->property("p3").memberPointer<int>(&object4) == &object4.p3);
+        REQUIRE(class4->property("p4").memberPointer<int>(&object4) == &object4.p4);
+        REQUIRE(class2->property("p2").memberPointer<int>(&object4) == &object4.p2);
+    }
+
 //    SECTION("can override functions in derived class")
 //    {
 //        MyClass1 object1;
@@ -0,0 +1,232 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+// Tests for MapProperty:
+//  - Exposed associative containers whose entries are accessed via keys.
+
+#include <ponder/classbuilder.hpp>
+#include <ponder/mapproperty.hpp>
+#include <ponder/observer.hpp>
+#include "test.hpp"
+#include <map>
+#include <unordered_map>
+
+namespace MapPropertyTest
+{
+    struct MyType
+    {
+        MyType() : x(-1) {}
+
+        MyType(int x_) : x(x_) {}
+
+        int x;
+    };
+
+    struct MyClass
+    {
+        MyClass()
+        {
+            ints["one"] = 1;
+            ints["two"] = 2;
+            ints["three"] = 3;
+
+            objects[10] = MyType(100);
+            objects[20] = MyType(200);
+        }
+
+        std::map<ponder::String, int> ints;
+        std::unordered_map<int, MyType> objects;
+    };
+
+    void declare()
+    {
+        ponder::Class::declare<MyType>("MapPropertyTest::MyType")
+            .property("x", &MyType::x)
+            ;
+
+        ponder::Class::declare<MyClass>("MapPropertyTest::MyClass")
+            .property("ints", &MyClass::ints)
+            .property("objects", &MyClass::objects)
+            ;
+    }
+}
+
+PONDER_AUTO_TYPE(MapPropertyTest::MyType, &MapPropertyTest::declare)
+PONDER_AUTO_TYPE(MapPropertyTest::MyClass, &MapPropertyTest::declare)
+
+using namespace MapPropertyTest;
+
+
+struct MapPropertyFixture
+{
+    MapPropertyFixture()
+    {
+        const ponder::Class& metaclass = ponder::classByType<MyClass>();
+        ints    = &static_cast<const ponder::MapProperty&>(metaclass.property("ints"));
+        objects = &static_cast<const ponder::MapProperty&>(metaclass.property("objects"));
+    }
+
+    const ponder::MapProperty* ints;
+    const ponder::MapProperty* objects;
+    MyClass object;
+};
+
+//-----------------------------------------------------------------------------
+//                         Tests for ponder::MapProperty
+//-----------------------------------------------------------------------------
+
+TEST_CASE_METHOD(MapPropertyFixture, "Map property can be inspected")
+{
+    SECTION("should be map type")
+    {
+        REQUIRE(ints->kind() == ponder::ValueKind::Map);
+        REQUIRE(objects->kind() == ponder::ValueKind::Map);
+    }
+
+    SECTION("has key and mapped types")
+    {
+        REQUIRE(ints->keyType() == ponder::ValueKind::String);
+        REQUIRE(ints->mappedType() == ponder::ValueKind::Integer);
+        REQUIRE(objects->keyType() == ponder::ValueKind::Integer);
+        REQUIRE(objects->mappedType() == ponder::ValueKind::User);
+    }
+
+    SECTION("has a size")
+    {
+        REQUIRE(ints->size(&object) == object.ints.size());
+        REQUIRE(objects->size(&object) == object.objects.size());
+    }
+}
+
+TEST_CASE_METHOD(MapPropertyFixture, "Map property entries can be looked up")
+{
+    SECTION("by existing key")
+    {
+        REQUIRE(ints->contains(&object, "two"));
+        REQUIRE(ints->get(&object, "two") == ponder::Value(2));
+        REQUIRE(objects->get(&object, 20).to<MyType>().x == 200);
+    }
+
+    SECTION("by missing key")
+    {
+        REQUIRE_FALSE(ints->contains(&object, "four"));
+        REQUIRE_THROWS_AS(ints->get(&object, "four"), ponder::KeyNotFound);
+        REQUIRE_THROWS_AS(objects->get(&object, 30), ponder::KeyNotFound);
+    }
+}
+
+TEST_CASE_METHOD(MapPropertyFixture, "Map property entries can be written")
+{
+    SECTION("by assigning an existing key")
+    {
+        ints->set(&object, "one", 11);
+        REQUIRE(object.ints["one"] == 11);
+        REQUIRE(object.ints.size() == 3);
+    }
+
+    SECTION("by inserting a new key")
+    {
+        ints->set(&object, "four", 4);
+        objects->set(&object, 30, MyType(300));
+        REQUIRE(object.ints["four"] == 4);
+        REQUIRE(object.objects[30].x == 300);
+    }
+
+    SECTION("by inserting a default value")
+    {
+        REQUIRE(objects->getOrInsert(&object, 10).to<MyType>().x == 100);
+        REQUIRE(objects->getOrInsert(&object, 40).to<MyType>().x == -1);
+        REQUIRE(object.objects.size() == 3);
+
+        // User objects refer to the entry
+        objects->getOrInsert(&object, 40).to<ponder::UserObject>().set("x", 400);
+        REQUIRE(object.objects[40].x == 400);
+    }
+
+    SECTION("observers are notified once the key is inserted")
+    {
+        struct SizeLog : ponder::PropertyObserver
+        {
+            const MyClass* object = nullptr;
+            size_t size = 0;
+
+            void propertyChanged(const ponder::UserObject&, const ponder::Property&) override
+            {
+                size = object->objects.size();
+            }
+        };
+
+        SizeLog log;
+        log.object = &object;
+        ponder::addPropertyObserver(*objects, &log);
+        objects->getOrInsert(&object, 40);
+        ponder::removePropertyObserver(*objects, &log);
+        REQUIRE(log.size == 3);
+    }
+
+    SECTION("by erasing a key")
+    {
+        REQUIRE(ints->erase(&object, "two"));
+        REQUIRE_FALSE(ints->erase(&object, "two"));
+        REQUIRE(object.ints.count("two") == 0);
+    }
+}
+
+TEST_CASE_METHOD(MapPropertyFixture, "Map property entries can be walked with a cursor")
+{
+    SECTION("visits every entry in container order")
+    {
+        std::vector<ponder::String> keys;
+        int sum = 0;
+        for (ponder::MapCursor it = ints->cursor(&object); it.valid(); it.next())
+        {
+            keys.push_back(it.key().to<ponder::String>());
+            sum += it.value().to<int>();
+        }
+        REQUIRE(keys == std::vector<ponder::String>({"one", "three", "two"}));
+        REQUIRE(sum == 6);
+    }
+
+    SECTION("can write the current entry")
+    {
+        for (ponder::MapCursor it = ints->cursor(&object); it.valid(); it.next())
+            it.setValue(it.value().to<int>() * 10);
+        REQUIRE(object.ints["three"] == 30);
+    }
+
+    SECTION("is bounded")
+    {
+        ponder::MapCursor it = objects->cursor(&object);
+        REQUIRE(it.size() == 2);
+        it.next();
+        it.next();
+        REQUIRE_FALSE(it.valid());
+        REQUIRE_THROWS_AS(it.key(), ponder::OutOfRange);
+    }
+}
@@ -0,0 +1,222 @@
+/****************************************************************************
+**
+** This file is part of the Ponder library, formerly CAMP.
+**
+** The MIT License (MIT)
+**
+** Copyright (C) 2009-2014 TEGESO/TEGESOFT and/or its subsidiary(-ies) and mother company.
+** Copyright (C) 2015-2020 Nick Trout.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+** THE SOFTWARE.
+**
+****************************************************************************/
+
+// Tests for object diffs and patches:
+//  - Changes between two instances, applied to a third one.
+
+#include <ponder/classbuilder.hpp>
+#include <ponder/uses/runtime.hpp>
+#include <ponder/uses/serialise.hpp>
+#include <ponder/uses/archive/rapidjson.hpp>
+#include "test.hpp"
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+#include <list>
+#include <map>
+#include <vector>
+
+namespace PatchTest
+{
+    struct Point
+    {
+        Point(int x_ = 0, int y_ = 0) : x(x_), y(y_) {}
+        int x, y;
+    };
+
+    struct Shape
+    {
+        ponder::String name;
+        Point origin;
+        std::vector<Point> points;
+        std::list<Point> trail;
+        std::vector<int> ids;
+        std::map<ponder::String, int> attributes;
+    };
+
+    void declare()
+    {
+        ponder::Class::declare<Point>("PatchTest::Point")
+            .property("x", &Point::x)
+            .property("y", &Point::y)
+            ;
+
+        ponder::Class::declare<Shape>("PatchTest::Shape")
+            .property("name", &Shape::name)
+            .property("origin", &Shape::origin)
+            .property("points", &Shape::points)
+            .property("trail", &Shape::trail)
+            .property("ids", &Shape::ids)
+            .property("attributes", &Shape::attributes)
+            ;
+    }
+
+    Shape makeShape()
+    {
+        Shape shape;
+        shape.name = "square";
+        shape.origin = Point(1, 2);
+        shape.points = {Point(0, 0), Point(1, 0), Point(1, 1), Point(0, 1)};
+        shape.trail = {Point(0, 0), Point(2, 2), Point(4, 4)};
+        shape.ids = {1, 2, 3, 4, 5};
+        shape.attributes = {{"colour", 3}, {"layer", 1}};
+        return shape;
+    }
+}
+
+PONDER_AUTO_TYPE(PatchTest::Point, &PatchTest::declare)
+PONDER_AUTO_TYPE(PatchTest::Shape, &PatchTest::declare)
+
+using namespace PatchTest;
+
+//-----------------------------------------------------------------------------
+//                         Tests for runtime::diff
+//-----------------------------------------------------------------------------
+
+TEST_CASE("Patches describe the changes between objects")
+{
+    Shape from = makeShape(), to = makeShape(), patched = makeShape();
+    const ponder::UserObject fromObject(&from), toObject(&to), patchedObject(&patched);
+
+    SECTION("equal objects have an empty patch")
+    {
+        REQUIRE(ponder::runtime::diff(fromObject, toObject).empty());
+    }
+
+    SECTION("changes of composed objects are recorded by path")
+    {
+        to.origin.y = 5;
+
+        const ponder::runtime::Patch patch = ponder::runtime::diff(fromObject, toObject);
+        REQUIRE(patch.size() == 1);
+        IS_TRUE(patch[0].kind == ponder::runtime::PatchOp::Kind::Set);
+        REQUIRE(patch[0].path.size() == 2);
+        REQUIRE(patch[0].path[0].property == "origin");
+        REQUIRE(patch[0].path[1].property == "y");
+        REQUIRE(patch[0].value.to<int>() == 5);
+
+        ponder::runtime::applyPatch(patchedObject, patch);
+        REQUIRE(patched.origin.y == 5);
+        IS_TRUE(ponder::runtime::deepEqual(patchedObject, toObject));
+    }
+
+    SECTION("array elements are changed, inserted and removed")
+    {
+        to.ids = {1, 2, 9, 3, 4, 5};              // insert in the middle
+        to.points.erase(to.points.begin() + 1);   // remove in the middle
+        to.points[0].x = 7;
+
+        const ponder::runtime::Patch patch = ponder::runtime::diff(fromObject, toObject);
+        REQUIRE(patch.size() == 3);
+
+        ponder::runtime::applyPatch(patchedObject, patch);
+        REQUIRE(patched.ids == to.ids);
+        REQUIRE(patched.points.size() == 3);
+        IS_TRUE(ponder::runtime::deepEqual(patchedObject, toObject));
+    }
+
+    SECTION("arrays can grow and shrink")
+    {
+        to.ids = {1, 2};
+        to.points.emplace_back(5, 5);
+        to.points.emplace_back(6, 6);
+
+        ponder::runtime::applyPatch(patchedObject, ponder::runtime::diff(fromObject, toObject));
+        IS_TRUE(ponder::runtime::deepEqual(patchedObject, toObject));
+    }
+
+    SECTION("list elements are diffed in place")
+    {
+        to.trail.front().y = 1;
+        to.trail.insert(std::next(to.trail.begin(), 2), Point(3, 3));
+
+        const ponder::runtime::Patch patch = ponder::runtime::diff(fromObject, toObject);
+        REQUIRE(patch.size() == 2);
+        REQUIRE(patch[0].path.size() == 2);
+        REQUIRE(patch[0].path[0].key.to<int>() == 0);
+        REQUIRE(patch[0].path[1].property == "y");
+        IS_TRUE(patch[1].kind == ponder::runtime::PatchOp::Kind::Insert);
+        REQUIRE(patch[1].path[0].key.to<int>() == 2);
+
+        // Inserted elements are copies, not references to the source list
+        const std::list<Point> expected = to.trail;
+        to.trail.clear();
+        ponder::runtime::applyPatch(patchedObject, patch);
+        REQUIRE(patched.trail.size() == 4);
+        auto it = patched.trail.begin();
+        for (const Point& point : expected)
+        {
+            REQUIRE(it->x == point.x);
+            REQUIRE(it->y == point.y);
+            ++it;
+        }
+    }
+
+    SECTION("map entries are changed, added and removed")
+    {
+        to.attributes.erase("layer");
+        to.attributes["colour"] = 4;
+        to.attributes["weight"] = 2;
+        to.name = "diamond";
+
+        ponder::runtime::applyPatch(patchedObject, ponder::runtime::diff(fromObject, toObject));
+        REQUIRE(patched.attributes == to.attributes);
+        REQUIRE(patched.name == "diamond");
+    }
+
+    SECTION("patches can be written to an archive")
+    {
+        to.origin.x = 3;
+        to.ids.push_back(6);
+
+        const ponder::runtime::Patch patch = ponder::runtime::diff(fromObject, toObject);
+
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+        using Archive = ponder::archive::RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>;
+        Archive archive(writer);
+        ponder::archive::ArchiveWriter<Archive> archiveWriter(archive);
+        writer.StartObject();
+        archiveWriter.write(nullptr, patch);
+        writer.EndObject();
+
+        // Properties are visited in the order of the metaclass
+        REQUIRE(ponder::String(sb.GetString()) ==
+                "{\"patch\":["
+                "{\"op\":\"insert\",\"path\":[{\"property\":\"ids\",\"key\":5}],\"value\":6},"
+                "{\"op\":\"set\",\"path\":[{\"property\":\"origin\"},{\"property\":\"x\"}],\"value\":3}"
+                "]}");
+    }
+
+    SECTION("objects of different classes can't be compared")
+    {
+        Point point;
+        REQUIRE_THROWS_AS(ponder::runtime::diff(fromObject, ponder::UserObject(&point)),
+                          ponder::ClassUnrelated);
+    }
+}
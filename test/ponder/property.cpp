@@ -100,6 +100,11 @@ namespace PropertyTest
         void setT(const MyType * t) { mt = *t; }
     };
 
+    struct Constants
+    {
+        const int ci = 42;
+    };
+
 #define FUNCTION_ACCESSORS(T,N) \
     T& rw_##N(MyClass& c) {return c.N;} \
     const T& r_##N(const MyClass& c) {return c.N;} \
@@ -150,6 +155,10 @@ namespace PropertyTest
             .property("myType", &MyClass::getCT, &MyClass::setT)
             ;
 
+        ponder::Class::declare<Constants>("PropertyTest::Constants")
+            .property("ci", &Constants::ci)
+            ;
+
         // ***** std::function *****
 //            .property("p18", std::function<int(MyClass&)>(&MyClass::get18))   // function getter
 //              // read-write getter
@@ -173,6 +182,7 @@ namespace PropertyTest
 PONDER_AUTO_TYPE(PropertyTest::MyEnum,  &PropertyTest::declare)
 PONDER_AUTO_TYPE(PropertyTest::MyType,  &PropertyTest::declare)
 PONDER_AUTO_TYPE(PropertyTest::MyClass, &PropertyTest::declare)
+PONDER_AUTO_TYPE(PropertyTest::Constants, &PropertyTest::declare)
 
 using namespace PropertyTest;
 
@@ -326,6 +336,45 @@ TEST_CASE("Classes can have properties")
         CHECK_PROP_SET(s,std::string("The Reverend Black Grape"))
         CHECK_PROP_SET(e,Two)
     }
+
+    SECTION("member layout")
+    {
+        MyClass c;
+        ponder::UserObject object(&c);
+        const char* base = reinterpret_cast<const char*>(&c);
+
+#define CHECK_PROP_MEMBER(T,N) \
+        REQUIRE((metaclass.property("m_" #N).propertyKind() == ponder::PropertyKind::MemberObject)); \
+        REQUIRE(metaclass.property("m_" #N).memberOffset() \
+                == static_cast<size_t>(reinterpret_cast<const char*>(&c.N) - base)); \
+        REQUIRE(metaclass.property("m_" #N).memberType() == ponder::TypeId(typeid(T))); \
+        REQUIRE(metaclass.property("m_" #N).memberPointer<T>(object) == &c.N); \
+        REQUIRE((metaclass.property("mf_rw_" #N).propertyKind() == ponder::PropertyKind::Function)); \
+        REQUIRE(metaclass.property("mf_rw_" #N).memberType() == ponder::TypeId(typeid(void))); \
+        REQUIRE_THROWS_AS(metaclass.property("mf_rw_" #N).memberPointer<T>(object), \
+                          ponder::BadType)
+
+        CHECK_PROP_MEMBER(bool,b);
+        CHECK_PROP_MEMBER(int,i);
+        CHECK_PROP_MEMBER(long long,ll);
+        CHECK_PROP_MEMBER(float,f);
+        CHECK_PROP_MEMBER(double,d);
+        CHECK_PROP_MEMBER(std::string,s);
+        CHECK_PROP_MEMBER(MyEnum,e);
+
+        REQUIRE_THROWS_AS(metaclass.property("m_i").memberPointer<float>(object), ponder::BadType);
+        REQUIRE_THROWS_AS(metaclass.property("m_i").memberPointer<int>(ponder::UserObject::nothing),
+                          ponder::NullObject);
+
+        *metaclass.property("m_d").memberPointer<double>(object) = 12.5;
+        REQUIRE(c.d == 12.5);
+
+        // A const member can't be accessed as mutable
+        Constants constants;
+        const ponder::Property& ci = ponder::classByType<Constants>().property("ci");
+        REQUIRE(ci.memberPointer<const int>(&constants) == &constants.ci);
+        REQUIRE_THROWS_AS(ci.memberPointer<int>(&constants), ponder::BadType);
+    }
 }
 
 
@@ -45,12 +45,21 @@ namespace PropertyAccessTest
         [[nodiscard]] int get() const {return p;}
         int& ref() {return p;}
         int p = 0;
+        double d = 1.5;
+        std::string s;
 
         bool m_b;
         bool b1() {return true;}
         [[nodiscard]] bool b2() const {return false;}
     };
 
+    struct Fixed
+    {
+        explicit Fixed(int i = 0) : id(i) {}
+
+        const int id;
+    };
+
     void declare()
     {
         using namespace std::placeholders;
@@ -59,11 +68,18 @@ namespace PropertyAccessTest
             .property("p8",  &MyClass::get)
             .property("p9",  &MyClass::ref)
             .property("p10", &MyClass::get, &MyClass::set)
+            .property("d", &MyClass::d)
+            .property("s", &MyClass::s)
+            ;
+
+        ponder::Class::declare<Fixed>("PropertyAccessTest::Fixed")
+            .property("id", &Fixed::id)
             ;
     }
 }
 
 PONDER_AUTO_TYPE(PropertyAccessTest::MyClass, &PropertyAccessTest::declare)
+PONDER_AUTO_TYPE(PropertyAccessTest::Fixed, &PropertyAccessTest::declare)
 
 using namespace PropertyAccessTest;
 
@@ -99,3 +115,140 @@ TEST_CASE("Properties can be accessed")
     }
 }
 
+
+TEST_CASE("Properties can be accessed with typed accessors")
+{
+    MyClass object;
+
+    const ponder::Class* metaclass = &ponder::classByType<MyClass>();
+
+    SECTION("get")
+    {
+        object.p = 7;
+        REQUIRE(ponder::PropertyAccessor<int>(metaclass->property("p8")).get(&object) == 7);
+        REQUIRE(ponder::PropertyAccessor<int>(metaclass->property("p9")).get(&object) == 7);
+        REQUIRE(ponder::PropertyAccessor<int>(metaclass->property("p10")).get(&object) == 7);
+        REQUIRE(ponder::PropertyAccessor<double>(metaclass->property("d")).get(&object) == 1.5);
+    }
+
+    SECTION("set")
+    {
+        ponder::PropertyAccessor<int>(metaclass->property("p9")).set(&object, 9);
+        REQUIRE(object.p == 9);
+        ponder::PropertyAccessor<int>(metaclass->property("p10")).set(&object, 10);
+        REQUIRE(object.p == 10);
+        ponder::PropertyAccessor<double>(metaclass->property("d")).set(&object, 2.5);
+        REQUIRE(object.d == 2.5);
+        ponder::PropertyAccessor<std::string>(metaclass->property("s")).set(&object, "hello");
+        REQUIRE(object.s == "hello");
+
+        REQUIRE_THROWS_AS(ponder::PropertyAccessor<int>(metaclass->property("p8")).set(&object, 8),
+                          ponder::ForbiddenWrite);
+    }
+
+    SECTION("type mismatch")
+    {
+        REQUIRE_THROWS_AS(ponder::PropertyAccessor<double>(metaclass->property("p10")),
+                          ponder::BadType);
+        REQUIRE_THROWS_AS(ponder::PropertyAccessor<float>(metaclass->property("d")),
+                          ponder::BadType);
+    }
+
+    SECTION("gather")
+    {
+        std::vector<MyClass> objects(5);
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            objects[i].p = static_cast<int>(i * 10);
+            objects[i].d = static_cast<double>(i) + 0.5;
+        }
+
+        std::vector<double> ds(objects.size());
+        ponder::PropertyAccessor<double>(metaclass->property("d"))
+            .gather(objects.data(), objects.size(), ds.data());
+        REQUIRE(ds == std::vector<double>{0.5, 1.5, 2.5, 3.5, 4.5});
+
+        std::vector<int> ps(objects.size());
+        ponder::PropertyAccessor<int>(metaclass->property("p10"))
+            .gather(objects.data(), objects.size(), ps.data());
+        REQUIRE(ps == std::vector<int>{0, 10, 20, 30, 40});
+
+        std::vector<ponder::UserObject> userObjects;
+        for (auto& o : objects)
+            userObjects.push_back(ponder::UserObject::makeRef(o));
+        std::fill(ds.begin(), ds.end(), 0.0);
+        ponder::PropertyAccessor<double>(metaclass->property("d"))
+            .gather(userObjects.data(), userObjects.size(), ds.data());
+        REQUIRE(ds == std::vector<double>{0.5, 1.5, 2.5, 3.5, 4.5});
+    }
+
+    SECTION("scatter")
+    {
+        std::vector<MyClass> objects(3);
+
+        const std::vector<double> ds{1.0, 2.0, 3.0};
+        ponder::PropertyAccessor<double>(metaclass->property("d"))
+            .scatter(objects.data(), objects.size(), ds.data());
+        REQUIRE(objects[0].d == 1.0);
+        REQUIRE(objects[2].d == 3.0);
+
+        const std::vector<int> ps{4, 5, 6};
+        ponder::PropertyAccessor<int>(metaclass->property("p10"))
+            .scatter(objects.data(), objects.size(), ps.data());
+        REQUIRE(objects[0].p == 4);
+        REQUIRE(objects[2].p == 6);
+
+        REQUIRE_THROWS_AS(ponder::PropertyAccessor<int>(metaclass->property("p8"))
+                              .scatter(objects.data(), objects.size(), ps.data()),
+                          ponder::ForbiddenWrite);
+    }
+
+    SECTION("stride")
+    {
+        struct Entry
+        {
+            int id;
+            MyClass object;
+        };
+        Entry entries[3];
+        for (int i = 0; i < 3; ++i)
+            entries[i].object.p = i + 1;
+
+        ponder::PropertyAccessor<double>(metaclass->property("d"))
+            .scatter(&entries[0].object, 3, std::vector<double>{7.0, 8.0, 9.0}.data(), sizeof(Entry));
+        REQUIRE(entries[1].object.d == 8.0);
+
+        double ds[3];
+        ponder::PropertyAccessor<double>(metaclass->property("d"))
+            .gather(&entries[0].object, 3, ds, sizeof(Entry));
+        REQUIRE(ds[2] == 9.0);
+
+        int ps[3];
+        ponder::PropertyAccessor<int>(metaclass->property("p8"))
+            .gather(&entries[0].object, 3, ps, sizeof(Entry));
+        REQUIRE(ps[0] == 1);
+        REQUIRE(ps[2] == 3);
+    }
+
+    SECTION("const data member")
+    {
+        const Fixed fixed[3] = {Fixed(4), Fixed(5), Fixed(6)};
+        const ponder::PropertyAccessor<int> id(ponder::classByType<Fixed>().property("id"));
+
+        int ids[3] = {};
+        id.gather(fixed, 3, ids);
+        REQUIRE(ids[0] == 4);
+        REQUIRE(ids[2] == 6);
+
+        Fixed targets[3];
+        REQUIRE_THROWS_AS(id.scatter(targets, 3, ids), ponder::ForbiddenWrite);
+        REQUIRE(targets[0].id == 0);
+    }
+
+    SECTION("null object")
+    {
+        REQUIRE_THROWS_AS(ponder::PropertyAccessor<double>(metaclass->property("d"))
+                              .get(ponder::UserObject::nothing),
+                          ponder::NullObject);
+    }
+}
@@ -32,17 +32,35 @@
 #include "test.hpp"
 #include <ponder/uses/archive/rapidxml.hpp>
 #include <ponder/uses/archive/rapidjson.hpp>
+#include <ponder/uses/archive/binary.hpp>
+#include <ponder/uses/archive/mapped.hpp>
+#include <ponder/uses/archive/asyncsink.hpp>
 #include <ponder/uses/serialise.hpp>
 #include <ponder/classbuilder.hpp>
+#include <ponder/observer.hpp>
 #include <ponder/optionalmapper.hpp>
 #include <ponder/variantmapper.hpp>
 
 #include <rapidxml/rapidxml_print.hpp>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <optional>
+#include <array>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#ifndef _WIN32
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
 
 namespace SerialiseTest
 {
@@ -98,6 +116,19 @@ namespace SerialiseTest
         std::vector<Complex> m_v;
     };
 
+    struct Samples
+    {
+        std::vector<float> m_floats;
+        std::list<int> m_counts;
+        std::array<std::uint8_t, 4> m_bytes{};
+    };
+
+    struct Catalogue
+    {
+        std::map<std::string, int> m_counts;
+        std::unordered_map<int, Simple> m_items;
+    };
+
     template <typename T>
     struct Param
     {
@@ -130,6 +161,30 @@ namespace SerialiseTest
         std::vector<Params> params{};
     };
 
+    struct Readings
+    {
+        ParamType m_type = ParamType::i;
+        std::vector<ParamType> m_history;
+        std::map<std::string, ParamType> m_byName;
+    };
+
+    // Only used by the threaded tests, so that their types are registered lazily
+    struct Label
+    {
+        std::string text;
+    };
+
+    struct Box
+    {
+        int id = 0;
+        std::vector<Label> labels;
+    };
+
+    struct Shelf
+    {
+        std::vector<Box> boxes;
+    };
+
     static void declare()
     {
         ponder::Class::declare<test>()
@@ -161,6 +216,17 @@ namespace SerialiseTest
             .property("complex_vector", &SuperComplex::m_v)
             ;
 
+        ponder::Class::declare<Samples>()
+            .property("floats", &Samples::m_floats)
+            .property("counts", &Samples::m_counts)
+            .property("bytes", &Samples::m_bytes)
+            ;
+
+        ponder::Class::declare<Catalogue>()
+            .property("counts", &Catalogue::m_counts)
+            .property("items", &Catalogue::m_items)
+            ;
+
         ponder::Class::declare<Param_i>()
             .constructor()
             .property("value", &Param_i::value)
@@ -188,6 +254,27 @@ namespace SerialiseTest
             .property("name", &TestA::name)
             .property("params", &TestA::params)
             ;
+
+        ponder::Class::declare<Readings>()
+            .property("type", &Readings::m_type)
+            .property("history", &Readings::m_history)
+            .property("byName", &Readings::m_byName)
+            ;
+
+        ponder::Class::declare<Label>()
+            .constructor()
+            .property("text", &Label::text)
+            ;
+
+        ponder::Class::declare<Box>()
+            .constructor()
+            .property("id", &Box::id)
+            .property("labels", &Box::labels)
+            ;
+
+        ponder::Class::declare<Shelf>()
+            .property("boxes", &Shelf::boxes)
+            ;
     }
 }
 
@@ -196,11 +283,17 @@ PONDER_AUTO_TYPE(SerialiseTest::Simple, &SerialiseTest::declare)
 PONDER_AUTO_TYPE(SerialiseTest::Ref, &SerialiseTest::declare)
 PONDER_AUTO_TYPE(SerialiseTest::Complex, &SerialiseTest::declare)
 PONDER_AUTO_TYPE(SerialiseTest::SuperComplex, &SerialiseTest::declare)
+PONDER_AUTO_TYPE(SerialiseTest::Samples, &SerialiseTest::declare)
+PONDER_AUTO_TYPE(SerialiseTest::Catalogue, &SerialiseTest::declare)
 PONDER_AUTO_TYPE(SerialiseTest::Param_i, &SerialiseTest::declare)
 PONDER_AUTO_TYPE(SerialiseTest::Param_d, &SerialiseTest::declare)
 PONDER_AUTO_TYPE(SerialiseTest::ParamType, &SerialiseTest::declare)
 PONDER_AUTO_TYPE(SerialiseTest::Params, &SerialiseTest::declare)
 PONDER_AUTO_TYPE(SerialiseTest::TestA, &SerialiseTest::declare)
+PONDER_AUTO_TYPE(SerialiseTest::Readings, &SerialiseTest::declare)
+PONDER_AUTO_TYPE(SerialiseTest::Label, &SerialiseTest::declare)
+PONDER_AUTO_TYPE(SerialiseTest::Box, &SerialiseTest::declare)
+PONDER_AUTO_TYPE(SerialiseTest::Shelf, &SerialiseTest::declare)
 
 using namespace SerialiseTest;
 
@@ -256,6 +349,49 @@ TEST_CASE("Can serialise using RapidXML")
         }
     }
 
+    SECTION("Names are copied once per document")
+    {
+        Complex c;
+        for (int i = 0; i < 3; ++i)
+            c.m_v.emplace_back(i, "item", 99.25f, true);
+
+        auto print = [](const rapidxml::xml_document<>& doc) {
+            std::ostringstream ostrm;
+            ostrm << doc;
+            return ostrm.str();
+        };
+
+        std::string copied;
+        {
+            rapidxml::xml_document<> doc;
+            auto rootNode = doc.allocate_node(rapidxml::node_element, "complex");
+            doc.append_node(rootNode);
+            ponder::archive::RapidXmlArchive<> archive;
+            ponder::archive::ArchiveWriter(archive).write(rootNode, ponder::UserObject::makeRef(c));
+            copied = print(doc);
+        }
+        CHECK(copied.find("<float>99.25</float>") != std::string::npos);
+
+        rapidxml::xml_document<> doc;
+        ponder::archive::RapidXmlArchive<> archive(doc);
+        ponder::archive::ArchiveWriter writer(archive);
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            // The document is cleared and written again, which needs the names copied again
+            doc.clear();
+            archive.reset();
+            auto rootNode = doc.allocate_node(rapidxml::node_element, "complex");
+            doc.append_node(rootNode);
+            writer.write(rootNode, ponder::UserObject::makeRef(c));
+            CHECK(print(doc) == copied);
+
+            std::set<const char*> names;
+            for (auto item = rootNode->first_node("vect")->first_node(); item; item = item->next_sibling())
+                names.insert(item->first_node("int")->name());
+            CHECK(names.size() == 1);
+        }
+    }
+
     // Simple nested object
     SECTION("Nested object")
     {
@@ -402,6 +538,52 @@ TEST_CASE("Can serialise using RapidXML")
         }
     }
 
+    SECTION("Map values")
+    {
+        std::string storage;
+
+        {
+            Catalogue c;
+            c.m_counts = {{"apples", 3}, {"pears", 7}};
+            c.m_items.emplace(12, Simple(78, std::string("yadda"), 99.25f, true));
+            c.m_items.emplace(34, Simple(11, std::string("wooby"), 66.75f, false));
+
+            rapidxml::xml_document<> doc;
+            auto rootNode = doc.allocate_node(rapidxml::node_element, "catalogue");
+            REQUIRE(rootNode != nullptr);
+            doc.append_node(rootNode);
+
+            ponder::archive::RapidXmlArchive<> archive;
+            ponder::archive::ArchiveWriter writer(archive);
+            writer.write(rootNode, ponder::UserObject::makeRef(c));
+
+            std::cout << doc;
+
+            std::ostringstream ostrm;
+            ostrm << doc;
+            storage = ostrm.str();
+            doc.clear();
+        }
+
+        {
+            Catalogue c2;
+
+            rapidxml::xml_document<> doc;
+            doc.parse<rapidxml::parse_non_destructive>(storage.data());
+            auto rootNode = doc.first_node();
+            REQUIRE(rootNode != nullptr);
+
+            ponder::archive::RapidXmlArchive<> archive;
+            ponder::archive::ArchiveReader reader(archive);
+            reader.read(rootNode, ponder::UserObject::makeRef(c2));
+
+            CHECK(c2.m_counts == std::map<std::string, int>({{"apples", 3}, {"pears", 7}}));
+            REQUIRE(c2.m_items.size() == 2);
+            CHECK(c2.m_items[12].m_s == std::string("yadda"));
+            CHECK(c2.m_items[34].m_i == 11);
+        }
+    }
+
     SECTION("TestA")
     {
         std::string storage;
@@ -830,6 +1012,55 @@ TEST_CASE("Can serialise using RapidJSON")
         }
     }
 
+    SECTION("Map values")
+    {
+        std::string storage;
+
+        {
+            Catalogue c;
+            c.m_counts = {{"apples", 3}, {"pears", 7}};
+            c.m_items.emplace(12, Simple(78, std::string("yadda"), 99.25f, true));
+            c.m_items.emplace(34, Simple(11, std::string("wooby"), 66.75f, false));
+
+            rapidjson::StringBuffer sb;
+            rapidjson::Writer jwriter(sb);
+            jwriter.StartObject();
+
+            using Archive = ponder::archive::RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>;
+            Archive archive(jwriter);
+            Archive::Node rootNode{};
+            ponder::archive::ArchiveWriter writer(archive);
+            writer.write(rootNode, ponder::UserObject::makeRef(c));
+
+            jwriter.EndObject();
+
+            std::cout << sb.GetString() << std::endl;
+
+            storage = sb.GetString();
+        }
+
+        {
+            Catalogue c2;
+
+            rapidjson::Document jdoc;
+            REQUIRE(!jdoc.Parse(storage.data()).HasParseError());
+            REQUIRE(jdoc.IsObject());
+
+            using Archive = ponder::archive::RapidJsonArchiveReader;
+            Archive archive(jdoc);
+            Archive::Node rootNode{ jdoc };
+            REQUIRE(archive.isValid(rootNode));
+
+            ponder::archive::ArchiveReader reader(archive);
+            reader.read(rootNode, ponder::UserObject::makeRef(c2));
+
+            CHECK(c2.m_counts == std::map<std::string, int>({{"apples", 3}, {"pears", 7}}));
+            REQUIRE(c2.m_items.size() == 2);
+            CHECK(c2.m_items[12].m_s == std::string("yadda"));
+            CHECK(c2.m_items[34].m_i == 11);
+        }
+    }
+
     SECTION("TestA")
     {
         std::string storage;
@@ -886,3 +1117,1124 @@ TEST_CASE("Can serialise using RapidJSON")
         }
     }
 }
+
+TEST_CASE("Can stream JSON into objects")
+{
+    // Write with ArchiveWriter
+    auto toJson = [](const ponder::UserObject& object) {
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer jwriter(sb);
+        jwriter.StartObject();
+        using Archive = ponder::archive::RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>;
+        Archive archive(jwriter);
+        ponder::archive::ArchiveWriter writer(archive);
+        writer.write(nullptr, object);
+        jwriter.EndObject();
+        return std::string(sb.GetString());
+    };
+
+    SECTION("Nested arrays and variants")
+    {
+        TestA testA{ "testA" };
+        testA.params.emplace_back(Params{ParamType::d, {0}, {2.3}, {}, {}});
+        testA.params.emplace_back(Params{ParamType::a, {0}, {0}, {1,2,3}, {}});
+        testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, 3.3f});
+        testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, Param_i{42}});
+        const std::string storage = toJson(ponder::UserObject::makeRef(testA));
+
+        TestA testA2;
+        rapidjson::StringStream stream(storage.c_str());
+        ponder::archive::RapidJsonStreamReader reader;
+        REQUIRE(reader.read(stream, ponder::UserObject::makeRef(testA2)));
+
+        CHECK(testA2.name == "testA");
+        REQUIRE(testA2.params.size() == 4);
+        CHECK(testA2.params[0].type == ParamType::d);
+        CHECK(testA2.params[0].value_d.value == 2.3);
+        CHECK(testA2.params[1].type == ParamType::a);
+        CHECK(testA2.params[1].value_a == std::vector<int>({1,2,3}));
+        CHECK(testA2.params[2].value_v.index() == 1);
+        CHECK(std::get<1>(testA2.params[2].value_v) == Approx(3.3));
+        CHECK(testA2.params[3].value_v.index() == 2);
+        CHECK(std::get<2>(testA2.params[3].value_v).value == 42);
+    }
+
+    SECTION("Map values")
+    {
+        Catalogue c;
+        c.m_counts = {{"apples", 3}, {"pears", 7}};
+        c.m_items.emplace(12, Simple(78, std::string("yadda"), 99.25f, true));
+        c.m_items.emplace(34, Simple(11, std::string("wooby"), 66.75f, false));
+        const std::string storage = toJson(ponder::UserObject::makeRef(c));
+
+        Catalogue c2;
+        rapidjson::StringStream stream(storage.c_str());
+        ponder::archive::RapidJsonStreamReader reader;
+        REQUIRE(reader.read(stream, ponder::UserObject::makeRef(c2)));
+
+        CHECK(c2.m_counts == c.m_counts);
+        REQUIRE(c2.m_items.size() == 2);
+        CHECK(c2.m_items[12].m_s == std::string("yadda"));
+        CHECK(c2.m_items[12].m_v.empty());
+        CHECK(c2.m_items[34].m_i == 11);
+        CHECK(c2.m_items[34].getF() == 66.75f);
+    }
+
+    SECTION("Unknown members are skipped")
+    {
+        const std::string storage = R"({"unknown":{"deep":[1,{"int":2}]},"int":-12,"vector":[4,[9],5],)"
+            R"("extra":[{"string":"no"}],"string":"yadda","bool":false,"float":0.5})";
+
+        Simple s;
+        rapidjson::StringStream stream(storage.c_str());
+        ponder::archive::RapidJsonStreamReader reader;
+        REQUIRE(reader.read(stream, ponder::UserObject::makeRef(s)));
+
+        CHECK(s.m_i == -12);
+        CHECK(s.getF() == 0.5f);
+        CHECK(s.m_s == std::string("yadda"));
+        CHECK(s.m_v == std::vector<int>({4,0,5}));
+        CHECK(s.m_b == false);
+    }
+
+    SECTION("Null items keep their place in arrays")
+    {
+        Simple s;
+        rapidjson::StringStream stream(R"({"int":null,"vector":[1,null,3,null]})");
+        ponder::archive::RapidJsonStreamReader reader;
+        REQUIRE(reader.read(stream, ponder::UserObject::makeRef(s)));
+        CHECK(s.m_i == 0);
+        CHECK(s.m_v == std::vector<int>({1,0,3,0}));
+
+        Complex c;
+        rapidjson::StringStream objects(R"({"vect":[null,{"int":5},null,{"int":7}]})");
+        REQUIRE(reader.read(objects, ponder::UserObject::makeRef(c)));
+        REQUIRE(c.m_v.size() == 4);
+        CHECK(c.m_v[0].m_i == 0);
+        CHECK(c.m_v[1].m_i == 5);
+        CHECK(c.m_v[2].m_i == 0);
+        CHECK(c.m_v[3].m_i == 7);
+    }
+
+    SECTION("Parse errors are reported")
+    {
+        Simple s;
+        rapidjson::StringStream stream(R"({"int":3,"string":)");
+        ponder::archive::RapidJsonStreamReader reader;
+        const rapidjson::ParseResult result = reader.read(stream, ponder::UserObject::makeRef(s));
+        CHECK(result.IsError());
+        CHECK(s.m_i == 3);
+    }
+}
+
+TEST_CASE("Can stream objects to JSON")
+{
+    auto readFile = [](FILE* file) {
+        std::string contents;
+        std::rewind(file);
+        char buffer[256];
+        for (size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) > 0;)
+            contents.append(buffer, n);
+        return contents;
+    };
+
+    auto toJson = [](const ponder::UserObject& object) {
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer jwriter(sb);
+        jwriter.StartObject();
+        using Archive = ponder::archive::RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>;
+        Archive archive(jwriter);
+        ponder::archive::ArchiveWriter writer(archive);
+        writer.write(nullptr, object);
+        jwriter.EndObject();
+        return std::string(sb.GetString());
+    };
+
+    SECTION("Same output as the RapidJSON writer")
+    {
+        TestA testA{ "test\"A\"\n" };
+        testA.params.emplace_back(Params{ParamType::d, {-7}, {2.3}, {}, {}});
+        testA.params.emplace_back(Params{ParamType::a, {0}, {1e300}, {1,2,3}, {}});
+        testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, 3.3f});
+        testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, Param_i{42}});
+
+        Catalogue c;
+        c.m_counts = {{"apples", 3}, {"pears", 7}};
+        c.m_items.emplace(12, Simple(78, std::string("yadda"), 99.25f, true));
+
+        for (auto&& object : {ponder::UserObject::makeRef(testA), ponder::UserObject::makeRef(c)})
+        {
+            FILE* file = std::tmpfile();
+            REQUIRE(file != nullptr);
+            {
+                ponder::archive::RapidJsonStreamWriter archive(file);
+                ponder::archive::ArchiveWriter writer(archive);
+                writer.write(archive.root(), object);
+                CHECK(archive.finish());
+            }
+            CHECK(readFile(file) == toJson(object));
+            std::fclose(file);
+        }
+    }
+
+    SECTION("Output larger than the buffer")
+    {
+        Complex c;
+        for (int i = 0; i < 2000; ++i)
+            c.m_v.emplace_back(i, std::string(50, 'x'), 0.5f, true);
+
+        FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        {
+            ponder::archive::RapidJsonStreamWriter archive(file);
+            ponder::archive::ArchiveWriter writer(archive);
+            writer.write(archive.root(), ponder::UserObject::makeRef(c));
+            CHECK(archive.finish());
+        }
+        const std::string storage = readFile(file);
+        std::fclose(file);
+        CHECK(storage.size() > 64 * 1024);
+        CHECK(storage == toJson(ponder::UserObject::makeRef(c)));
+    }
+
+    SECTION("Through an asynchronous sink")
+    {
+        Complex c;
+        for (int i = 0; i < 2000; ++i)
+            c.m_v.emplace_back(i, std::string(50, 'x'), 0.5f, true);
+
+        FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        ponder::archive::AsyncSink::Stats stats;
+        {
+            ponder::archive::AsyncSink sink(file, 10000);
+            for (int snapshot = 0; snapshot < 2; ++snapshot)
+            {
+                ponder::archive::RapidJsonStreamWriter archive(sink);
+                ponder::archive::ArchiveWriter writer(archive);
+                writer.write(archive.root(), ponder::UserObject::makeRef(c));
+                CHECK(archive.finish());
+            }
+            CHECK(sink.sync());
+            CHECK_FALSE(sink.backpressured());
+            stats = sink.stats();
+        }
+        const std::string storage = readFile(file);
+        std::fclose(file);
+        const std::string json = toJson(ponder::UserObject::makeRef(c));
+        CHECK(storage == json + json);
+        CHECK(stats.bytes == storage.size());
+        CHECK(stats.buffers >= storage.size() / 10000);
+    }
+}
+
+TEST_CASE("Can write archives through an asynchronous sink")
+{
+    SECTION("Binary archive")
+    {
+        Catalogue c;
+        c.m_counts = {{"apples", 3}, {"pears", 7}};
+        c.m_items.emplace(12, Simple(78, std::string("yadda"), 99.25f, true));
+
+        std::string storage;
+        ponder::archive::BinaryArchiveWriter archive(storage);
+        ponder::archive::ArchiveWriter(archive).write(archive.root(), ponder::UserObject::makeRef(c));
+        archive.finish();
+
+        FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        {
+            ponder::archive::AsyncSink sink(file, 16);
+            CHECK(sink.write(storage));
+        }
+        std::string contents(storage.size() + 1, ' ');
+        std::rewind(file);
+        contents.resize(std::fread(contents.data(), 1, contents.size(), file));
+        std::fclose(file);
+        CHECK(contents == storage);
+    }
+
+#ifndef _WIN32
+    SECTION("Backpressure is reported")
+    {
+        int fds[2];
+        REQUIRE(::pipe(fds) == 0);
+
+        // Fill the pipe, so that the sink can't write until it is read
+        const int flags = ::fcntl(fds[1], F_GETFL);
+        ::fcntl(fds[1], F_SETFL, flags | O_NONBLOCK);
+        size_t filled = 0;
+        for (char block[4096] = {}; ::write(fds[1], block, sizeof(block)) > 0;)
+            filled += sizeof(block);
+        ::fcntl(fds[1], F_SETFL, flags);
+
+        const std::string data(3000, 'p');
+        {
+            ponder::archive::AsyncSink sink(fds[1], 1000);
+            CHECK_FALSE(sink.backpressured());
+            CHECK(sink.write(data.data(), 1000)); // one buffer handed over, blocked in the pipe
+            CHECK(sink.backpressured());
+
+            std::thread reader([&] {
+                char block[4096];
+                for (size_t total = 0; total < filled + data.size();)
+                    total += static_cast<size_t>(::read(fds[0], block, sizeof(block)));
+            });
+            CHECK(sink.write(data.data() + 1000, 2000));
+            CHECK(sink.sync());
+            CHECK_FALSE(sink.backpressured());
+            CHECK(sink.stats().bytes == data.size());
+            reader.join();
+        }
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+#endif
+}
+
+TEST_CASE("Can serialise using the binary archive")
+{
+    SECTION("Member values")
+    {
+        std::string storage;
+
+        {
+            Simple s(-78, std::string("yadda"), 99.25f, true);
+            s.m_v = {3,6,9};
+            s.m_ll = -99999999999LL;
+
+            ponder::archive::BinaryArchiveWriter archive(storage);
+            ponder::archive::ArchiveWriter writer(archive);
+            writer.write(archive.root(), ponder::UserObject::makeRef(s));
+            archive.finish();
+        }
+
+        {
+            Simple s2(0, "", 0.f, false);
+
+            ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+            REQUIRE(archive.isValid(archive.root()));
+
+            ponder::archive::ArchiveReader reader(archive);
+            reader.read(archive.root(), ponder::UserObject::makeRef(s2));
+
+            CHECK(s2.m_i == -78);
+            CHECK(s2.getF() == 99.25f);
+            CHECK(s2.m_s == std::string("yadda"));
+            CHECK(s2.m_v == std::vector<int>({3,6,9}));
+            CHECK(s2.m_b == true);
+            CHECK(s2.m_ll == -99999999999LL);
+        }
+    }
+
+    SECTION("Names are written once")
+    {
+        Complex c;
+        for (int i = 0; i < 10; ++i)
+            c.m_v.emplace_back(i, std::string("yadda"), 0.5f, true);
+
+        std::string storage;
+        ponder::archive::BinaryArchiveWriter archive(storage);
+        ponder::archive::ArchiveWriter writer(archive);
+        writer.write(archive.root(), ponder::UserObject::makeRef(c));
+        archive.finish();
+
+        size_t count = 0;
+        for (size_t pos = storage.find("longlong"); pos != std::string::npos;
+             pos = storage.find("longlong", pos + 1))
+            ++count;
+        CHECK(count == 1);
+
+        Complex c2;
+        ponder::archive::BinaryArchiveReader reader(storage.data(), storage.size());
+        ponder::archive::ArchiveReader(reader).read(reader.root(), ponder::UserObject::makeRef(c2));
+        REQUIRE(c2.m_v.size() == 10);
+        CHECK(c2.m_v[9].m_i == 9);
+    }
+
+    SECTION("Map values")
+    {
+        std::string storage;
+
+        {
+            Catalogue c;
+            c.m_counts = {{"apples", 3}, {"pears", 7}};
+            c.m_items.emplace(12, Simple(78, std::string("yadda"), 99.25f, true));
+            c.m_items.emplace(34, Simple(11, std::string("wooby"), 66.75f, false));
+
+            ponder::archive::BinaryArchiveWriter archive(storage);
+            ponder::archive::ArchiveWriter writer(archive);
+            writer.write(archive.root(), ponder::UserObject::makeRef(c));
+            archive.finish();
+        }
+
+        {
+            Catalogue c2;
+
+            ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+            ponder::archive::ArchiveReader reader(archive);
+            reader.read(archive.root(), ponder::UserObject::makeRef(c2));
+
+            CHECK(c2.m_counts == std::map<std::string, int>({{"apples", 3}, {"pears", 7}}));
+            REQUIRE(c2.m_items.size() == 2);
+            CHECK(c2.m_items[12].m_s == std::string("yadda"));
+            CHECK(c2.m_items[34].m_i == 11);
+        }
+    }
+
+    SECTION("TestA")
+    {
+        std::string storage;
+
+        {
+            TestA testA{ "testA" };
+            testA.params.emplace_back(Params{ParamType::d, {0}, {2.3}, {}, {}});
+            testA.params.emplace_back(Params{ParamType::i, {10}, {0}, {}, {}});
+            testA.params.emplace_back(Params{ParamType::a, {0}, {0}, {1,2,3}, {}});
+            testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, (short)3});
+            testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, 3.3f});
+            testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, Param_i{42}});
+
+            ponder::archive::BinaryArchiveWriter archive(storage);
+            ponder::archive::ArchiveWriter writer(archive);
+            writer.write(archive.root(), ponder::UserObject::makeRef(testA));
+            archive.finish();
+        }
+
+        {
+            TestA testA;
+
+            ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+            ponder::archive::ArchiveReader reader(archive);
+            reader.read(archive.root(), ponder::UserObject::makeRef(testA));
+
+            CHECK(testA.name == "testA");
+            CHECK(testA.params.size() == 6);
+            CHECK(testA.params[0].type == ParamType::d);
+            CHECK(testA.params[0].value_d.value == 2.3);
+            CHECK(testA.params[1].value_i.value == 10);
+            CHECK(testA.params[2].value_a == std::vector<int>({1,2,3}));
+            CHECK(testA.params[3].value_v.index() == 0);
+            CHECK(std::get<0>(testA.params[3].value_v) == 3);
+            CHECK(testA.params[4].value_v.index() == 1);
+            CHECK(std::get<1>(testA.params[4].value_v) == Approx(3.3));
+            CHECK(testA.params[5].value_v.index() == 2);
+        }
+    }
+
+    SECTION("Truncated archives are invalid")
+    {
+        std::string storage;
+        Simple s(1, "x", 0.f, true);
+        ponder::archive::BinaryArchiveWriter archive(storage);
+        ponder::archive::ArchiveWriter writer(archive);
+        writer.write(archive.root(), ponder::UserObject::makeRef(s));
+        archive.finish();
+
+        ponder::archive::BinaryArchiveReader truncated(storage.data(), storage.size() - 3);
+        CHECK(!truncated.isValid(truncated.root()));
+        ponder::archive::BinaryArchiveReader garbage("nonsense", 8);
+        CHECK(!garbage.isValid(garbage.root()));
+    }
+
+    SECTION("Arrays with a corrupt count are bounded by the archive")
+    {
+        // Header, root array and empty name table
+        auto makeArchive = [](const std::string& root) {
+            const auto namesOffset = static_cast<char>(ponder::archive::binary::c_headerSize + root.size());
+            return std::string(ponder::archive::binary::c_magic, 4)
+                + static_cast<char>(ponder::archive::binary::c_version)
+                + namesOffset + std::string(3, '\0') + root + std::string(1, '\0');
+        };
+        const char arrayTag = static_cast<char>(ponder::archive::binary::Tag::Array);
+
+        // The count says 4 billion items, for one byte of items
+        const std::string tooMany = makeArchive(std::string(1, arrayTag) + std::string("\5\0\0\0", 4)
+                                                + std::string(4, '\xff') + std::string(1, '\0'));
+        ponder::archive::BinaryArchiveReader manyReader(tooMany.data(), tooMany.size());
+        const auto manyItems = manyReader.createArrayIterator(manyReader.root(), "item");
+        CHECK(manyItems.size() == 1);
+
+        // The array is too short to hold its count
+        const std::string noCount = makeArchive(std::string(1, arrayTag) + std::string(4, '\0'));
+        ponder::archive::BinaryArchiveReader shortReader(noCount.data(), noCount.size());
+        const auto noItems = shortReader.createArrayIterator(shortReader.root(), "item");
+        CHECK(noItems.isEnd());
+        CHECK(noItems.size() == 0);
+    }
+}
+
+TEST_CASE("Can read archives in a single pass")
+{
+    SECTION("RapidJSON with unknown members")
+    {
+        const std::string storage = R"({"unknown":{"deep":[1,{"x":2}]},"int":-12,)"
+            R"("vector":[4,5],"extra":"skip me","string":"yadda","bool":false,"float":0.5})";
+
+        rapidjson::Document jdoc;
+        REQUIRE(!jdoc.Parse(storage.data()).HasParseError());
+
+        ponder::archive::RapidJsonArchiveReader archive(jdoc);
+        ponder::archive::ArchiveReader reader(archive, ponder::archive::ReadMode::SinglePass);
+
+        Simple s;
+        reader.read(jdoc, ponder::UserObject::makeRef(s));
+
+        CHECK(s.m_i == -12);
+        CHECK(s.getF() == 0.5f);
+        CHECK(s.m_s == std::string("yadda"));
+        CHECK(s.m_v == std::vector<int>({4,5}));
+        CHECK(s.m_b == false);
+        CHECK(s.m_ll == 9999999999LL); // missing members are left untouched
+    }
+
+    SECTION("RapidXML nested objects")
+    {
+        std::string storage = "<complex><ignored>1</ignored><vect>"
+            "<item><int>1</int><string>a</string></item>"
+            "<item><bool>0</bool><int>2</int><unknown><int>9</int></unknown></item>"
+            "</vect></complex>";
+
+        rapidxml::xml_document<> doc;
+        doc.parse<rapidxml::parse_non_destructive>(storage.data());
+
+        ponder::archive::RapidXmlArchive<> archive;
+        ponder::archive::ArchiveReader reader(archive, ponder::archive::ReadMode::SinglePass);
+
+        Complex c;
+        reader.read(doc.first_node(), ponder::UserObject::makeRef(c));
+
+        REQUIRE(c.m_v.size() == 2);
+        CHECK(c.m_v[0].m_i == 1);
+        CHECK(c.m_v[0].m_s == std::string("a"));
+        CHECK(c.m_v[1].m_i == 2);
+        CHECK(c.m_v[1].m_b == false);
+    }
+
+    SECTION("Binary archive")
+    {
+        std::string storage;
+
+        {
+            TestA testA{ "testA" };
+            testA.params.emplace_back(Params{ParamType::d, {0}, {2.3}, {}, {}});
+            testA.params.emplace_back(Params{ParamType::a, {0}, {0}, {1,2,3}, {}});
+            testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, Param_i{42}});
+
+            ponder::archive::BinaryArchiveWriter archive(storage);
+            ponder::archive::ArchiveWriter writer(archive);
+            writer.write(archive.root(), ponder::UserObject::makeRef(testA));
+            archive.finish();
+        }
+
+        {
+            TestA testA;
+
+            ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+            ponder::archive::ArchiveReader reader(archive, ponder::archive::ReadMode::SinglePass);
+            reader.read(archive.root(), ponder::UserObject::makeRef(testA));
+
+            CHECK(testA.name == "testA");
+            REQUIRE(testA.params.size() == 3);
+            CHECK(testA.params[0].type == ParamType::d);
+            CHECK(testA.params[0].value_d.value == 2.3);
+            CHECK(testA.params[1].value_a == std::vector<int>({1,2,3}));
+            CHECK(testA.params[2].value_v.index() == 2);
+            CHECK(std::get<2>(testA.params[2].value_v).value == 42);
+        }
+    }
+}
+
+TEST_CASE("Can serialise arrays of numbers in one block")
+{
+    Samples samples;
+    samples.m_floats = {0.5f, -1.25f, 3e10f};
+    samples.m_counts = {7, -8, 9};
+    samples.m_bytes = {1, 2, 254, 255};
+
+    auto checkSamples = [&](const Samples& copy) {
+        CHECK(copy.m_floats == samples.m_floats);
+        CHECK(copy.m_counts == samples.m_counts);
+        CHECK(copy.m_bytes == samples.m_bytes);
+    };
+
+    SECTION("Binary archive")
+    {
+        std::string storage;
+        ponder::archive::BinaryArchiveWriter writerArchive(storage);
+        ponder::archive::ArchiveWriter(writerArchive).write(writerArchive.root(),
+                                                            ponder::UserObject::makeRef(samples));
+        writerArchive.finish();
+
+        // The floats are stored as they are
+        CHECK(storage.find(std::string(reinterpret_cast<const char*>(samples.m_floats.data()),
+                                       3 * sizeof(float))) != std::string::npos);
+
+        Samples copy;
+        ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+        ponder::archive::ArchiveReader(archive).read(archive.root(), ponder::UserObject::makeRef(copy));
+        checkSamples(copy);
+    }
+
+    SECTION("RapidJSON")
+    {
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer jwriter(sb);
+        jwriter.StartObject();
+        ponder::archive::RapidJsonArchiveWriter writerArchive(jwriter);
+        ponder::archive::ArchiveWriter(writerArchive).write(nullptr, ponder::UserObject::makeRef(samples));
+        jwriter.EndObject();
+        CHECK(std::string(sb.GetString())
+              == R"({"bytes":[1,2,254,255],"counts":[7,-8,9],"floats":[0.5,-1.25,30000001024.0]})");
+
+        FILE* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        {
+            ponder::archive::RapidJsonStreamWriter archive(file);
+            ponder::archive::ArchiveWriter writer(archive);
+            writer.write(archive.root(), ponder::UserObject::makeRef(samples));
+            CHECK(archive.finish());
+        }
+        std::string streamed(static_cast<size_t>(std::ftell(file)), ' ');
+        std::rewind(file);
+        CHECK(std::fread(streamed.data(), 1, streamed.size(), file) == streamed.size());
+        std::fclose(file);
+        CHECK(streamed == sb.GetString());
+
+        rapidjson::Document jdoc;
+        REQUIRE(!jdoc.Parse(sb.GetString()).HasParseError());
+
+        Samples copy;
+        ponder::archive::RapidJsonArchiveReader archive(jdoc);
+        ponder::archive::ArchiveReader(archive).read(jdoc, ponder::UserObject::makeRef(copy));
+        checkSamples(copy);
+    }
+
+    SECTION("RapidXML")
+    {
+        rapidxml::xml_document<> doc;
+        auto rootNode = doc.allocate_node(rapidxml::node_element, "samples");
+        doc.append_node(rootNode);
+
+        ponder::archive::RapidXmlArchive<> archive;
+        ponder::archive::ArchiveWriter(archive).write(rootNode, ponder::UserObject::makeRef(samples));
+
+        std::ostringstream ostore;
+        ostore << doc;
+        std::string storage = ostore.str();
+        CHECK(storage.find("<floats>0.5 -1.25 3e+10</floats>") != std::string::npos);
+        CHECK(storage.find("<bytes>1 2 254 255</bytes>") != std::string::npos);
+
+        rapidxml::xml_document<> readDoc;
+        readDoc.parse<0>(storage.data());
+
+        Samples copy;
+        ponder::archive::ArchiveReader(archive).read(readDoc.first_node(), ponder::UserObject::makeRef(copy));
+        checkSamples(copy);
+    }
+
+    SECTION("Arrays written item by item can still be read")
+    {
+        std::string storage = "<samples><floats><item>0.5</item><item>-1.25</item>"
+            "<item>3e10</item></floats><counts><item>7</item><item>-8</item><item>9</item>"
+            "</counts><bytes>1 2 254 255</bytes></samples>";
+
+        rapidxml::xml_document<> doc;
+        doc.parse<0>(storage.data());
+
+        Samples copy;
+        ponder::archive::RapidXmlArchive<> archive;
+        ponder::archive::ArchiveReader(archive).read(doc.first_node(), ponder::UserObject::makeRef(copy));
+        checkSamples(copy);
+    }
+}
+
+TEST_CASE("Can serialise arrays on several threads")
+{
+    Complex c;
+    for (int i = 0; i < 1000; ++i)
+        c.m_v.emplace_back(i, std::to_string(i), i * 0.5f, i % 3 == 0);
+
+    const ponder::archive::Parallelism parallelism{4, 16};
+
+    auto checkItems = [&](const Complex& copy) {
+        REQUIRE(copy.m_v.size() == c.m_v.size());
+        for (size_t i = 0; i < c.m_v.size(); ++i)
+        {
+            CHECK(copy.m_v[i].m_i == c.m_v[i].m_i);
+            CHECK(copy.m_v[i].m_s == c.m_v[i].m_s);
+            CHECK(copy.m_v[i].getF() == c.m_v[i].getF());
+            CHECK(copy.m_v[i].m_b == c.m_v[i].m_b);
+        }
+    };
+
+    SECTION("Binary archive")
+    {
+        auto toBinary = [&](const ponder::archive::Parallelism& options) {
+            std::string storage;
+            ponder::archive::BinaryArchiveWriter archive(storage);
+            ponder::archive::ArchiveWriter writer(archive, options);
+            writer.write(archive.root(), ponder::UserObject::makeRef(c));
+            archive.finish();
+            return storage;
+        };
+
+        const std::string storage = toBinary(parallelism);
+        CHECK(storage == toBinary({}));
+
+        Complex copy;
+        ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+        ponder::archive::ArchiveReader reader(archive, ponder::archive::ReadMode::SinglePass,
+                                              parallelism);
+        reader.read(archive.root(), ponder::UserObject::makeRef(copy));
+        checkItems(copy);
+
+        // The changes of tracked objects are recorded as when reading on one thread
+        Complex tracked;
+        const ponder::UserObject trackedObject = ponder::UserObject::makeRef(tracked);
+        trackedObject.trackChanges();
+        reader.read(archive.root(), trackedObject);
+        CHECK(trackedObject.isDirty("vect"));
+        trackedObject.trackChanges(false);
+        checkItems(tracked);
+    }
+
+    SECTION("RapidJSON")
+    {
+        auto toJson = [&](const ponder::archive::Parallelism& options) {
+            rapidjson::StringBuffer sb;
+            rapidjson::Writer jwriter(sb);
+            jwriter.StartObject();
+            using Archive = ponder::archive::RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>;
+            Archive archive(jwriter);
+            ponder::archive::ArchiveWriter writer(archive, options);
+            writer.write(nullptr, ponder::UserObject::makeRef(c));
+            jwriter.EndObject();
+            return std::string(sb.GetString());
+        };
+
+        const std::string storage = toJson(parallelism);
+        CHECK(storage == toJson({}));
+
+        rapidjson::Document jdoc;
+        REQUIRE(!jdoc.Parse(storage.data()).HasParseError());
+
+        Complex copy;
+        ponder::archive::RapidJsonArchiveReader archive(jdoc);
+        ponder::archive::ArchiveReader reader(archive, ponder::archive::ReadMode::FindProperty,
+                                              parallelism);
+        reader.read(jdoc, ponder::UserObject::makeRef(copy));
+        checkItems(copy);
+    }
+}
+
+TEST_CASE("Arrays read on several threads are set by the calling thread")
+{
+    // The first box has no labels, so Label is only reached by the other threads' items
+    Shelf shelf;
+    for (int i = 0; i < 200; ++i)
+    {
+        Box box;
+        box.id = i;
+        for (int j = 0; j < i % 3; ++j)
+            box.labels.push_back(Label{std::to_string(i * 10 + j)});
+        shelf.boxes.push_back(std::move(box));
+    }
+
+    std::string storage;
+    {
+        ponder::archive::BinaryArchiveWriter archive(storage);
+        ponder::archive::ArchiveWriter writer(archive, {4, 16});
+        writer.write(archive.root(), ponder::UserObject::makeRef(shelf));
+        archive.finish();
+    }
+
+    struct ThreadLog : ponder::PropertyObserver
+    {
+        std::set<std::thread::id> threads;
+        int count = 0;
+
+        void propertyChanged(const ponder::UserObject&, const ponder::Property&) override
+        {
+            threads.insert(std::this_thread::get_id());
+            ++count;
+        }
+    };
+
+    const ponder::Property& boxes = ponder::classByType<Shelf>().property("boxes");
+    ThreadLog log;
+    ponder::addPropertyObserver(boxes, &log);
+
+    Shelf copy;
+    ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+    ponder::archive::ArchiveReader reader(archive, ponder::archive::ReadMode::SinglePass, {4, 16});
+    reader.read(archive.root(), ponder::UserObject::makeRef(copy));
+
+    ponder::removePropertyObserver(boxes, &log);
+
+    REQUIRE(copy.boxes.size() == shelf.boxes.size());
+    for (size_t i = 0; i < shelf.boxes.size(); ++i)
+    {
+        CHECK(copy.boxes[i].id == shelf.boxes[i].id);
+        REQUIRE(copy.boxes[i].labels.size() == shelf.boxes[i].labels.size());
+        for (size_t j = 0; j < shelf.boxes[i].labels.size(); ++j)
+            CHECK(copy.boxes[i].labels[j].text == shelf.boxes[i].labels[j].text);
+    }
+    CHECK(log.count > 0);
+    CHECK(log.threads == std::set<std::thread::id>{std::this_thread::get_id()});
+}
+
+TEST_CASE("Can serialise enums as values or ids")
+{
+    Readings readings;
+    readings.m_type = ParamType::a;
+    readings.m_history = {ParamType::d, ParamType::a, ParamType::d};
+    readings.m_byName = {{"first", ParamType::i}, {"last", ParamType::a}};
+
+    auto checkReadings = [&](const Readings& copy) {
+        CHECK(copy.m_type == readings.m_type);
+        CHECK(copy.m_history == readings.m_history);
+        CHECK(copy.m_byName == readings.m_byName);
+    };
+
+    auto writeJson = [&](ponder::archive::EnumFormat format) {
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer jwriter(sb);
+        jwriter.StartObject();
+        ponder::archive::RapidJsonArchiveWriter archive(jwriter);
+        ponder::archive::ArchiveWriter writer(archive);
+        writer.setEnumFormat(format);
+        auto dataNode = archive.beginChild(nullptr, "data");
+        writer.write(dataNode, ponder::UserObject::makeRef(readings));
+        archive.endChild(nullptr, dataNode);
+        writer.writeEnumNames(nullptr);
+        jwriter.EndObject();
+        return std::string(sb.GetString());
+    };
+
+    auto readJson = [&](const std::string& storage, Readings& copy) {
+        rapidjson::Document jdoc;
+        REQUIRE(!jdoc.Parse(storage.c_str()).HasParseError());
+        ponder::archive::RapidJsonArchiveReader archive(jdoc);
+        ponder::archive::ArchiveReader reader(archive);
+        const bool hasNames = reader.readEnumNames(jdoc);
+        reader.read(jdoc["data"], ponder::UserObject::makeRef(copy));
+        return hasNames;
+    };
+
+    SECTION("RapidJSON values")
+    {
+        const std::string storage = writeJson(ponder::archive::EnumFormat::Value);
+        CHECK(storage.find(R"("history":[1,2,1])") != std::string::npos);
+        CHECK(storage.find(R"("type":2)") != std::string::npos);
+        CHECK(storage.find(R"("enums":[])") != std::string::npos);
+
+        Readings copy;
+        CHECK(readJson(storage, copy));
+        checkReadings(copy);
+    }
+
+    SECTION("RapidJSON ids")
+    {
+        const std::string storage = writeJson(ponder::archive::EnumFormat::NameId);
+        CHECK(storage.find(R"("history":[2,1,2])") != std::string::npos);
+        CHECK(storage.find(R"("type":1)") != std::string::npos);
+        CHECK(storage.find(R"("enums":[{"enum":"SerialiseTest::ParamType","name":"i"},)"
+                           R"({"enum":"SerialiseTest::ParamType","name":"a"},)"
+                           R"({"enum":"SerialiseTest::ParamType","name":"d"}])") != std::string::npos);
+
+        Readings copy;
+        CHECK(readJson(storage, copy));
+        checkReadings(copy);
+    }
+
+    SECTION("Names and values are read without a table")
+    {
+        Readings copy;
+        CHECK_FALSE(readJson(R"({"data":{"type":"a","history":[1,"a",1],)"
+                             R"("byName":[{"key":"first","value":0},{"key":"last","value":"a"}]}})", copy));
+        checkReadings(copy);
+    }
+
+    SECTION("RapidXML ids")
+    {
+        rapidxml::xml_document<> doc;
+        auto rootNode = doc.allocate_node(rapidxml::node_element, "readings");
+        doc.append_node(rootNode);
+
+        ponder::archive::RapidXmlArchive<> archive;
+        ponder::archive::ArchiveWriter writer(archive);
+        writer.setEnumFormat(ponder::archive::EnumFormat::NameId);
+        writer.write(rootNode, ponder::UserObject::makeRef(readings));
+        writer.writeEnumNames(rootNode);
+
+        std::ostringstream ostore;
+        ostore << doc;
+        std::string storage = ostore.str();
+        CHECK(storage.find("<type>1</type>") != std::string::npos);
+
+        rapidxml::xml_document<> readDoc;
+        readDoc.parse<0>(storage.data());
+
+        Readings copy;
+        ponder::archive::ArchiveReader reader(archive);
+        CHECK(reader.readEnumNames(readDoc.first_node()));
+        reader.read(readDoc.first_node(), ponder::UserObject::makeRef(copy));
+        checkReadings(copy);
+    }
+
+    SECTION("Binary archive values")
+    {
+        std::string storage;
+        ponder::archive::BinaryArchiveWriter writerArchive(storage);
+        ponder::archive::ArchiveWriter writer(writerArchive);
+        writer.setEnumFormat(ponder::archive::EnumFormat::Value);
+        writer.write(writerArchive.root(), ponder::UserObject::makeRef(readings));
+        writerArchive.finish();
+        CHECK(storage.find("SerialiseTest") == std::string::npos);
+
+        Readings copy;
+        ponder::archive::BinaryArchiveReader archive(storage.data(), storage.size());
+        ponder::archive::ArchiveReader(archive).read(archive.root(), ponder::UserObject::makeRef(copy));
+        checkReadings(copy);
+    }
+
+    SECTION("Ids out of the table are errors")
+    {
+        Readings copy;
+        CHECK_THROWS_AS(readJson(R"({"data":{"type":3},"enums":[{"enum":"SerialiseTest::ParamType",)"
+                                 R"("name":"a"}]})", copy), ponder::OutOfRange);
+    }
+}
+
+TEST_CASE("Can read the objects of an array one at a time")
+{
+    SECTION("Top-level JSON array")
+    {
+        std::vector<Readings> items(3);
+        items[0].m_type = ParamType::d;
+        items[0].m_history = {ParamType::a, ParamType::d, ParamType::i};
+        items[0].m_byName = {{"first", ParamType::a}, {"second", ParamType::d}};
+        items[1].m_history = {ParamType::d};
+        items[1].m_byName = {{"third", ParamType::i}};
+        items[2].m_type = ParamType::a;
+
+        rapidjson::StringBuffer sb;
+        rapidjson::Writer jwriter(sb);
+        using Archive = ponder::archive::RapidJsonArchiveWriter<rapidjson::Writer<rapidjson::StringBuffer>>;
+        Archive archive(jwriter);
+        ponder::archive::ArchiveWriter writer(archive);
+        jwriter.StartArray();
+        for (auto& item : items)
+        {
+            jwriter.StartObject();
+            writer.write(nullptr, ponder::UserObject::makeRef(item));
+            jwriter.EndObject();
+        }
+        jwriter.EndArray();
+
+        rapidjson::Document jdoc;
+        REQUIRE(!jdoc.Parse(sb.GetString()).HasParseError());
+        ponder::archive::RapidJsonArchiveReader reader(jdoc);
+        ponder::archive::ArchiveReader areader(reader);
+        const ponder::Class& cls = ponder::classByType<Readings>();
+
+        auto checkItem = [&](const ponder::UserObject& object, size_t index) {
+            const Readings& item = object.get<Readings>();
+            CHECK(item.m_type == items[index].m_type);
+            CHECK(item.m_history == items[index].m_history);
+            CHECK(item.m_byName == items[index].m_byName);
+        };
+
+        SECTION("New instances")
+        {
+            auto objects = areader.readObjects(jdoc, cls);
+            CHECK(objects.current() == ponder::UserObject::nothing);
+            std::vector<ponder::UserObject> kept;
+            while (objects.next())
+            {
+                IS_TRUE(objects.current().getClass() == cls);
+                checkItem(objects.current(), objects.count() - 1);
+                kept.push_back(objects.current());
+            }
+            CHECK(objects.count() == items.size());
+            CHECK(objects.current() == ponder::UserObject::nothing);
+            CHECK_FALSE(objects.next());
+
+            // Each item was read into its own instance
+            REQUIRE(kept.size() == 3);
+            CHECK(kept[0].pointer() != kept[1].pointer());
+            CHECK(kept[1].pointer() != kept[2].pointer());
+            checkItem(kept[0], 0);
+        }
+
+        SECTION("Reused instance")
+        {
+            // No stale array elements or map entries are left by the previous items
+            size_t index = 0;
+            const void* instance = nullptr;
+            for (const ponder::UserObject& object : areader.readObjects(jdoc, cls, true))
+            {
+                if (index == 0)
+                    instance = object.pointer();
+                CHECK(object.pointer() == instance);
+                checkItem(object, index++);
+            }
+            CHECK(index == items.size());
+        }
+
+        SECTION("Empty array")
+        {
+            rapidjson::Document empty;
+            empty.Parse("[]");
+            ponder::archive::RapidJsonArchiveReader emptyReader(empty);
+            ponder::archive::ArchiveReader emptyAreader(emptyReader);
+            auto objects = emptyAreader.readObjects(empty, cls, true);
+            CHECK(objects.begin() == objects.end());
+            CHECK(objects.count() == 0);
+        }
+    }
+
+    SECTION("Binary array property")
+    {
+        Complex c;
+        for (int i = 0; i < 100; ++i)
+            c.m_v.emplace_back(i, std::to_string(i), i * 0.5f, i % 3 == 0);
+
+        std::string storage;
+        ponder::archive::BinaryArchiveWriter archive(storage);
+        ponder::archive::ArchiveWriter writer(archive);
+        writer.write(archive.root(), ponder::UserObject::makeRef(c));
+        archive.finish();
+
+        ponder::archive::BinaryArchiveReader reader(storage.data(), storage.size());
+        ponder::archive::ArchiveReader areader(reader, ponder::archive::ReadMode::SinglePass);
+        size_t index = 0;
+        for (const ponder::UserObject& object :
+             areader.readObjects(reader.findProperty(reader.root(), "vect"),
+                                 ponder::classByType<Simple>(), true))
+        {
+            const Simple& item = object.get<Simple>();
+            REQUIRE(index < c.m_v.size());
+            CHECK(item.m_i == c.m_v[index].m_i);
+            CHECK(item.m_s == c.m_v[index].m_s);
+            CHECK(item.getF() == c.m_v[index].getF());
+            CHECK(item.m_b == c.m_v[index].m_b);
+            ++index;
+        }
+        CHECK(index == c.m_v.size());
+    }
+}
+
+TEST_CASE("Can serialise using the mapped archive")
+{
+    TestA testA{ "testA" };
+    testA.params.emplace_back(Params{ParamType::d, {0}, {2.3}, {}, {}});
+    testA.params.emplace_back(Params{ParamType::i, {-10}, {0}, {}, {}});
+    testA.params.emplace_back(Params{ParamType::a, {0}, {0}, {1,2,3}, {}});
+    testA.params.emplace_back(Params{ParamType::i, {0}, {0}, {}, Param_i{42}});
+
+    std::string storage;
+    {
+        ponder::archive::MappedArchiveWriter archive(storage);
+        ponder::archive::ArchiveWriter writer(archive);
+        writer.write(archive.root(), ponder::UserObject::makeRef(testA));
+        archive.finish();
+    }
+
+    SECTION("Objects can be read back")
+    {
+        TestA testA2;
+        ponder::archive::MappedArchiveReader archive(storage.data(), storage.size());
+        REQUIRE(archive.isValid(archive.root()));
+        ponder::archive::ArchiveReader reader(archive);
+        reader.read(archive.root(), ponder::UserObject::makeRef(testA2));
+
+        CHECK(testA2.name == "testA");
+        REQUIRE(testA2.params.size() == 4);
+        CHECK(testA2.params[0].type == ParamType::d);
+        CHECK(testA2.params[0].value_d.value == 2.3);
+        CHECK(testA2.params[1].value_i.value == -10);
+        CHECK(testA2.params[2].value_a == std::vector<int>({1,2,3}));
+        CHECK(testA2.params[3].value_v.index() == 2);
+        CHECK(std::get<2>(testA2.params[3].value_v).value == 42);
+    }
+
+    SECTION("Properties can be read in place")
+    {
+        ponder::archive::MappedArchiveReader archive(storage.data(), storage.size());
+        const ponder::archive::MappedObject view = archive.view<TestA>();
+        REQUIRE(view.isValid());
+        IS_TRUE(view.getClass() == ponder::classByType<TestA>());
+
+        const std::string_view name = view.getString("name");
+        CHECK(name == "testA");
+        CHECK(name.data() >= storage.data());
+        CHECK(name.data() < storage.data() + storage.size());
+        CHECK(view.get("name").to<std::string>() == "testA");
+
+        const ponder::archive::MappedArray params = view.array("params");
+        REQUIRE(params.size() == 4);
+        IS_TRUE(params.get(4).kind() == ponder::ValueKind::None);
+
+        const ponder::archive::MappedObject param1 = params.object<Params>(1);
+        CHECK(param1.getString("type") == "i");
+        CHECK(param1.child("i").get("value").to<int>() == -10);
+
+        const ponder::archive::MappedArray values = params.object<Params>(2).array("a");
+        REQUIRE(values.size() == 3);
+        CHECK(values.get(2).to<int>() == 3);
+
+        Params param0;
+        params.object<Params>(0).read(ponder::UserObject::makeRef(param0));
+        CHECK(param0.type == ParamType::d);
+        CHECK(param0.value_d.value == 2.3);
+
+        REQUIRE_THROWS_AS(view.get("nothere"), ponder::PropertyNotFound);
+        REQUIRE_THROWS_AS(view.child("name"), ponder::BadType);
+    }
+
+    SECTION("Invalid archives have an invalid root")
+    {
+        ponder::archive::MappedArchiveReader truncated(storage.data(), storage.size() - 3);
+        CHECK(!truncated.isValid(truncated.root()));
+        CHECK(!truncated.view<TestA>().isValid());
+        CHECK(truncated.view<TestA>().getString("name").empty());
+        ponder::archive::MappedArchiveReader garbage("nonsense", 8);
+        CHECK(!garbage.isValid(garbage.root()));
+
+        // The name table starts after the end of the data
+        const std::vector<char> header(storage.begin(), storage.begin() + 20);
+        ponder::archive::MappedArchiveReader headerOnly(header.data(), header.size());
+        CHECK(!headerOnly.isValid(headerOnly.root()));
+
+        // More names than the bytes left can hold
+        size_t namesOffset = 0; // little endian, after the magic and the version
+        for (int i = 0; i < 4; ++i)
+            namesOffset |= static_cast<size_t>(static_cast<unsigned char>(storage[5 + i])) << (i * 8);
+        std::string corrupt = storage;
+        corrupt.replace(namesOffset, 4, 4, '\xff');
+        ponder::archive::MappedArchiveReader tooManyNames(corrupt.data(), corrupt.size());
+        CHECK(!tooManyNames.isValid(tooManyNames.root()));
+    }
+
+#ifdef PONDER_ARCHIVE_MAPPED_FILE
+    SECTION("Files can be mapped")
+    {
+        const std::string path = (std::filesystem::temp_directory_path() / "pondertest.pndm").string();
+        std::ofstream(path, std::ios::binary) << storage;
+        {
+            ponder::archive::MappedFile file(path.c_str());
+            REQUIRE(file.data() != nullptr);
+            REQUIRE(file.size() == storage.size());
+
+            ponder::archive::MappedArchiveReader archive(file.data(), file.size());
+            CHECK(archive.view<TestA>().getString("name") == "testA");
+        }
+        std::remove(path.c_str());
+
+        ponder::archive::MappedFile missing(path.c_str());
+        CHECK(missing.data() == nullptr);
+    }
+#endif
+}
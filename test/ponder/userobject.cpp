@@ -32,8 +32,16 @@
 
 #include <ponder/classbuilder.hpp>
 #include <ponder/uses/runtime.hpp>
+#include <ponder/observer.hpp>
 #include "test.hpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #if 0
 static bool g_log = false;
@@ -159,6 +167,65 @@ namespace UserObjectTest
 
     struct Renamed {};
 
+    // Declares a copy constructor which doesn't compile
+    struct Owner
+    {
+        int n = 0;
+        std::vector<std::unique_ptr<int>> items;
+    };
+
+    struct Unique
+    {
+        Unique() = default;
+        Unique(Unique const&) = delete;
+        Unique& operator=(Unique const&) = delete;
+        Unique(Unique&&) = default;
+
+        Composed3& inner() {return m_inner;}
+
+        int n = 0;
+        std::vector<int> values;
+        Composed3 m_inner;
+    };
+
+    struct Tracked
+    {
+        int a = 0;
+        ponder::String b;
+        std::vector<int> c;
+    };
+
+    struct Scene
+    {
+        double scale = 1.0;
+        Composed1 root;
+        std::vector<Composed3> items;
+        std::vector<ponder::String> tags;
+        std::map<ponder::String, int> counts;
+    };
+
+    struct Linked
+    {
+        Composed3* target = nullptr;
+        int n = 0;
+        int hidden = 0; // not a property
+    };
+
+    struct LinkedList
+    {
+        std::vector<Linked> items;
+    };
+
+    struct ChangeLog : ponder::PropertyObserver
+    {
+        std::vector<ponder::String> changes;
+
+        void propertyChanged(const ponder::UserObject&, const ponder::Property& property) override
+        {
+            changes.emplace_back(property.name());
+        }
+    };
+
     // When created with ObjectFactory, will copy construct because no move semantics.
     class DefaultClass
     {
@@ -203,6 +270,7 @@ namespace UserObjectTest
     {
         ponder::Class::declare<MyBase>();
         ponder::Class::declare<MyClass>()
+            .copyable()
             .base<MyBase>()
             .constructor<int>()
             .property("p", &MyClass::x)
@@ -212,6 +280,7 @@ namespace UserObjectTest
 
         ponder::Class::declare<MyAbstractClass>();
         ponder::Class::declare<MyConcreteClass>()
+            .copyable()
             .constructor()
             .base<MyAbstractClass>();
 
@@ -233,6 +302,34 @@ namespace UserObjectTest
         ponder::Class::declare<Renamed>("EggSandwich")
             .constructor();
 
+        ponder::Class::declare<Unique>()
+            .property("n", &Unique::n)
+            .property("values", &Unique::values)
+            .property("inner", &Unique::inner);
+
+        ponder::Class::declare<Owner>()
+            .property("n", &Owner::n);
+
+        ponder::Class::declare<Tracked>()
+            .copyable()
+            .property("a", &Tracked::a)
+            .property("b", &Tracked::b)
+            .property("c", &Tracked::c);
+
+        ponder::Class::declare<Scene>()
+            .property("scale", &Scene::scale)
+            .property("root", &Scene::root)
+            .property("items", &Scene::items)
+            .property("tags", &Scene::tags)
+            .property("counts", &Scene::counts);
+
+        ponder::Class::declare<Linked>()
+            .property("target", &Linked::target)
+            .property("n", &Linked::n);
+
+        ponder::Class::declare<LinkedList>()
+            .property("items", &LinkedList::items);
+
         ponder::Class::declare<DefaultClass>()
             .constructor<int>();
 
@@ -251,6 +348,12 @@ PONDER_AUTO_TYPE(UserObjectTest::Composed2, &UserObjectTest::declare)
 PONDER_AUTO_TYPE(UserObjectTest::Composed1, &UserObjectTest::declare)
 PONDER_AUTO_TYPE(UserObjectTest::Data, &UserObjectTest::declare)
 PONDER_AUTO_TYPE(UserObjectTest::Renamed, &UserObjectTest::declare)
+PONDER_AUTO_TYPE_NONCOPYABLE(UserObjectTest::Unique, &UserObjectTest::declare)
+PONDER_AUTO_TYPE(UserObjectTest::Tracked, &UserObjectTest::declare)
+PONDER_AUTO_TYPE(UserObjectTest::Owner, &UserObjectTest::declare)
+PONDER_AUTO_TYPE(UserObjectTest::Scene, &UserObjectTest::declare)
+PONDER_AUTO_TYPE(UserObjectTest::Linked, &UserObjectTest::declare)
+PONDER_AUTO_TYPE(UserObjectTest::LinkedList, &UserObjectTest::declare)
 PONDER_TYPE(UserObjectTest::DefaultClass);
 PONDER_TYPE(UserObjectTest::MoveableClass);
 
@@ -401,6 +504,67 @@ TEST_CASE("User objects can be copied")
         CHECK(uobj1.get<MyClass>().x == 7);
         CHECK(uobj2.get<MyClass>().x == 7); // copy has changed
     }
+
+    SECTION("metaclasses record how their objects can be copied")
+    {
+        IS_TRUE(ponder::classByType<Composed3>().isTriviallyCopyable());
+        IS_TRUE(ponder::classByType<Composed3>().isCopyConstructible());
+        IS_TRUE(!ponder::classByType<Tracked>().isTriviallyCopyable());
+        IS_TRUE(ponder::classByType<Tracked>().isCopyConstructible());
+        IS_TRUE(!ponder::classByType<Unique>().isCopyConstructible());
+        IS_TRUE(!ponder::classByType<MyAbstractClass>().isCopyConstructible());
+        IS_TRUE(!ponder::classByType<Owner>().isCopyConstructible());
+    }
+
+    SECTION("objects with a non-copyable container are cloned property by property")
+    {
+        Owner object;
+        object.n = 4;
+        object.items.push_back(std::make_unique<int>(1));
+
+        const ponder::UserObject copy = ponder::runtime::clone(ponder::UserObject(&object));
+        CHECK(copy.get<Owner>().n == 4);
+        CHECK(copy.get<Owner>().items.empty());
+    }
+
+    SECTION("objects can be cloned with their copy constructor")
+    {
+        MyClass object(8);
+        const ponder::UserObject copy = ponder::runtime::clone(ponder::UserObject(&object));
+
+        IS_TRUE(copy.pointer() != &object);
+        IS_TRUE(copy.getClass() == ponder::classByType<MyClass>());
+        object.x = 9;
+        CHECK(copy.get<MyClass>().x == 8);
+
+        MyConcreteClass concrete;
+        MyAbstractClass& abstract = concrete;
+        IS_TRUE(ponder::runtime::clone(ponder::UserObject::makeRef(abstract)).getClass()
+                == ponder::classByType<MyConcreteClass>());
+    }
+
+    SECTION("non-copyable objects are cloned property by property")
+    {
+        Unique object;
+        object.n = 3;
+        object.values = {1, 2, 3};
+        object.m_inner.x = 12;
+
+        const ponder::UserObject copy = ponder::runtime::clone(ponder::UserObject(&object));
+
+        const Unique& cloned = copy.get<Unique>();
+        IS_TRUE(&cloned != &object);
+        CHECK(cloned.n == 3);
+        CHECK(cloned.values == object.values);
+        CHECK(cloned.m_inner.x == 12);
+    }
+
+    SECTION("objects which cannot be constructed cannot be cloned")
+    {
+        MyNonCopyableClass object;
+        REQUIRE_THROWS_AS(ponder::runtime::clone(ponder::UserObject(&object)),
+                          ponder::ForbiddenCopy);
+    }
 }
 
 TEST_CASE("User objects can be inspected and modified")
@@ -470,6 +634,49 @@ TEST_CASE("User objects can be inspected and modified")
         }
     }
 
+    SECTION("we can get and set all properties at once")
+    {
+        const ponder::runtime::PropertyPlan plan(ponder::classByType<Composed2>());
+        REQUIRE(plan.propertyCount() == 1);
+        REQUIRE(plan.property(0).name() == ponder::String("p"));
+
+        Composed2 object;
+        object.composed.x = 5;
+        std::vector<ponder::Value> snapshot;
+        plan.getAll(&object, snapshot);
+        REQUIRE(snapshot.size() == 1);
+        REQUIRE(snapshot[0].to<Composed3>().x == 5);
+
+        object.composed.x = 6;
+        plan.setAll(&object, snapshot);
+        REQUIRE(object.composed.x == 5);
+
+        REQUIRE_THROWS_AS(plan.setAll(&object, std::vector<ponder::Value>()), ponder::OutOfRange);
+        REQUIRE_THROWS_AS(plan.getAll(ponder::UserObject::nothing, snapshot), ponder::NullObject);
+    }
+
+    SECTION("snapshots copy data members and skip containers")
+    {
+        const ponder::runtime::PropertyPlan plan(ponder::classByType<Scene>());
+        REQUIRE(plan.propertyCount() == 2);
+        REQUIRE(plan.property(0).name() == ponder::String("root"));
+        REQUIRE(plan.property(1).name() == ponder::String("scale"));
+
+        Scene object;
+        object.root.composed.composed.x = 1;
+        std::vector<ponder::Value> snapshot;
+        plan.getAll(&object, snapshot); // empty arrays are fine
+        REQUIRE(snapshot.size() == 2);
+
+        object.scale = 3.0;
+        object.root.composed.composed.x = 99;
+        object.items.resize(4);
+        plan.setAll(&object, snapshot);
+        REQUIRE(object.scale == 1.0);
+        REQUIRE(object.root.composed.composed.x == 1);
+        REQUIRE(object.items.size() == 4); // not part of the plan
+    }
+
     SECTION("objects can created from existing user data")
     {
         MyClass object(77);
@@ -486,6 +693,341 @@ TEST_CASE("User objects can be inspected and modified")
     }
 }
 
+TEST_CASE("User objects can be compared by content")
+{
+    Scene first;
+    first.scale = 2.5;
+    first.root.composed.composed.x = 4;
+    first.items = {Composed3(1), Composed3(2)};
+    first.tags = {"a", "b"};
+    first.counts = {{"x", 1}, {"y", 2}};
+    Scene second = first;
+
+    const ponder::UserObject a(&first), b(&second);
+
+    SECTION("traits select raw memory comparisons")
+    {
+        const ponder::Class& metacls = ponder::classByType<Scene>();
+        IS_TRUE(!static_cast<const ponder::ArrayProperty&>(metacls.property("items")).bitwise());
+        IS_TRUE(!static_cast<const ponder::ArrayProperty&>(metacls.property("tags")).bitwise());
+        const ponder::Property& ints = ponder::classByType<Tracked>().property("c");
+        IS_TRUE(static_cast<const ponder::ArrayProperty&>(ints).bitwise());
+    }
+
+    SECTION("equal objects are equal and have equal hashes")
+    {
+        IS_TRUE(a != b); // different instances
+        IS_TRUE(ponder::runtime::deepEqual(a, b));
+        REQUIRE(ponder::runtime::deepHash(a) == ponder::runtime::deepHash(b));
+    }
+
+    SECTION("any difference is found")
+    {
+        ponder::runtime::ObjectComparator comparator;
+        IS_TRUE(comparator.equal(a, b));
+
+        second.root.composed.composed.x = 5;
+        IS_TRUE(!comparator.equal(a, b));
+        second.root.composed.composed.x = 4;
+
+        second.items[1].x = 3;
+        IS_TRUE(!comparator.equal(a, b));
+        IS_TRUE(comparator.hash(a) != comparator.hash(b));
+        second.items[1].x = 2;
+
+        second.tags.push_back("c");
+        IS_TRUE(!comparator.equal(a, b));
+        second.tags.pop_back();
+
+        second.counts["y"] = 3;
+        IS_TRUE(!comparator.equal(a, b));
+        second.counts["y"] = 2;
+
+        second.scale = -1.0;
+        IS_TRUE(!comparator.equal(a, b));
+        second.scale = first.scale;
+
+        IS_TRUE(comparator.equal(a, b));
+        REQUIRE(comparator.hash(a) == comparator.hash(b));
+    }
+
+    SECTION("pointers are compared by content and other members are ignored")
+    {
+        Composed3 firstTarget(7), secondTarget(7);
+        Linked left, right;
+        left.target = &firstTarget;
+        right.target = &secondTarget;
+        left.n = right.n = 3;
+        left.hidden = 1;
+        right.hidden = 2;
+        const ponder::UserObject l(&left), r(&right);
+
+        IS_TRUE(ponder::runtime::deepEqual(l, r));
+        REQUIRE(ponder::runtime::deepHash(l) == ponder::runtime::deepHash(r));
+
+        secondTarget.x = 8;
+        IS_TRUE(!ponder::runtime::deepEqual(l, r));
+        secondTarget.x = 7;
+
+        right.n = 4;
+        IS_TRUE(!ponder::runtime::deepEqual(l, r));
+        right.n = 3;
+
+        // Arrays of such structures are compared element by element, not as raw memory
+        LinkedList leftList{{left}}, rightList{{right}};
+        const ponder::UserObject ll(&leftList), rl(&rightList);
+        IS_TRUE(ponder::runtime::deepEqual(ll, rl));
+        REQUIRE(ponder::runtime::deepHash(ll) == ponder::runtime::deepHash(rl));
+
+        secondTarget.x = 8;
+        IS_TRUE(!ponder::runtime::deepEqual(ll, rl));
+        secondTarget.x = 7;
+    }
+
+    SECTION("objects of different classes are different")
+    {
+        Composed3 c3;
+        IS_TRUE(!ponder::runtime::deepEqual(a, ponder::UserObject(&c3)));
+        IS_TRUE(ponder::runtime::deepEqual(ponder::UserObject::nothing, ponder::UserObject::nothing));
+    }
+}
+
+TEST_CASE("User object changes can be tracked")
+{
+    Tracked object;
+    const ponder::UserObject uo(&object);
+    const ponder::Class& metacls = ponder::classByType<Tracked>();
+
+    SECTION("tracking is opt-in")
+    {
+        REQUIRE_FALSE(uo.isTrackingChanges());
+        uo.set("a", 1);
+        REQUIRE(uo.dirtyProperties().size() == 0);
+        REQUIRE_FALSE(uo.isDirty("a"));
+    }
+
+    SECTION("property writes are recorded")
+    {
+        uo.trackChanges();
+        REQUIRE(uo.isTrackingChanges());
+        REQUIRE(uo.dirtyProperties().size() == metacls.propertyCount());
+        REQUIRE_FALSE(uo.dirtyProperties().any());
+
+        const ponder::UserObject copy = uo; // copies share the dirty set
+        metacls.property("b").set(copy, "x");
+        REQUIRE(copy.isDirty("b"));
+        REQUIRE(uo.isDirty("b"));
+        REQUIRE_FALSE(uo.isDirty("a"));
+        REQUIRE(uo.dirtyProperties().count() == 1);
+        REQUIRE(uo.dirtyProperties().first() == metacls.propertyIndex("b"));
+        REQUIRE(uo.dirtyProperties().next(metacls.propertyIndex("b")) == metacls.propertyCount());
+
+        auto const& array = static_cast<const ponder::ArrayProperty&>(metacls.property("c"));
+        array.insert(uo, 0, 5);
+        REQUIRE(uo.isDirty("c"));
+
+        uo.clearDirty();
+        REQUIRE_FALSE(uo.dirtyProperties().any());
+
+        uo.trackChanges(false);
+        uo.set("a", 2);
+        REQUIRE_FALSE(uo.isTrackingChanges());
+        REQUIRE_FALSE(uo.isDirty("a"));
+    }
+
+    SECTION("changes made through another user object are not recorded")
+    {
+        uo.trackChanges();
+        const ponder::UserObject other(&object);
+        REQUIRE_FALSE(other.isTrackingChanges());
+
+        other.set("a", 1);
+        REQUIRE(object.a == 1);
+        REQUIRE_FALSE(uo.isDirty("a"));
+        REQUIRE_FALSE(other.isDirty("a"));
+    }
+
+    SECTION("objects reusing an address don't inherit the dirty set")
+    {
+        {
+            const ponder::UserObject copy = ponder::UserObject::makeCopy(object);
+            copy.trackChanges();
+            copy.set("a", 1);
+            REQUIRE(copy.isDirty("a"));
+        }
+
+        // The new copy is likely to reuse the address of the destroyed one
+        const ponder::UserObject copy = ponder::UserObject::makeCopy(object);
+        REQUIRE_FALSE(copy.isTrackingChanges());
+        REQUIRE_FALSE(copy.isDirty("a"));
+
+        // Same with objects stored by reference, constructed at the very same address
+        alignas(Tracked) unsigned char storage[sizeof(Tracked)];
+        Tracked* first = new (storage) Tracked;
+        const ponder::UserObject firstObject(first);
+        firstObject.trackChanges();
+        firstObject.set("a", 1);
+        first->~Tracked();
+
+        Tracked* second = new (storage) Tracked;
+        const ponder::UserObject secondObject(second);
+        REQUIRE(secondObject.pointer() == firstObject.pointer());
+        REQUIRE_FALSE(secondObject.isTrackingChanges());
+        REQUIRE_FALSE(secondObject.isDirty("a"));
+        second->~Tracked();
+    }
+
+    SECTION("objects can be tracked and changed on several threads")
+    {
+        std::vector<Tracked> objects(4);
+        std::vector<ponder::UserObject> users;
+        for (Tracked& tracked : objects)
+            users.emplace_back(&tracked);
+        std::vector<std::thread> threads;
+        for (const ponder::UserObject& user : users)
+        {
+            threads.emplace_back([&metacls, &user]
+            {
+                user.trackChanges();
+                for (int i = 0; i < 1000; ++i)
+                    metacls.property("a").set(user, i);
+            });
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+
+        for (size_t i = 0; i < objects.size(); ++i)
+        {
+            REQUIRE(objects[i].a == 999);
+            REQUIRE(users[i].isDirty("a"));
+            REQUIRE_FALSE(users[i].isDirty("b"));
+        }
+    }
+}
+
+TEST_CASE("User object changes can be observed")
+{
+    Tracked object;
+    const ponder::UserObject uo(&object);
+    const ponder::Class& metacls = ponder::classByType<Tracked>();
+    ChangeLog log;
+
+    SECTION("by class")
+    {
+        ponder::addPropertyObserver(metacls, &log);
+        uo.set("a", 1);
+        uo.set("b", "x");
+        ponder::removePropertyObserver(metacls, &log);
+        uo.set("a", 2);
+        REQUIRE(log.changes == std::vector<ponder::String>({"a", "b"}));
+    }
+
+    SECTION("by property")
+    {
+        ponder::addPropertyObserver(metacls.property("b"), &log);
+        uo.set("a", 1);
+        uo.set("b", "x");
+        ponder::removePropertyObserver(metacls.property("b"), &log);
+        REQUIRE(log.changes == std::vector<ponder::String>({"b"}));
+    }
+
+    SECTION("with batched notifications")
+    {
+        ponder::addPropertyObserver(metacls, &log);
+        {
+            ponder::PropertyChangeBatch batch;
+            for (int i = 0; i < 10; ++i)
+            {
+                uo.set("b", "x");
+                {
+                    ponder::PropertyChangeBatch nested;
+                    uo.set("a", i);
+                }
+            }
+            REQUIRE(log.changes.empty());
+        }
+        ponder::removePropertyObserver(metacls, &log);
+        REQUIRE(log.changes == std::vector<ponder::String>({"b", "a"}));
+        REQUIRE(object.a == 9);
+    }
+
+    SECTION("with a batch opened by another thread")
+    {
+        struct ThreadLog : ponder::PropertyObserver
+        {
+            std::mutex mutex;
+            std::vector<std::thread::id> threads;
+
+            void propertyChanged(const ponder::UserObject&, const ponder::Property&) override
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                threads.push_back(std::this_thread::get_id());
+            }
+        } threadLog;
+
+        ponder::addPropertyObserver(metacls, &threadLog);
+        {
+            ponder::PropertyChangeBatch batch;
+            uo.set("a", 1);
+
+            // The other thread's change is neither held back nor dispatched here
+            Tracked other;
+            std::thread::id otherId;
+            std::thread thread([&other, &otherId]
+            {
+                otherId = std::this_thread::get_id();
+                ponder::UserObject(&other).set("a", 2);
+            });
+            thread.join();
+            REQUIRE(threadLog.threads == std::vector<std::thread::id>{otherId});
+        }
+        ponder::removePropertyObserver(metacls, &threadLog);
+        REQUIRE(threadLog.threads.size() == 2);
+        CHECK(threadLog.threads[1] == std::this_thread::get_id());
+    }
+
+    SECTION("with a committed batch")
+    {
+        struct Failing : ponder::PropertyObserver
+        {
+            void propertyChanged(const ponder::UserObject&, const ponder::Property&) override
+            {
+                throw std::runtime_error("observer failed");
+            }
+        } failing;
+
+        ponder::addPropertyObserver(metacls, &failing);
+        {
+            ponder::PropertyChangeBatch batch;
+            uo.set("a", 1);
+            REQUIRE_THROWS_AS(batch.commit(), std::runtime_error);
+            batch.commit(); // already ended
+        }
+        {
+            ponder::PropertyChangeBatch batch;
+            uo.set("a", 2);
+        } // the destructor doesn't let the exception escape
+        ponder::removePropertyObserver(metacls, &failing);
+    }
+
+    SECTION("with a batch destroyed by an exception")
+    {
+        ponder::addPropertyObserver(metacls, &log);
+        try
+        {
+            ponder::PropertyChangeBatch batch;
+            uo.set("a", 1);
+            throw std::runtime_error("operation failed");
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+        uo.set("b", "x");
+        ponder::removePropertyObserver(metacls, &log);
+        REQUIRE(log.changes == std::vector<ponder::String>({"b"}));
+    }
+}
+
 TEST_CASE("User objects can be created")
 {
     SECTION("create by type")